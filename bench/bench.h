@@ -0,0 +1,181 @@
+/* Header file "bench.h" of GAIM package
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file bench.h
+ * Timing and JSON reporting helpers shared by the GAIM benchmarks (see make
+ * bench). Every benchmark runs a function a number of iterations, repeats the
+ * measurement and reports the median and the minimum time per iteration.
+ */
+// $Log$
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdio>
+#include "gaim.h"
+
+
+/**
+ * @brief Structure holding the outcome of a single benchmark.
+ */
+typedef struct bench_result {
+    std::string name;   /**< Benchmark name (e.g., "selection/ktournament") */
+    std::vector<std::pair<std::string, double>> params; /**< Benchmark parameters */
+    std::size_t iterations; /**< Iterations per repetition */
+    std::size_t repeats;    /**< Number of repetitions */
+    double median_ns;   /**< Median time per iteration (ns) */
+    double min_ns;      /**< Minimum time per iteration (ns) */
+} bench_result_s;
+
+
+/**
+ * Times a function. The function is called iterations times per repetition
+ * and the measurement is repeated repeats times (after one warm-up call).
+ *
+ * @param[in] name Benchmark name
+ * @param[in] params Benchmark parameters (name, value) reported in the JSON
+ * @param[in] iterations Calls per repetition
+ * @param[in] repeats Number of repetitions
+ * @param[in] f Function to benchmark
+ * @return A bench_result_s structure
+ */
+template <class F>
+bench_result_s run_bench(std::string name,
+                         std::vector<std::pair<std::string, double>> params,
+                         std::size_t iterations,
+                         std::size_t repeats,
+                         F f)
+{
+    bench_result_s res;
+    std::vector<double> times;
+
+    f();
+    for (std::size_t r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < iterations; ++i) {
+            f();
+        }
+        auto end = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        times.push_back(ns / static_cast<double>(iterations));
+    }
+    std::sort(times.begin(), times.end());
+
+    res.name = name;
+    res.params = params;
+    res.iterations = iterations;
+    res.repeats = repeats;
+    res.median_ns = times[times.size() / 2];
+    res.min_ns = times[0];
+    std::fprintf(stderr, "%-40s %14.1f ns\n", name.c_str(), res.median_ns);
+    return res;
+}
+
+
+/**
+ * Writes the results of a benchmark suite as a JSON document to stdout.
+ *
+ * @param[in] suite Name of the suite
+ * @param[in] results Vector of benchmark results
+ * @return Nothing (void)
+ */
+static inline void print_json(std::string suite,
+                              const std::vector<bench_result_s> &results)
+{
+    std::printf("{\n");
+    std::printf("  \"suite\": \"%s\",\n", suite.c_str());
+    std::printf("  \"precision\": \"%s\",\n", GAIM_PRECISION);
+    std::printf("  \"isa\": \"%s\",\n", simd_isa());
+    std::printf("  \"threads\": %u,\n", std::thread::hardware_concurrency());
+    std::printf("  \"results\": [\n");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const bench_result_s &r = results[i];
+        std::printf("    {\"name\": \"%s\", \"params\": {", r.name.c_str());
+        for (std::size_t j = 0; j < r.params.size(); ++j) {
+            std::printf("%s\"%s\": %g", j ? ", " : "",
+                        r.params[j].first.c_str(), r.params[j].second);
+        }
+        std::printf("}, \"iterations\": %zu, \"repeats\": %zu, "
+                    "\"median_ns\": %.1f, \"min_ns\": %.1f}%s\n",
+                    r.iterations, r.repeats, r.median_ns, r.min_ns,
+                    (i + 1 < results.size()) ? "," : "");
+    }
+    std::printf("  ]\n");
+    std::printf("}\n");
+}
+
+
+/**
+ * Returns the GA parameters used by the benchmarks.
+ *
+ * @param[in] population_size Population size
+ * @param[in] genome_size Genome size
+ * @return A ga_parameter_s structure
+ */
+static inline ga_parameter_s bench_ga_params(std::size_t population_size,
+                                             std::size_t genome_size)
+{
+    ga_parameter_s pms;
+
+    pms.sel_pms.selection_method = "ktournament";
+    pms.sel_pms.bias = 1.5;
+    pms.sel_pms.num_parents = 2;
+    pms.sel_pms.lower_bound = 1;
+    pms.sel_pms.k = 2;
+    pms.sel_pms.replace = false;
+    pms.cross_pms.crossover_method = "one_point";
+    pms.mut_pms.mutation_method = "delta";
+    pms.mut_pms.mutation_rate = 0.5;
+    pms.mut_pms.variance = 0.5;
+    pms.mut_pms.low_bound = -1.0;
+    pms.mut_pms.up_bound = 1.0;
+    pms.mut_pms.order = 1;
+    pms.mut_pms.is_real = true;
+    pms.a = std::vector<REAL_>(genome_size, -1.0);
+    pms.b = std::vector<REAL_>(genome_size, 1.0);
+    pms.generations = 100;
+    pms.population_size = population_size;
+    pms.genome_size = genome_size;
+    pms.num_offsprings = std::max<std::size_t>(population_size / 2, 2);
+    pms.num_replacement = std::max<std::size_t>(population_size / 4, 1);
+    pms.runs = 1;
+    pms.clipping = "universal";
+    pms.clipping_fname = "";
+    return pms;
+}
+
+
+/**
+ * Returns printing parameters that disable all the logging.
+ */
+static inline pr_parameter_s bench_pr_params(void)
+{
+    pr_parameter_s pms;
+
+    pms.where2write = "stdout";
+    pms.experiment_name = "bench";
+    pms.print_fitness = false;
+    pms.print_average_fitness = false;
+    pms.print_bsf = false;
+    pms.print_best_genome = false;
+    return pms;
+}
+
+#endif  // BENCH_H
@@ -0,0 +1,65 @@
+/* Batch solver benchmarks of GAIM package
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file bench_batch.cpp
+ * Benchmarks of many small optimization problems: one GA built per problem
+ * against the BatchSolver (reused GAs on a worker pool). The time is per
+ * batch of problems.
+ */
+// $Log$
+#include "bench.h"
+
+
+int main() {
+    const std::size_t num_problems = 256, population_size = 50, generations = 5;
+    const std::size_t genome_sizes[] = {5, 10, 20, 50};
+    const std::size_t threads[] = {1, 4};
+    std::vector<bench_result_s> results;
+    std::vector<batch_problem_s> problems(num_problems);
+
+    for (std::size_t i = 0; i < num_problems; ++i) {
+        problems[i].ga_pms = bench_ga_params(population_size, genome_sizes[i % 4]);
+        problems[i].ga_pms.generations = generations;
+        problems[i].fitness = sphere;
+    }
+    std::vector<std::pair<std::string, double>> params = {
+        {"problems", num_problems},
+        {"population_size", population_size},
+        {"generations", generations}};
+
+    results.push_back(run_bench("ga_per_problem", params, 1, 5, [&]() {
+        for (auto &p : problems) {
+            GA gen_alg(&p.ga_pms);
+            gen_alg.fitness = p.fitness;
+            gen_alg.step(p.ga_pms.generations);
+        }
+    }));
+    for (std::size_t n : threads) {
+        BatchSolver solver(n);
+        std::vector<std::pair<std::string, double>> batch_params(params);
+
+        batch_params.push_back({"threads", n});
+        results.push_back(run_bench("batch_solver", batch_params, 1, 5, [&]() {
+            solver.solve(problems);
+        }));
+    }
+    print_json("batch", results);
+    return 0;
+}
@@ -0,0 +1,55 @@
+/* Generation benchmark of GAIM package
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file bench_generation.cpp
+ * Benchmarks one generation step (GA::run_one_generation) across population
+ * and genome sizes, with the default operators (k-tournament, one-point
+ * crossover, delta mutation) and the sphere function.
+ */
+// $Log$
+#include "bench.h"
+
+
+int main() {
+    const std::size_t population_sizes[] = {50, 200, 1000};
+    const std::size_t genome_sizes[] = {4, 32, 256};
+    std::vector<bench_result_s> results;
+
+    for (std::size_t population_size : population_sizes) {
+        for (std::size_t genome_size : genome_sizes) {
+            ga_parameter_s pms = bench_ga_params(population_size, genome_size);
+            GA ga(&pms);
+            std::vector<std::pair<std::string, double>> params = {
+                {"population_size", population_size},
+                {"genome_size", genome_size},
+                {"num_offsprings", pms.num_offsprings},
+                {"num_replacement", pms.num_replacement}};
+            std::size_t iters = std::max<std::size_t>(2000000 /
+                                                      (population_size * genome_size), 10);
+
+            ga.fitness = sphere;
+            results.push_back(run_bench("generation", params, iters, 5, [&]() {
+                ga.run_one_generation();
+            }));
+        }
+    }
+    print_json("generation", results);
+    return 0;
+}
@@ -0,0 +1,115 @@
+/* Operators benchmark of GAIM package
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file bench_operators.cpp
+ * Micro-benchmarks of every selection, crossover and mutation operator, and
+ * of the built-in objective functions, for a few genome sizes.
+ */
+// $Log$
+#include "bench.h"
+
+
+typedef std::vector<individual_s> (GA::*selection_t)(std::vector<individual_s> &);
+typedef std::vector<REAL_> (GA::*crossover_t)(std::vector<REAL_>, std::vector<REAL_>);
+typedef std::vector<REAL_> (GA::*mutation_t)(std::vector<REAL_>);
+
+
+int main() {
+    const std::size_t population_size = 100;
+    const std::size_t genome_sizes[] = {8, 64, 512};
+    std::vector<bench_result_s> results;
+
+    std::vector<std::pair<std::string, selection_t>> selections = {
+        {"ktournament", &GA::ktournament_selection},
+        {"truncation", &GA::truncation_selection},
+        {"linear_rank", &GA::linear_rank_selection},
+        {"random", &GA::random_selection},
+        {"roulette", &GA::roulette_wheel_selection},
+        {"stochastic_roulette", &GA::stochastic_roulette_wheel_selection},
+        {"whitley", &GA::whitley_selection}};
+    std::vector<std::pair<std::string, crossover_t>> crossovers = {
+        {"one_point", &GA::one_point_crossover},
+        {"two_point", &GA::two_point_crossover},
+        {"uniform", &GA::uniform_crossover},
+        {"flat", &GA::flat_crossover},
+        {"discrete", &GA::discrete_crossover},
+        {"first_order", &GA::order_one_crossover}};
+    std::vector<std::pair<std::string, mutation_t>> mutations = {
+        {"delta", &GA::delta_mutation},
+        {"random", &GA::random_mutation},
+        {"nonuniform", &GA::nonuniform_mutation},
+        {"fusion", &GA::fusion_mutation},
+        {"swap", &GA::swap_mutation}};
+    std::vector<std::pair<std::string, REAL_ (*)(REAL_ *, size_t)>> objectives = {
+        {"sphere", sphere},
+        {"rastrigin", rastrigin},
+        {"schwefel", schwefel},
+        {"griewank", griewank}};
+
+    for (std::size_t genome_size : genome_sizes) {
+        ga_parameter_s pms = bench_ga_params(population_size, genome_size);
+        GA ga(&pms);
+        std::vector<std::pair<std::string, double>> params = {
+            {"population_size", population_size},
+            {"genome_size", genome_size}};
+        std::size_t iters = std::max<std::size_t>(200000 / genome_size, 100);
+
+        ga.evaluation(ga.population);
+        std::vector<REAL_> p1 = ga.population[0].genome;
+        std::vector<REAL_> p2 = ga.population[1].genome;
+
+        for (auto &s : selections) {
+            results.push_back(run_bench("selection/" + s.first, params,
+                                        iters / 10, 5, [&]() {
+                std::vector<individual_s> parents = (ga.*(s.second))(ga.population);
+                ga.reset_selection_flags();
+                ga.arena.reset();
+            }));
+        }
+        for (auto &c : crossovers) {
+            // The first order crossover is meant for permutations
+            if (c.first == "first_order") {
+                std::iota(p1.begin(), p1.end(), 0);
+                p2 = p1;
+                std::reverse(p2.begin(), p2.end());
+            }
+            results.push_back(run_bench("crossover/" + c.first, params,
+                                        iters, 5, [&]() {
+                std::vector<REAL_> child = (ga.*(c.second))(p1, p2);
+            }));
+        }
+        for (auto &m : mutations) {
+            results.push_back(run_bench("mutation/" + m.first, params,
+                                        iters, 5, [&]() {
+                std::vector<REAL_> child = (ga.*(m.second))(p1);
+                ga.arena.reset();
+            }));
+        }
+        for (auto &o : objectives) {
+            results.push_back(run_bench("objective/" + o.first, params,
+                                        iters * 10, 5, [&]() {
+                volatile REAL_ f = o.second(&p1[0], p1.size());
+                (void) f;
+            }));
+        }
+    }
+    print_json("operators", results);
+    return 0;
+}
@@ -0,0 +1,99 @@
+/* Scaling benchmark of GAIM package
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file bench_scaling.cpp
+ * End-to-end scaling benchmarks of the independent runs (independent_runs)
+ * and the Island Model (run_islands) over the number of threads. Every run
+ * or island evolves the same population, so ideal scaling keeps the time
+ * constant.
+ */
+// $Log$
+#include "bench.h"
+
+#include <cstdio>
+
+
+/**
+ * Writes an all-to-all connectivity graph of n islands to a file.
+ */
+static std::string write_all2all_graph(std::size_t n)
+{
+    std::string fname = "/tmp/gaim_bench_graph_" + std::to_string(n) + ".dat";
+    std::ofstream ofile(fname);
+
+    ofile << n << std::endl;
+    for (std::size_t i = 0; i < n; ++i) {
+        ofile << i << " " << n - 1;
+        for (std::size_t j = 0; j < n; ++j) {
+            if (j != i) { ofile << " " << j; }
+        }
+        ofile << std::endl;
+    }
+    return fname;
+}
+
+
+int main() {
+    const std::size_t threads[] = {1, 2, 4, 8};
+    const std::size_t population_size = 100, genome_size = 16, generations = 500;
+    std::vector<bench_result_s> results;
+    pr_parameter_s pr_pms = bench_pr_params();
+
+    for (std::size_t n : threads) {
+        ga_parameter_s ga_pms = bench_ga_params(population_size, genome_size);
+        std::vector<std::pair<std::string, double>> params = {
+            {"threads", n},
+            {"population_size", population_size},
+            {"genome_size", genome_size},
+            {"generations", generations}};
+
+        ga_pms.generations = generations;
+        ga_pms.runs = n;
+        results.push_back(run_bench("independent_runs", params, 1, 3, [&]() {
+            independent_runs(sphere, &ga_pms, &pr_pms, "minimum");
+        }));
+    }
+
+    for (std::size_t n : threads) {
+        if (n < 2) { continue; }
+        ga_parameter_s ga_pms = bench_ga_params(population_size, genome_size);
+        im_parameter_s im_pms;
+        std::vector<std::pair<std::string, double>> params = {
+            {"threads", n},
+            {"population_size", population_size},
+            {"genome_size", genome_size},
+            {"generations", generations}};
+
+        ga_pms.generations = generations;
+        im_pms.num_immigrants = 4;
+        im_pms.num_islands = n;
+        im_pms.migration_interval = 50;
+        im_pms.pick_method = "elite";
+        im_pms.replace_method = "poor";
+        im_pms.adj_list_fname = write_all2all_graph(n);
+        im_pms.is_im_enabled = true;
+        results.push_back(run_bench("island_model", params, 1, 3, [&]() {
+            run_islands(sphere, im_pms, ga_pms, pr_pms, "minimum");
+        }));
+        std::remove(im_pms.adj_list_fname.c_str());
+    }
+    print_json("scaling", results);
+    return 0;
+}
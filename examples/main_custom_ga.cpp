@@ -46,23 +46,16 @@ void GA::run_one_generation()
     // Evaluate fitness of each individual
     evaluation(population);
 
-    // Sort the entire population based on fitness
-    sort_population();
+    // Fitness statistics of the population (single pass)
+    update_statistics();
 
+    if (stats.max > bsf_fitness) {
+        bsf_genome = population[stats.argmax].genome;  // Best so far genome
+        bsf_fitness = stats.max;
+    }
 
-    best_individual = sorted_population[sorted_population.size()-1];
-    hfi.push_back(best_individual.fitness);   // Best fitness
-    bsf_genome = best_individual.genome;  // Best so far genome
-    lfi.push_back(sorted_population[0].fitness);    // Lowest fitness
-    
-    // Average fitness across population
-    REAL_ acc = std::accumulate(population.begin(),
-                                population.end(),
-                                0,
-                                average_fitness);
-    fit_avg.push_back(acc / static_cast<REAL_>(mu));
-    
-    bsf.push_back(best_individual.fitness);
+    // BSF, highest, lowest and average fitness records (see RecordPolicy)
+    record_statistics(stats.max, stats.min, stats.mean);
 
     // Generate new offsprings
     for(std::size_t i = 0; i < lambda; ++i) {
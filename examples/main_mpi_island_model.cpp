@@ -390,6 +390,7 @@ int main(int argc, char **argv)
         // Migration takes place
         if (i % im_pms.migration_interval == 0) {
             // Pick up the candidate immigrants
+            gen_alg.sort_population();
             select_ind2migrate(gen_alg.sorted_population,
                                &sbuf[rank],
                                gen_alg.fitness,
@@ -0,0 +1,187 @@
+/* Header file "fast_math.h" of GAIM package
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file fast_math.h
+ * Branch-free approximations of the transcendental functions used in the
+ * inner loops of GAIM (mutation kernels and benchmark objective functions).
+ * They consist only of arithmetic, bit manipulation and selects, so the
+ * compiler can vectorize the loops that call them, in contrast to the libm
+ * functions. Accuracy is close to the precision of the type (float or double)
+ * within the ranges GAIM uses them for.
+ */
+// $Log$
+#ifndef FAST_MATH_H
+#define FAST_MATH_H
+
+#include <cstdint>
+#include <cstring>
+
+#define FAST_PI     3.14159265358979323846
+#define FAST_LN2    0.69314718055994530942
+
+
+/**
+ * Reinterprets the bits of a floating point number as an unsigned integer
+ * of the same width (and vice versa).
+ */
+static inline uint32_t fast_bits(float x)
+{
+    uint32_t i;
+    std::memcpy(&i, &x, sizeof(i));
+    return i;
+}
+
+static inline uint64_t fast_bits(double x)
+{
+    uint64_t i;
+    std::memcpy(&i, &x, sizeof(i));
+    return i;
+}
+
+static inline float fast_float(uint32_t i)
+{
+    float x;
+    std::memcpy(&x, &i, sizeof(x));
+    return x;
+}
+
+static inline double fast_double(uint64_t i)
+{
+    double x;
+    std::memcpy(&x, &i, sizeof(x));
+    return x;
+}
+
+
+/**
+ * Rounds to the nearest integer value (ties away from zero) without calling
+ * libm, so the operation stays vectorizable. Valid for |x| < 2^31.
+ */
+template <typename T>
+static inline T fast_round(T x)
+{
+    return static_cast<T>(static_cast<int32_t>(x + (x >= 0 ? T(0.5) : T(-0.5))));
+}
+
+
+/**
+ * Natural logarithm for positive, normal numbers. The argument is split into
+ * mantissa m in [sqrt(2)/2, sqrt(2)) and exponent e, and
+ * \f$ \log(m) = 2 \mathrm{atanh}(s),\, s = (m - 1) / (m + 1) \f$ is evaluated
+ * by its series.
+ */
+static inline float fast_log(float x)
+{
+    uint32_t i = fast_bits(x);
+    int e = static_cast<int>((i >> 23) & 0xff) - 127;
+    float m = fast_float((i & 0x007fffff) | 0x3f800000);
+    bool big = m > 1.41421356f;
+    m = big ? 0.5f * m : m;
+    e = big ? e + 1 : e;
+    float s = (m - 1.0f) / (m + 1.0f);
+    float s2 = s * s;
+    float p = 1.0f + s2 * (1.0f/3 + s2 * (1.0f/5 + s2 * (1.0f/7 + s2 * (1.0f/9))));
+    return 2.0f * s * p + static_cast<float>(e) * static_cast<float>(FAST_LN2);
+}
+
+static inline double fast_log(double x)
+{
+    uint64_t i = fast_bits(x);
+    int64_t e = static_cast<int64_t>((i >> 52) & 0x7ff) - 1023;
+    double m = fast_double((i & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL);
+    bool big = m > 1.4142135623730951;
+    m = big ? 0.5 * m : m;
+    e = big ? e + 1 : e;
+    double s = (m - 1.0) / (m + 1.0);
+    double s2 = s * s;
+    double p = 1.0 + s2 * (1.0/3 + s2 * (1.0/5 + s2 * (1.0/7 + s2 * (1.0/9 +
+               s2 * (1.0/11 + s2 * (1.0/13 + s2 * (1.0/15 + s2 * (1.0/17))))))));
+    return 2.0 * s * p + static_cast<double>(e) * FAST_LN2;
+}
+
+
+/**
+ * Exponential function. The argument is reduced to
+ * \f$ x = k \ln 2 + r,\, |r| \leq \ln 2 / 2 \f$, exp(r) is evaluated by its
+ * Taylor polynomial and \f$ 2^k \f$ is built directly in the exponent bits.
+ * Arguments below the smallest normal number flush to zero.
+ */
+static inline float fast_exp(float x)
+{
+    x = x < -87.0f ? -87.0f : (x > 88.0f ? 88.0f : x);
+    float k = fast_round(x * static_cast<float>(1.0 / FAST_LN2));
+    float r = x - k * static_cast<float>(FAST_LN2);
+    float p = 1.0f + r * (1.0f + r * (1.0f/2 + r * (1.0f/6 + r * (1.0f/24 +
+              r * (1.0f/120 + r * (1.0f/720 + r * (1.0f/5040)))))));
+    float scale = fast_float(static_cast<uint32_t>(static_cast<int32_t>(k) + 127) << 23);
+    return p * scale;
+}
+
+static inline double fast_exp(double x)
+{
+    x = x < -708.0 ? -708.0 : (x > 709.0 ? 709.0 : x);
+    double k = fast_round(x * (1.0 / FAST_LN2));
+    double r = x - k * FAST_LN2;
+    double p = 1.0 + r * (1.0 + r * (1.0/2 + r * (1.0/6 + r * (1.0/24 +
+               r * (1.0/120 + r * (1.0/720 + r * (1.0/5040 + r * (1.0/40320 +
+               r * (1.0/362880 + r * (1.0/3628800 + r * (1.0/39916800)))))))))));
+    double scale = fast_double(static_cast<uint64_t>(static_cast<int64_t>(k) + 1023) << 52);
+    return p * scale;
+}
+
+
+/**
+ * Cosine function. The argument is reduced to [-pi, pi] and then, using
+ * \f$ \cos(x) = -\cos(\pi - |x|) \f$, to [0, pi/2] where an even Taylor
+ * polynomial is evaluated. Accurate for the moderate arguments (|x| up to a
+ * few hundreds) GAIM's objective functions produce.
+ */
+template <typename T>
+static inline T fast_cos(T x)
+{
+    // 2 pi split in a high and a low part (Cody-Waite reduction)
+    const T two_pi_hi = static_cast<T>(2.0 * FAST_PI);
+    const T two_pi_lo = static_cast<T>(2.0 * FAST_PI - static_cast<double>(two_pi_hi));
+    const T pi = static_cast<T>(FAST_PI);
+    const T half_pi = static_cast<T>(0.5 * FAST_PI);
+
+    T k = fast_round(x * static_cast<T>(0.5 / FAST_PI));
+    T r = (x - k * two_pi_hi) - k * two_pi_lo;
+    T a = r < 0 ? -r : r;
+    bool flip = a > half_pi;
+    a = flip ? pi - a : a;
+    T a2 = a * a;
+    T p = T(1) - a2 * (T(1)/2 - a2 * (T(1)/24 - a2 * (T(1)/720 - a2 * (T(1)/40320 -
+          a2 * (T(1)/3628800 - a2 * (T(1)/479001600 - a2 * (T(1.0/87178291200.0) -
+          a2 * T(1.0/20922789888000.0))))))));
+    return flip ? -p : p;
+}
+
+
+/**
+ * Sine function computed as \f$ \sin(x) = \cos(x - \pi / 2) \f$.
+ */
+template <typename T>
+static inline T fast_sin(T x)
+{
+    return fast_cos(x - static_cast<T>(0.5 * FAST_PI));
+}
+
+#endif  // FAST_MATH_H
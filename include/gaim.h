@@ -38,15 +38,47 @@
 #include <libconfig.h++>
 #include <map>
 #include <set>
+#include <deque>
+#include <memory>
 #include <thread>
+#include <pthread.h>
 #include <mutex>
 #include <sys/stat.h>
+#include <sys/types.h>
+#include <cstdint>
+#include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
 
 #include "pcg_random.hpp"
 
-#define REAL_ float
-
 #include <functional>
+#include <stdexcept>
+#include <initializer_list>
+#include <type_traits>
+
+/// Scalar type of genomes and fitness values. The library is built twice,
+/// once with float (default) and once with double (GAIM_DOUBLE). The double
+/// build lives in namespace gaim_double and its C entry points carry the
+/// suffix _double, so both coexist in libgaim.so.
+#ifdef GAIM_DOUBLE
+#define REAL_ double
+#define GAIM_PRECISION "double"
+#define GAIM_BEGIN_NAMESPACE namespace gaim_double {
+#define GAIM_END_NAMESPACE }
+#define GAIM_EXTERN_C_BEGIN
+#define GAIM_EXTERN_C_END
+#define GAIM_C_NAME(name) name##_double
+#else
+#define REAL_ float
+#define GAIM_PRECISION "float"
+#define GAIM_BEGIN_NAMESPACE
+#define GAIM_END_NAMESPACE
+#define GAIM_EXTERN_C_BEGIN extern "C" {
+#define GAIM_EXTERN_C_END }
+#define GAIM_C_NAME(name) name
+#endif
 
 #define ANSI_COLOR_RED     "\x1b[31m"
 #define ANSI_COLOR_GREEN   "\x1b[32m"
@@ -55,6 +87,31 @@
 
 //#define TIME
 
+/// Per-phase timers and counters (ga_profile_s) are collected only when GAIM
+/// is compiled with GAIM_PROFILE (make profile=1)
+//#define GAIM_PROFILE
+#ifdef GAIM_PROFILE
+#define GAIM_PROFILE_START(t) auto t = std::chrono::steady_clock::now()
+#define GAIM_PROFILE_STOP(p, t, field) (p).field += profile_elapsed_ns(t)
+#define GAIM_PROFILE_COUNT(p, field, n) (p).field += (n)
+#else
+#define GAIM_PROFILE_START(t)
+#define GAIM_PROFILE_STOP(p, t, field)
+#define GAIM_PROFILE_COUNT(p, field, n)
+#endif
+
+/// Number of lanes of the vectorized random number generator and the SIMD
+/// kernels (16 x 32 bits fill an AVX-512 register)
+#define GAIM_VLANES 16
+
+/// Compiles a function for AVX-512, AVX2 and the default ISA and picks the
+/// right one at load time (scalar fallback on CPUs without AVX2)
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(GAIM_NO_SIMD_DISPATCH)
+#define GAIM_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define GAIM_TARGET_CLONES
+#endif
+
 #define XORSWAP(a, b)                                                         \
   ((&(a) == &(b)) ? (a)                                                       \
                   : ((a) ^= (b), (b) ^= (a),                                  \
@@ -72,6 +129,8 @@
                    }}
 
 
+GAIM_BEGIN_NAMESPACE
+
 /**
  * @brief Structure containing initialization parameters for the selection
  * operator. 
@@ -171,6 +230,46 @@ typedef struct parameter_ga {
     std::string clipping_fname;     /**< Clipping values file name. Contains the clipping values 
                                       for each gene for each individual.*/
     int runs;   /**< Number of experimental runs, greater than 1 in case of multiple trajectories */
+    std::string record_policy = "all"; /**< Which generations are recorded in the BSF and
+                                         average fitness records. Can be one of: all,
+                                         interval (every record_interval generations),
+                                         log (generations 1, 2, 4, 8, ...), and
+                                         improvement (only when the best fitness improves) */
+    std::size_t record_interval = 1; /**< Recording interval of the interval policy */
+    std::size_t record_capacity = 0; /**< Maximum number of records (0 means unbounded).
+                                       When full, every other record is dropped */
+    std::size_t elitism = 0;    /**< Number of best individuals that are never replaced
+                                  by offspring. When it is positive, the archived
+                                  best-so-far individual is also re-inserted if the
+                                  population loses it (e.g., after a migration) */
+    std::string init_method = "uniform"; /**< Initialization of the population. Can be one
+                                           of: uniform (random genes within [a, b]),
+                                           lhs (Latin hypercube sampling), and sobol
+                                           (randomized Sobol sequence) */
+    std::vector<REAL_> seed_genomes; /**< Seed genomes (warm start), stored row-wise
+                                       (n x genome_size). They replace the first
+                                       n individuals of the initial population */
+    std::string seed_fname = ""; /**< Seed genomes file (see read_seed_genomes),
+                                   appended to seed_genomes. Empty disables it */
+    std::string surrogate = "none"; /**< Surrogate model pre-screening the offspring.
+                                      Can be one of: none, and knn (k nearest
+                                      neighbours regression, see SurrogateModel) */
+    REAL_ surrogate_fraction = 0.25; /**< Fraction of the offspring evaluated by the
+                                       fitness function (the most promising ones) */
+    std::size_t surrogate_k = 5;    /**< Number of neighbours of the knn surrogate */
+    std::size_t surrogate_archive = 1000; /**< Maximum number of evaluated genomes
+                                            in the surrogate archive (the oldest
+                                            ones are replaced) */
+    std::size_t eval_timeout_ms = 0; /**< Time budget of the evaluation of a
+                                       genome (0 disables it). An evaluation
+                                       that overruns it gets timeout_penalty
+                                       (see gaim_evaluation_expired) */
+    REAL_ timeout_penalty = -std::numeric_limits<REAL_>::max(); /**< Fitness of the
+                                                                   genomes whose
+                                                                   evaluation timed out */
+    std::size_t num_objectives = 1; /**< Number of objectives. Above 1 the GA runs
+                                      in multi-objective mode (NSGA-II survival,
+                                      see GA::multi_fitness) */
 } ga_parameter_s;
 
 
@@ -188,6 +287,15 @@ typedef struct parameter_im {
     std::string replace_method; /**< Name of method for displacing residents */
     std::string adj_list_fname; /**< Name of the file containing adjacency list (pop. graph) */
     bool is_im_enabled = false; /**< Boolean flag indicating if IM is enabled or not */
+    std::string topology_method = "static"; /**< Topology policy applied at migration
+                                              points. Can be one of: static, random,
+                                              fitness, and epoch */
+    std::size_t rewiring_interval = 1; /**< Number of migrations between two
+                                         consecutive topology updates */
+    std::size_t rewiring_degree = 1; /**< Number of source islands per island
+                                       (random and fitness policies) */
+    std::vector<std::string> epoch_graph_fnames; /**< Graph files the epoch policy
+                                                   cycles through */
 } im_parameter_s;
 
 
@@ -205,6 +313,12 @@ typedef struct parameter_pr {
     bool print_average_fitness; /**< Boolean flag for printing average fitness of a population */
     bool print_bsf; /**< Boolean flag for printing best-so-far fitness of a population */
     bool print_best_genome; /**< Boolean flag for printing the best genome of a population */
+    std::size_t profile_interval = 0; /**< Dumps the profile (GAIM_PROFILE builds) every
+                                        profile_interval generations (0 disables it) */
+    std::string metrics_target = ""; /**< Live metrics destination, either
+                                       "file:/path/to/metrics.prom" or
+                                       "unix:/path/to/socket" (empty disables it) */
+    std::size_t metrics_period_ms = 1000; /**< Live metrics publishing period (ms) */
 } pr_parameter_s;
 
 
@@ -219,12 +333,93 @@ typedef struct individual {
                           individual has been selected for procreating */
     std::size_t id;     /**< Individual's Unique ID */
     REAL_ fitness;      /**< Individual's Fitness value */
+    bool is_evaluated = false;  /**< The fitness was computed by the fitness
+                                  function for the current genome */
     std::vector<REAL_> genome;  /**< Individual's Genome (vector of REAL_)*/
-    std::vector<REAL_> lower_limit; /**< Individual's Genome lower boundary */
-    std::vector<REAL_> upper_limit; /**< Individual's Genome upper boundary */
+    std::vector<REAL_> objectives;  /**< Objective values (multi-objective
+                                      mode only, see num_objectives) */
 } individual_s;
 
 
+/**
+ * @brief Structure holding the fitness statistics of a population.
+ *
+ * The statistics are computed once per generation in a single pass over the
+ * fitness values (see population_statistics) and shared by the elitism, the
+ * logging, the live metrics and the migration.
+ */
+typedef struct population_stats {
+    REAL_ min = 0;      /**< Lowest fitness */
+    REAL_ max = 0;      /**< Highest fitness */
+    REAL_ mean = 0;     /**< Average fitness */
+    REAL_ variance = 0; /**< Variance of the fitness */
+    REAL_ sum = 0;      /**< Sum of the fitness (cumulative fitness) */
+    std::size_t argmin = 0; /**< Index of the individual with the lowest fitness */
+    std::size_t argmax = 0; /**< Index of the individual with the highest fitness */
+} population_stats_s;
+
+
+/**
+ * @brief Structure holding the state of the vectorized random number
+ * generator.
+ *
+ * GAIM_VLANES independent xoshiro128+ generators whose state is laid out
+ * lane-wise, so one step of all the generators maps to a few SIMD
+ * instructions. Scalar draws are served from a buffer of one full step.
+ */
+typedef struct vrng {
+    uint32_t s[4][GAIM_VLANES]; /**< Generators state (four words per lane) */
+    uint32_t buffer[GAIM_VLANES]; /**< Buffered outputs for scalar draws */
+    std::size_t pos;    /**< Next unused position in buffer */
+} vrng_s;
+
+
+/**
+ * @brief Structure holding the per-phase timers and counters of a GA (or an
+ * island).
+ *
+ * The fields are updated only when GAIM is compiled with GAIM_PROFILE;
+ * otherwise they remain zero. Times are accumulated in nanoseconds.
+ */
+typedef struct ga_profile {
+    uint64_t evaluation_ns = 0;     /**< Fitness evaluation */
+    uint64_t sorting_ns = 0;        /**< Population sorting */
+    uint64_t selection_ns = 0;      /**< Parents selection */
+    uint64_t crossover_ns = 0;      /**< Crossover */
+    uint64_t mutation_ns = 0;       /**< Mutation */
+    uint64_t replacement_ns = 0;    /**< Next generation (replacement) */
+    uint64_t clipping_ns = 0;       /**< Genome clipping */
+    uint64_t migration_ns = 0;      /**< Selection and moving of migrants (IM) */
+    uint64_t barrier_wait_ns = 0;   /**< Waiting at the islands barrier (IM) */
+    uint64_t mutex_wait_ns = 0;     /**< Waiting for the islands mutex (IM) */
+    uint64_t generations = 0;       /**< Number of generations */
+    uint64_t evaluations = 0;       /**< Number of fitness evaluations */
+    uint64_t allocations = 0;       /**< Temporary buffers (arena) within generations */
+    uint64_t migrants_sent = 0;     /**< Individuals sent to other islands */
+    uint64_t migrants_received = 0; /**< Individuals received from other islands */
+    uint64_t timeouts = 0;          /**< Fitness evaluations that timed out */
+} ga_profile_s;
+
+
+/**
+ * @brief Structure holding the live metrics snapshot of a GA (or an island).
+ *
+ * The GA publishes its state at the end of every generation with relaxed
+ * atomic stores, and the MetricsExporter thread reads it, so the evolution
+ * never waits for the exporter. The diversity is computed only when the
+ * exporter asks for it (once per publishing period).
+ */
+typedef struct island_metrics {
+    std::atomic<uint64_t> generation{0};    /**< Current generation */
+    std::atomic<uint64_t> evaluations{0};   /**< Fitness evaluations so far */
+    std::atomic<uint64_t> timeouts{0};      /**< Fitness evaluations that timed out */
+    std::atomic<REAL_> bsf{0};      /**< Best so far fitness (bsf_fitness) */
+    std::atomic<REAL_> average_fitness{0};  /**< Average fitness of the population */
+    std::atomic<REAL_> diversity{0};    /**< Mean standard deviation of the genes */
+    std::atomic<bool> diversity_requested{true};  /**< Set by the exporter */
+} island_metrics_s;
+
+
 /**
  * @brief Structure that holds the returned results from the ga_optimization
  * function. 
@@ -237,11 +432,400 @@ typedef struct ga_results {
     std::vector<REAL_> genome; /**< Best genome */
     std::vector<REAL_> bsf;   /**< BSF record */
     std::vector<REAL_> average_fitness;  /**< Average fitness record */
+    std::vector<ga_profile_s> profile;  /**< Profile of every run or island
+                                          (GAIM_PROFILE builds) */
+    std::vector<REAL_> pareto_genomes;  /**< Genomes of the Pareto front, row-wise
+                                          (multi-objective mode) */
+    std::vector<REAL_> pareto_objectives;   /**< Objectives of the Pareto front,
+                                              row-wise (multi-objective mode) */
 } ga_results_s;
 
 
+/**
+ * @brief Header of a binary clipping values file (see
+ * convert_clipping_file).
+ *
+ * The header is followed by population_size rows, each of genome_size lower
+ * limits and genome_size upper limits of value_size bytes (native byte
+ * order). The file is memory-mapped and shared by all the GAs.
+ */
+typedef struct clipping_header {
+    char magic[8];          /**< "GAIMCLIP" */
+    uint32_t version;       /**< Format version (1) */
+    uint32_t value_size;    /**< Bytes per value (4 float, 8 double) */
+    uint64_t population_size;   /**< Number of rows (individuals) */
+    uint64_t genome_size;   /**< Number of genes */
+} clipping_header_s;
+
+
+/**
+ * @brief Version of a file whose contents are cached (see FileCache).
+ *
+ * A file rewritten within the same second, or replaced by another file of the
+ * same size, still gets a new version (inode, modification time in ns).
+ */
+typedef struct file_version {
+    dev_t device;           /**< Device holding the file */
+    ino_t inode;            /**< Inode of the file */
+    off_t size;             /**< Size in bytes */
+    time_t mtime_s;         /**< Modification time (seconds) */
+    long mtime_ns;          /**< Modification time (nanoseconds) */
+} file_version_s;
+
+
+/**
+ * @brief Header of the shared memory of an evaluation worker (see
+ * ProcessEvaluator).
+ *
+ * The header is followed by capacity genomes of genome_size values and
+ * capacity costs, all of value_size bytes (native byte order).
+ */
+typedef struct worker_header {
+    char magic[8];          /**< "GAIMWORK" */
+    uint32_t version;       /**< Format version (1) */
+    uint32_t value_size;    /**< Bytes per value (4 float, 8 double) */
+    uint64_t genome_size;   /**< Number of genes */
+    uint64_t capacity;      /**< Maximum number of genomes of a request */
+} worker_header_s;
+
+
+/**
+ * @brief Opaque handle of an optimization engine (a GA or an IM kept alive
+ * between the calls of the handle-based API).
+ */
+typedef struct gaim_engine gaim_engine_s;
+
+
+/**
+ * @brief Dimensions and progress of an engine (see gaim_get_info).
+ */
+typedef struct gaim_info {
+    std::size_t genome_size;    /**< Number of genes */
+    std::size_t population_size;    /**< Individuals per island */
+    std::size_t num_islands;    /**< Number of islands (1 for a single GA) */
+    std::size_t generation;     /**< Generations run so far */
+} gaim_info_s;
+
+
+/**
+ * @brief A problem queued on a BatchSolver.
+ *
+ * The GA parameters of the problem and its fitness function. Either fitness
+ * or batch_fitness (see GA::batch_fitness) must be set; if both are set the
+ * batch function is used.
+ */
+typedef struct batch_problem {
+    ga_parameter_s ga_pms;  /**< GA parameters */
+    REAL_ (*fitness)(REAL_ *, size_t) = nullptr;    /**< Fitness function */
+    void (*batch_fitness)(REAL_ *, size_t, size_t, REAL_ *, void *) = nullptr;
+                                    /**< Batch fitness function */
+    void *batch_data = nullptr;     /**< User data passed to batch_fitness */
+} batch_problem_s;
+
+
 #ifdef __cplusplus
 
+/**
+ * @brief Statistics recording policy.
+ *
+ * Decides which generations are appended to the statistics records of a GA
+ * (BSF, average, highest and lowest fitness) and bounds their size. When the
+ * records reach their capacity every other record is dropped and, for the all
+ * and interval policies, the recording interval is doubled, so the records
+ * always span the entire run at a uniform resolution.
+ */
+class RecordPolicy {
+    public:
+        RecordPolicy(std::string policy="all", size_t interval=1, size_t capacity=0);
+
+        /// Returns true if the given generation has to be recorded
+        bool due(size_t, REAL_);
+        /// Returns true if the records are full (they must be decimated first)
+        bool full(void) const { return capacity && generations.size() >= capacity; }
+        /// Drops every other record of the recorded generations
+        void decimate(void);
+        /// Registers a recorded generation
+        void push(size_t, REAL_);
+        /// Forgets the recorded generations (initial interval)
+        void clear(void);
+        /// Appends the statistics of a due generation to their records
+        /// (decimating them first when they are full)
+        bool record(size_t, REAL_,
+                    std::initializer_list<std::pair<std::vector<REAL_> *, REAL_>>);
+        /// Returns the maximum number of records (0 means unbounded)
+        size_t get_capacity(void) const { return capacity; }
+        /// Returns the generations that have been recorded
+        const std::vector<size_t> &get_generations() const { return generations; }
+
+        /// Drops every other element of a record
+        template <class T>
+        static void decimate(std::vector<T> &x) {
+            size_t n = 0;
+            for (size_t i = 0; i < x.size(); i += 2) {
+                x[n++] = x[i];
+            }
+            x.resize(n);
+        }
+
+    private:
+        std::string policy;
+        size_t interval;    /// Initial recording interval (all, interval)
+        size_t stride;      /// Current recording interval (all, interval)
+        size_t capacity;    /// Maximum number of records (0 unbounded)
+        REAL_ last_best;    /// Last recorded best fitness (improvement)
+        std::vector<size_t> generations;    /// Recorded generations
+};
+
+
+/**
+ * @brief Run-level cancellation token.
+ *
+ * A token shared by the caller and the GAs (or IMs) it is attached to (see
+ * GA::cancel_token). Cancelling it from any thread (a watchdog, a signal
+ * handler) stops the evolution between two generations; the records and the
+ * best-so-far individual of the generations run so far remain valid.
+ */
+class CancelToken {
+    public:
+        /// Requests the evolution to stop
+        void cancel(void) { cancelled.store(true, std::memory_order_relaxed); }
+        /// Returns true if the evolution has to stop
+        bool is_cancelled(void) const { return cancelled.load(std::memory_order_relaxed); }
+        /// Clears the request
+        void reset(void) { cancelled.store(false, std::memory_order_relaxed); }
+
+    private:
+        std::atomic<bool> cancelled{false};
+};
+
+
+/**
+ * @brief Error raised by fatal_error under a FatalErrorGuard.
+ */
+class FatalError : public std::runtime_error {
+    public:
+        FatalError() : std::runtime_error("GAIM fatal error") {}
+};
+
+
+/**
+ * @brief Scope in which the fatal errors of the current thread (invalid
+ * parameters, unreadable files) throw FatalError instead of terminating the
+ * process, so a caller such as gaim_create can report them. The error
+ * message is printed either way.
+ */
+class FatalErrorGuard {
+    public:
+        FatalErrorGuard();
+        ~FatalErrorGuard();
+        FatalErrorGuard(const FatalErrorGuard &) = delete;
+        FatalErrorGuard &operator=(const FatalErrorGuard &) = delete;
+
+    private:
+        bool previous;  /// State of the enclosing scope
+};
+
+
+/**
+ * @brief Surrogate model of the fitness function.
+ *
+ * It keeps an archive of the genomes evaluated by the fitness function (a
+ * ring buffer, updated after every evaluation) and predicts the fitness of
+ * new genomes from their k nearest neighbours in the archive (inverse squared
+ * distance weighting, genes scaled by their interval [a, b]). The GA uses the
+ * predictions to send only the most promising offspring to the fitness
+ * function (see ga_parameter_s::surrogate).
+ */
+class SurrogateModel {
+    public:
+        SurrogateModel(std::string method="none",
+                       size_t k=5,
+                       size_t capacity=1000,
+                       const std::vector<REAL_> &a=std::vector<REAL_>(),
+                       const std::vector<REAL_> &b=std::vector<REAL_>());
+
+        /// Returns true if the offspring are pre-screened
+        bool enabled(void) const { return is_enabled; }
+        /// Adds an evaluated genome to the archive
+        void add(const REAL_ *, REAL_);
+        /// Predicts the fitness of a genome
+        REAL_ predict(const REAL_ *) const;
+        /// Number of genomes in the archive
+        size_t size(void) const { return values.size(); }
+        /// Empties the archive
+        void clear(void);
+
+    private:
+        bool is_enabled;
+        size_t k;           /// Number of neighbours
+        size_t capacity;    /// Maximum number of genomes in the archive
+        size_t next;        /// Next archive slot to replace (when full)
+        std::vector<REAL_> scale;   /// Per-gene distance scale (1 / (b - a)^2)
+        std::vector<REAL_> genomes; /// Archived genomes (row-wise)
+        std::vector<REAL_> values;  /// Archived fitness values
+};
+
+
+/**
+ * @brief Structure holding the statistics of an Arena.
+ */
+typedef struct arena_stats {
+    std::size_t allocations = 0;    /**< Allocations served since the last reset */
+    std::size_t bytes = 0;          /**< Bytes in use since the last reset */
+    std::size_t peak_bytes = 0;     /**< Largest number of bytes in use between
+                                      two resets */
+    std::size_t capacity = 0;       /**< Bytes reserved from the heap */
+    std::size_t chunks = 0;         /**< Number of chunks reserved from the heap */
+    std::size_t resets = 0;         /**< Number of resets (generations) */
+    std::size_t total_allocations = 0;  /**< Allocations served overall */
+} arena_stats_s;
+
+
+/**
+ * @brief Generation-scoped arena (bump) allocator.
+ *
+ * Every GA owns an arena that serves the temporary buffers of a generation
+ * (selection indices, sets of the fusion mutation, migration buffers) and is
+ * reset at the generation boundary. Allocations only bump an offset, memory
+ * is never released individually, and the reserved chunks are reused by the
+ * next generation, so the islands do not contend on the global heap. An arena
+ * is used by a single thread, and copying a GA gives the copy an empty arena
+ * (moving a GA moves its chunks along).
+ */
+class Arena {
+    public:
+        Arena(size_t chunk_size=64*1024);
+        Arena(const Arena &);
+        Arena(Arena &&) noexcept;
+        Arena &operator=(const Arena &);
+        Arena &operator=(Arena &&) noexcept;
+        ~Arena();
+
+        /// Returns a block of bytes aligned to alignment
+        void *allocate(size_t, size_t);
+        /// Releases all the blocks at once (generation boundary)
+        void reset(void);
+        /// Returns the statistics of the arena
+        const arena_stats_s &get_stats(void) const { return stats; }
+
+    private:
+        void release(void);
+
+        std::vector<std::pair<char *, size_t>> chunks;  /// Reserved chunks
+        size_t current;     /// Chunk serving the allocations
+        size_t offset;      /// First free byte of the current chunk
+        size_t chunk_size;  /// Minimum size of a chunk
+        arena_stats_s stats;
+};
+
+
+/**
+ * @brief STL allocator drawing from an Arena (deallocation is a no-op).
+ */
+template <class T>
+class arena_allocator {
+    public:
+        typedef T value_type;
+
+        arena_allocator(Arena *a) noexcept : arena(a) {}
+        template <class U>
+        arena_allocator(const arena_allocator<U> &other) noexcept : arena(other.arena) {}
+
+        T *allocate(std::size_t n) {
+            return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+        }
+        void deallocate(T *, std::size_t) noexcept {}
+
+        Arena *arena;
+};
+
+template <class T, class U>
+bool operator==(const arena_allocator<T> &a, const arena_allocator<U> &b)
+{ return a.arena == b.arena; }
+
+template <class T, class U>
+bool operator!=(const arena_allocator<T> &a, const arena_allocator<U> &b)
+{ return a.arena != b.arena; }
+
+/// Vector whose storage lives in an Arena
+template <class T>
+using arena_vector = std::vector<T, arena_allocator<T>>;
+
+/**
+ * Removes an element from a vector (any allocator) by swaping the element at
+ * position n with the last one and poping it out of the vector.
+ */
+template <class V>
+void remove_at(V &v, typename V::size_type n)
+{
+    std::swap(v[n], v.back());
+    v.pop_back();
+}
+
+
+/// Maximum number of files kept by a FileCache
+#define GAIM_FILE_CACHE_SIZE 32
+
+/// Returns the version of a file from its status (stat)
+file_version_s get_file_version(const struct stat &);
+/// Tells whether two versions of a file are the same
+bool operator==(const file_version_s &, const file_version_s &);
+
+
+/**
+ * @brief Cache of the contents of the files read by the optimizations
+ * (clipping values, connectivity graphs).
+ *
+ * Contents are kept per file name until the file changes (see
+ * file_version_s). At most GAIM_FILE_CACHE_SIZE files are kept, the least
+ * recently used being dropped first, and clear_file_caches() drops them all.
+ * The caller holds mtx around find and insert.
+ */
+template <class T>
+class FileCache {
+    public:
+        /// Returns the contents of a file (nullptr if not cached or changed)
+        T *find(const std::string &fname, const file_version_s &version) {
+            auto it = entries.find(fname);
+            if (it == entries.end() || !(it->second.version == version)) {
+                return nullptr;
+            }
+            it->second.last_use = ++clock;
+            return &it->second.contents;
+        }
+        /// Stores the contents of a file, evicting the least recently used
+        T &insert(const std::string &fname, const file_version_s &version,
+                  T &&contents) {
+            entries.erase(fname);
+            if (entries.size() >= GAIM_FILE_CACHE_SIZE) {
+                auto lru = entries.begin();
+                for (auto it = entries.begin(); it != entries.end(); ++it) {
+                    if (it->second.last_use < lru->second.last_use) { lru = it; }
+                }
+                entries.erase(lru);
+            }
+            entry &e = entries[fname];
+            e = {version, ++clock, std::move(contents)};
+            return e.contents;
+        }
+        /// Drops all the cached files
+        void clear(void) { entries.clear(); }
+        /// Number of cached files
+        size_t size(void) const { return entries.size(); }
+
+        std::mutex mtx;     /// Serializes the readers of the files
+
+    private:
+        struct entry {
+            file_version_s version;
+            uint64_t last_use;
+            T contents;
+        };
+        std::map<std::string, entry> entries;
+        uint64_t clock = 0;
+};
+
+
 /**
  * @brief Genetic Algorithm main class. 
  *
@@ -251,8 +835,20 @@ typedef struct ga_results {
  */
 class GA {
     public:
-        GA(ga_parameter_s *); /**< Constructor method of GA class */
-        ~GA();              /**< Destructor method of GA */
+        GA(const ga_parameter_s *); /**< Constructor method of GA class */
+        /// Re-initializes the GA for a new problem (reusing its memory)
+        void reset(const ga_parameter_s *);
+        /// Forgets the best-so-far individual and the records
+        void clear_records(void);
+        /**
+         * GAs are moved (never copied) into the islands and runs vectors, so
+         * copies are disabled and the move operations must stay noexcept.
+         */
+        GA(const GA &) = delete;
+        GA(GA &&) = default;
+        GA &operator=(const GA &) = delete;
+        GA &operator=(GA &&) = default;
+        ~GA() = default;    /**< Destructor method of GA */
 
         /**
          * Genetic Algorithm basic operators
@@ -313,34 +909,127 @@ class GA {
         /// Reset the flag is_selected (used from selections methods when
         // non-replacement is enabled
         void reset_selection_flags();
-        /// Clips the values of genes for each individual based on its lower 
-        // and upper boundaries (this works only when independent limits for
-        // each gene are being used
+        /// Clips the values of genes for each individual based on the lower
+        // and upper limits (see get_lower_limit)
         void clip_genome();
         /// Sorting individuals based on their fitness value
         void sort_population(void);
         /// Main routine for running one single generation step
         void run_one_generation(void);
         /// Main routine for evolving a population over generations
-        void evolve(size_t, size_t, pr_parameter_s *); 
+        void evolve(size_t, size_t, const pr_parameter_s *);
+        /// Runs a number of generations continuing the previous ones (no
+        // logging)
+        void step(size_t);
+        /// Number of generations run so far
+        size_t get_generation() const { return current_generation; }
+        /// Publishes the live metrics snapshot (if a metrics slot is attached)
+        void publish_metrics(void);
+        /// Appends the statistics of a generation to the records (see
+        // RecordPolicy)
+        void record_statistics(REAL_, REAL_, REAL_);
+        /// Re-inserts the archived best-so-far individual if the population
+        // has lost it (elitism)
+        void restore_elite(void);
+        /// Computes the fitness statistics of the population (single pass)
+        void update_statistics(void);
+        /// Ranks the population by non-domination and crowding
+        // (multi-objective mode)
+        void rank_population(void);
+        /// Keeps the best mu of the population and the offspring by
+        // non-domination and crowding (multi-objective mode)
+        void survival_selection(void);
+        /// Non-dominated individuals of the population (multi-objective mode)
+        std::vector<individual_s> get_pareto_front(void) const;
+        /// Number of objectives (1 unless in multi-objective mode)
+        size_t get_num_objectives(void) const { return num_objectives; }
+
+        island_metrics_s *metrics;  /// Live metrics slot (nullptr disables it)
+        /// Stops evolve and step between two generations once cancelled
+        // (nullptr disables it)
+        const CancelToken *cancel_token;
+        Arena arena;    /// Temporary buffers of the current generation
+        vrng_s vrng;    /// Vectorized RNG used by the SIMD mutation kernels
+        ga_profile_s profile;   /// Per-phase timers and counters
 
         std::vector<REAL_> &get_bsf(){ return bsf; }
         std::vector<REAL_> &get_best_genome(){ return bsf_genome; }
         std::vector<REAL_> &get_average_fitness(){ return fit_avg; }
+        const std::vector<REAL_> &get_bsf() const { return bsf; }
+        const std::vector<REAL_> &get_best_genome() const { return bsf_genome; }
+        const std::vector<REAL_> &get_average_fitness() const { return fit_avg; }
+        /// Statistics of the temporary buffers arena
+        const arena_stats_s &get_arena_stats() const { return arena.get_stats(); }
+        /// Generations the records (BSF, average fitness) correspond to
+        const std::vector<size_t> &get_record_generations() const {
+            return recorder.get_generations(); }
         REAL_ (*fitness)(REAL_ *, size_t);
+        /// Fitness function of the multi-objective mode. It fills in the
+        // num_objectives values of a genome (all of them maximized)
+        void (*multi_fitness)(REAL_ *, size_t, REAL_ *, size_t);
+        /// Batch fitness function. When set, it replaces fitness and receives
+        // all the genomes of an evaluation at once (n x genome_size,
+        // row-wise), the n costs to fill in, and batch_data
+        // (n x num_objectives costs in multi-objective mode)
+        void (*batch_fitness)(REAL_ *, size_t, size_t, REAL_ *, void *);
+        void *batch_data;   /// User data passed to batch_fitness
+        /// Packs the genomes of the individuals row-wise into genome_matrix
+        void pack_genomes(const std::vector<individual_s> &);
+        std::vector<REAL_> genome_matrix;   /// Packed genomes (batch evaluation)
+        std::vector<REAL_> batch_costs;     /// Costs of the packed genomes
+        std::vector<REAL_> objective_matrix;    /// Packed objectives (ranking)
+
+        /// Clipping limits of the genes of individual i (see clip_genome)
+        const REAL_ *get_lower_limit(size_t i) const {
+            return clipping_bounds ? clipping_bounds.get() + 2 * i * genome_size
+                                   : lower_limit.data(); }
+        const REAL_ *get_upper_limit(size_t i) const {
+            return clipping_bounds ? clipping_bounds.get() + (2 * i + 1) * genome_size
+                                   : upper_limit.data(); }
 
         std::vector<individual_s> population; /// Individuals population vector
         std::vector<individual_s> offsprings;   /// Offsprings vector 
         std::vector<individual_s> sorted_population;  /// Sorted population vector
-        individual_s best_individual;   /// Best individual (keep track)
+                                                      // (sort_population() on demand)
         std::vector<REAL_> bsf;     /// BSF vector (keep track)
         std::vector<REAL_> fit_avg;  /// Average fitness vector (keep track)
         std::vector<REAL_> hfi; /// Highest fitness in the population
         std::vector<REAL_> lfi; /// Lowest fitness in the population
-        std::vector<REAL_> bsf_genome; /// BSF genome
+        std::vector<REAL_> bsf_genome; /// BSF genome (archived elite)
+        REAL_ bsf_fitness;  /// Fitness of the BSF genome
+        population_stats_s stats;   /// Fitness statistics of the population
+        RecordPolicy recorder;  /// Statistics recording policy
+        SurrogateModel surrogate;   /// Offspring pre-screening (optional)
 
     private:
+        /// Sets the clipping limits (see get_lower_limit)
+        void init_clipping(const ga_parameter_s *);
+        /// Initializes the genomes of the population (see init_method)
+        void init_population(const ga_parameter_s *);
+        /// Sets the surrogate model (see SurrogateModel)
+        void init_surrogate(const ga_parameter_s *);
+        /// Sets the time budget of the evaluations (see eval_timeout_ms)
+        void init_timeout(const ga_parameter_s *);
+        /// Sets the number of objectives (see num_objectives)
+        void init_objectives(const ga_parameter_s *);
+        /// Evaluates the individuals whose fitness is not known (surrogate)
+        void evaluate_stale(std::vector<individual_s> &);
+        /// Evaluates the most promising offspring (see SurrogateModel)
+        void screen_offsprings(void);
+        REAL_ surrogate_fraction;   /// Fraction of the offspring evaluated
+        size_t eval_timeout_ms;     /// Time budget of a fitness function call
+        REAL_ timeout_penalty;      /// Fitness of the timed out evaluations
+        size_t num_objectives;      /// Number of objectives (multi-objective mode)
+
         std::vector<REAL_> alpha, beta;  /// Genome's interval limits [a, b]
+        /// Clipping limits shared by all the individuals, one per gene
+        // ("universal" and "individual" clipping)
+        std::vector<REAL_> lower_limit, upper_limit;
+        /// Clipping limits per individual ("file" clipping), mu rows of
+        // genome_size lower limits followed by genome_size upper limits,
+        // shared read-only by all the GAs reading the same file
+        std::shared_ptr<const REAL_> clipping_bounds;
+        bool universal_clipping;    /// All the genes share the same limits
         std::vector<individual_s> immigrant;    /// Immigrants vector (buffer)
         std::string selection_method;
         std::string crossover_method;
@@ -353,6 +1042,7 @@ class GA {
         size_t mu;     /// Number of individuals within a population
         size_t lambda; /// Number of offsprings
         size_t replace_perc;   /// Number of individuals being replaced 
+        size_t elitism;        /// Number of individuals protected from replacement
         size_t genome_size;    /// Genome size (number of genes)
         size_t num_parents;    /// Number of parents per generation to select from
         size_t lower_bound;    /// Starting index for truncation selection
@@ -366,6 +1056,9 @@ class GA {
     friend class IM;
 };
 
+static_assert(std::is_nothrow_move_constructible<GA>::value,
+              "GA must be moved (not copied) by std::vector");
+
 
 /**
  * @brief Island Model main class.
@@ -378,7 +1071,7 @@ class GA {
 class IM {
     public:
         IM(im_parameter_s *,
-           ga_parameter_s *);
+           const ga_parameter_s *);
         ~IM();  /// IM Destructor method
         
         /**
@@ -398,60 +1091,304 @@ class IM {
          */
         /// Reads the connectivity graph (topology) from a file
         size_t read_connectivity_graph(std::string);
+        size_t read_connectivity_graph(std::string,
+                                       std::map<int, std::vector<int>> &);
+        /// Drops the parsed connectivity graphs (see clear_file_caches)
+        static void clear_graph_cache(void);
+        /// Updates the connectivity graph based on the topology policy
+        void rewire_topology(void);
+        /// Returns the current connectivity graph
+        const std::map<int, std::vector<int>> &get_topology(){ return adj_list; }
         /// Evolves an island (thread function)
-        void evolve_island(size_t, im_parameter_s *, pr_parameter_s *);
+        void evolve_island(size_t, im_parameter_s *, const pr_parameter_s *);
+        /// Runs a number of generations (and migrations) on an island
+        void run_island_generations(size_t, size_t, im_parameter_s *,
+                                    const pr_parameter_s *);
         /// Runs the Island Models 
-        void evolve_islands(im_parameter_s *, pr_parameter_s *);
+        void evolve_islands(im_parameter_s *, const pr_parameter_s *);
+        /// Runs a number of generations on all the islands (continuing the
+        // previous call, no logging)
+        void step_islands(size_t, im_parameter_s *, const pr_parameter_s *);
 
         std::vector<GA> island; /// Islands (threads) vector
+        /// Stops all the islands after the same generation once cancelled
+        // (nullptr disables it)
+        const CancelToken *cancel_token;
 
     private:
         std::vector<REAL_> a, b; /// Genome's interval [a, b]
         std::map<int, std::vector<int>> adj_list;   /// Adjacent list of islands
+        std::map<int, std::vector<int>> base_adj_list;  /// Topology read from file
+        std::vector<std::map<int, std::vector<int>>> epoch_adj_lists; /// Epoch topologies
+        std::string topology_method;    /// Topology policy (static, random, fitness, epoch)
+        size_t rewiring_interval;   /// Migrations between two topology updates
+        size_t rewiring_degree;     /// Number of sources per island
+        size_t num_migrations;      /// Number of migrations performed so far
+        size_t current_epoch;       /// Index of the active epoch topology
+        pcg32 topology_rng;         /// RNG for the random rewiring policy
+        std::vector<pcg32> migration_rng;   /// RNG of every island (migrants)
         size_t generations;     /// Generations
         size_t num_immigrants;  /// Number of immigrants
         size_t num_islands;     /// Number of islands (threads)
         size_t migration_interval;  /// Migration interval
         size_t migration_steps;    /// Generations / Migration Interval 
+        /// First generation (of the current call) after which the islands
+        // stop, agreed at the generation barrier
+        std::atomic<size_t> cancel_generation;
 
         std::mutex mtx;     // Mutex for locking threads
+        pthread_barrier_t barrier;  // Barrier for sync threads (per IM, so
+                                    // several IMs can run at the same time)
+};
+
+
+/**
+ * @brief Live metrics exporter.
+ *
+ * A side thread that periodically renders the metrics slots of a number of
+ * GAs (islands or independent runs) in Prometheus text format and publishes
+ * them either to a file (written atomically) or to every client connecting
+ * to a Unix socket.
+ */
+class MetricsExporter {
+    public:
+        MetricsExporter(std::string, size_t, size_t, std::string);
+        ~MetricsExporter();
+
+        /// Returns the metrics slot of GA (island) i
+        island_metrics_s *slot(size_t i){ return &slots[i]; }
+        /// Starts the exporter thread
+        void start(void);
+        /// Stops the exporter thread (publishing a final snapshot)
+        void stop(void);
+        /// Renders the metrics in Prometheus text format
+        std::string render(void);
+
+    private:
+        void run(void);
+        void publish(void);
+        void serve(int);
+
+        std::vector<island_metrics_s> slots;    /// One metrics slot per GA
+        std::vector<uint64_t> last_evaluations; /// Evaluations at the last update
+        std::vector<double> rates;  /// Evaluations per second
+        std::chrono::steady_clock::time_point last_update;
+        std::string mode;       /// "file" or "unix"
+        std::string path;       /// File or socket path
+        std::string experiment; /// Experiment name (label)
+        std::string text;       /// Last rendered snapshot
+        size_t period_ms;       /// Publishing period (ms)
+        int listen_fd;          /// Unix socket descriptor
+        bool running;
+        std::thread worker;
+        std::mutex mtx;
+        std::condition_variable cv;
+};
+
+
+/**
+ * @brief Batch optimization service.
+ *
+ * Runs many small, independent GA problems on a shared pool of worker
+ * threads. Every worker keeps the GAs it has built and reuses them (see
+ * GA::reset) for the next problems of the same shape, so the per-problem
+ * cost is the evolution itself and not the setup. Nothing is logged; the
+ * results are returned to the caller.
+ */
+class BatchSolver {
+    public:
+        BatchSolver(size_t num_workers=0);
+        ~BatchSolver();
+
+        /// Queues a problem and returns its ticket
+        size_t submit(const batch_problem_s &);
+        /// Waits for a problem and returns its results
+        ga_results_s get(size_t);
+        /// Solves a number of problems and returns their results in order
+        std::vector<ga_results_s> solve(const std::vector<batch_problem_s> &);
+        /// Waits until the queue is drained
+        void wait(void);
+        /// Returns the number of workers
+        size_t get_num_workers(void) const { return workers.size(); }
+
+    private:
+        void run(void);
+
+        std::deque<std::pair<size_t, batch_problem_s>> queue;   /// Queued problems
+        std::map<size_t, ga_results_s> done;    /// Results not yet collected
+        std::set<size_t> uncollected;   /// Tickets not yet passed to get
+        std::vector<std::thread> workers;       /// Worker threads
+        size_t next_ticket;     /// Ticket of the next problem
+        size_t pending;         /// Problems queued or running
+        bool stopping;
+        std::mutex mtx;
+        std::condition_variable cv_work;    /// Signals queued problems
+        std::condition_variable cv_done;    /// Signals finished problems
 };
 
 
+/**
+ * @brief Pool of local worker processes evaluating the fitness.
+ *
+ * Every worker owns a shared memory block (worker_header_s) and a socket.
+ * A request writes a chunk of genomes to the block and their number to the
+ * socket; the worker writes the costs back and echoes the number. The
+ * workers run either a fitness function in a forked copy of the process, or
+ * a command (e.g. a Python script) that serves the requests with
+ * gaim_worker_serve (or pygaim.worker.serve). A worker that crashes is
+ * restarted and its chunk is retried genome by genome, so only the genomes
+ * that crash it get crash_penalty. The GA is unchanged: the pool is plugged
+ * in as a batch fitness function (see process_batch_fitness).
+ *
+ * Forking a multithreaded process is unsafe (the child may inherit a lock
+ * held by another thread), so a pool of forked workers must be created
+ * while the process runs a single thread, e.g. before the islands, a
+ * BatchSolver or a metrics exporter start. The pool then forks a spawner
+ * process that starts (and restarts) the workers, so restarts remain safe
+ * while the optimization runs threads; the workers see the memory of the
+ * process as it was when the pool was created. Command workers have no
+ * restriction.
+ */
+class ProcessEvaluator {
+    public:
+        /// Workers running a fitness function (forked processes)
+        ProcessEvaluator(size_t, size_t, REAL_ (*)(REAL_ *, size_t),
+                         size_t capacity=256);
+        /// Workers running a command (see gaim_worker_serve)
+        ProcessEvaluator(size_t, size_t, const std::string &,
+                         size_t capacity=256);
+        ~ProcessEvaluator();
+        ProcessEvaluator(const ProcessEvaluator &) = delete;
+        ProcessEvaluator &operator=(const ProcessEvaluator &) = delete;
+
+        /// Evaluates n genomes (row-wise) with all the workers
+        void evaluate(const REAL_ *, size_t, REAL_ *);
+        /// Returns the number of workers
+        size_t get_num_workers(void) const { return workers.size(); }
+        /// Returns the number of restarted workers (crashes and timeouts)
+        size_t get_restarts(void) const { return restarts; }
+
+        REAL_ crash_penalty;    /// Cost of the genomes that crash a worker
+
+    private:
+        /// A worker process and its shared memory
+        struct worker {
+            pid_t pid = -1;
+            int fd = -1;            /// Socket (parent end)
+            REAL_ *genomes = nullptr;   /// Shared genomes of a request
+            REAL_ *costs = nullptr;     /// Shared costs of a request
+            int shm_fd = -1;        /// Shared memory file
+            size_t first = 0;       /// First genome of the running request
+            size_t count = 0;       /// Genomes of the running request (0 idle)
+            /// End of the time budget of the running request (see evaluate)
+            std::chrono::steady_clock::time_point deadline;
+        };
+
+        void create(size_t, size_t);
+        void spawn(worker &);
+        void restart(worker &);
+        void serve_spawns(int);
+
+        std::vector<worker> workers;
+        size_t genome_size;
+        size_t capacity;        /// Genomes per request
+        size_t shm_size;        /// Bytes of a shared memory block
+        REAL_ (*func)(REAL_ *, size_t); /// Fitness function (forked workers)
+        std::string command;    /// Worker command (command workers)
+        pid_t spawner_pid = -1; /// Process forking the workers (forked workers)
+        int spawner_fd = -1;    /// Socket of the spawner
+        size_t restarts;
+        std::mutex mtx;         /// Serializes the evaluations (islands)
+};
+
+
+/// Batch fitness function evaluating with a ProcessEvaluator (batch_data)
+void process_batch_fitness(REAL_ *, size_t, size_t, REAL_ *, void *);
+
+
 // Main island function
 ga_results_s run_islands(REAL_ (*func)(REAL_ *, size_t),
-                         im_parameter_s,
-                         ga_parameter_s,
-                         pr_parameter_s,
+                         const im_parameter_s &,
+                         const ga_parameter_s &,
+                         const pr_parameter_s &,
                          std::string);
 
+// Handle-based API from parameter structures (see gaim_create)
+gaim_engine_s *gaim_create_from_parameters(const ga_parameter_s &,
+                                           const pr_parameter_s &,
+                                           const im_parameter_s &,
+                                           REAL_ (*func)(REAL_ *, size_t));
+
 // Auxiliary functions (only for C++)
-void remove_at(std::vector<size_t>&, typename std::vector<size_t>::size_type);
+ga_results_s return_best_results(std::vector<GA> &&, std::string);
+std::shared_ptr<const REAL_> read_clipping_file(const std::string &,
+                                                size_t,
+                                                size_t);
+int convert_clipping_file(const std::string &,
+                          const std::string &,
+                          size_t,
+                          size_t);
+void clear_file_caches(void);
+[[noreturn]] void fatal_error(int status=-1);
+std::vector<REAL_> read_seed_genomes(const std::string &, size_t);
+int write_seed_genomes(const std::string &, const std::vector<individual_s> &, size_t);
+std::vector<size_t> non_dominated_sort(const REAL_ *, size_t, size_t);
+std::vector<REAL_> crowding_distance(const REAL_ *, size_t, size_t,
+                                     const std::vector<size_t> &);
+std::vector<individual_s> pareto_front(const std::vector<individual_s> &);
+void pack_pareto_front(const std::vector<individual_s> &, ga_results_s &);
 size_t int_random(size_t, size_t);
 REAL_ float_random(REAL_, REAL_);
 
+// Vectorized RNG and SIMD kernels (only for C++)
+void vrng_seed(vrng_s *, uint64_t);
+void vrng_uniform(vrng_s *, REAL_ *);
+void vrng_normal(vrng_s *, REAL_ *);
+uint32_t vrng_bounded(vrng_s *, uint32_t);
+REAL_ vrng_real(vrng_s *);
+void simd_delta_mutation(REAL_ *, size_t, REAL_, REAL_, vrng_s *);
+void simd_nonuniform_mutation(REAL_ *, size_t, REAL_, REAL_, vrng_s *);
+void simd_clip(REAL_ *, const REAL_ *, const REAL_ *, size_t);
+void simd_clip_uniform(REAL_ *, REAL_, REAL_, size_t);
+const char *simd_isa(void);
+
+// Profiling (only for C++)
+void print_profile(const ga_profile_s &,
+                   size_t,
+                   size_t unique_id=0,
+                   std::string write_to="stdout");
+ga_profile_s &operator+=(ga_profile_s &, const ga_profile_s &);
+
+/// Nanoseconds elapsed since t
+inline uint64_t profile_elapsed_ns(std::chrono::steady_clock::time_point t)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t).count();
+}
+
 #endif  /* __cplusplus  */
 
 #ifdef __cplusplus
-extern "C" {
+GAIM_EXTERN_C_BEGIN
 #endif
 
 /// Auxiliary Functions declarations
-bool compare_fitness(const individual_s, const individual_s);
-REAL_ average_fitness(REAL_, const individual_s);
+bool compare_fitness(const individual_s &, const individual_s &);
+REAL_ average_fitness(REAL_, const individual_s &);
+population_stats_s population_statistics(const std::vector<individual_s> &);
 bool is_path_exist(const std::string &);
 int mkdir_(const std::string &);
 int make_dir(const std::string &);
 int remove_file(const std::string);
 REAL_ calculate_whitley_factor(REAL_);
-REAL_ maximum_fitness(std::vector<individual_s>);
-REAL_ nonselected_maximum_fitness(std::vector<individual_s>);
-REAL_ cumulative_fitness(std::vector<individual_s>);
+REAL_ maximum_fitness(const std::vector<individual_s> &);
+REAL_ nonselected_maximum_fitness(const std::vector<individual_s> &);
+REAL_ cumulative_fitness(const std::vector<individual_s> &);
 REAL_ vector_norm(std::vector<REAL_>);
 int argmin(std::vector<REAL_>);
 int argmax(std::vector<REAL_>);
-std::vector<REAL_> compute_population_norms(std::vector<GA>);
-ga_results return_best_results(std::vector<GA>, std::string);
+std::vector<REAL_> compute_population_norms(const std::vector<GA> &);
+ga_results return_best_results(const std::vector<GA> &, std::string);
 
 
 
@@ -488,10 +1425,18 @@ void print_results(std::vector<individual_s>,
 /// End-user can define more at her/his will
 // REAL_ sphere(std::vector<REAL_>&);
 REAL_ sphere(REAL_ *, size_t);
-REAL_ rastrigin(std::vector<REAL_>&);
-REAL_ schwefel(std::vector<REAL_>&);
-REAL_ griewank(std::vector<REAL_>&);
-REAL_ tsm(std::vector<REAL_>& x);
+REAL_ rastrigin(REAL_ *, size_t);
+REAL_ schwefel(REAL_ *, size_t);
+REAL_ griewank(REAL_ *, size_t);
+REAL_ tsm(REAL_ *, size_t);
+void sphere_objectives(REAL_ *, size_t, REAL_ *, size_t);
+
+/// Batch variants of the demo objective functions (n genomes stored
+/// row-wise, one cost per genome)
+void sphere_batch(REAL_ *, size_t, size_t, REAL_ *);
+void rastrigin_batch(REAL_ *, size_t, size_t, REAL_ *);
+void schwefel_batch(REAL_ *, size_t, size_t, REAL_ *);
+void griewank_batch(REAL_ *, size_t, size_t, REAL_ *);
 
 
 /// Parameters files
@@ -542,10 +1487,15 @@ ga_results_s ga_optimization(REAL_ (*func)(REAL_ *, size_t),
                              bool log_fitness=false,
                              bool log_average_fitness=true,
                              bool log_bsf=true,
-                             bool log_best_genome=true);
+                             bool log_best_genome=true,
+                             bool log_parameters=false);
 
+#ifdef __cplusplus
+GAIM_EXTERN_C_END
+extern "C" {
+#endif
 
-void ga_optimization_python(REAL_ (*func)(REAL_ *, size_t),
+void GAIM_C_NAME(ga_optimization_python)(REAL_ (*func)(REAL_ *, size_t),
                             size_t n_generations,
                             size_t population_size,
                             size_t genome_size,
@@ -588,7 +1538,39 @@ void ga_optimization_python(REAL_ (*func)(REAL_ *, size_t),
                             REAL_ **bsf,
                             REAL_ **agv_fitness);
 
+/// Handle-based API (engines stay alive between the calls, see engine.cpp)
+gaim_engine_s *GAIM_C_NAME(gaim_create)(const char *,
+                                        REAL_ (*func)(REAL_ *, size_t));
+void GAIM_C_NAME(gaim_set_batch_fitness)(gaim_engine_s *,
+                                         void (*func)(REAL_ *, size_t, size_t,
+                                                      REAL_ *, void *),
+                                         void *);
+size_t GAIM_C_NAME(gaim_step)(gaim_engine_s *, size_t);
+void GAIM_C_NAME(gaim_get_info)(const gaim_engine_s *, gaim_info_s *);
+size_t GAIM_C_NAME(gaim_get_population)(const gaim_engine_s *, size_t,
+                                        REAL_ *, REAL_ *);
+int GAIM_C_NAME(gaim_set_population)(gaim_engine_s *, size_t,
+                                     const REAL_ *, size_t);
+REAL_ GAIM_C_NAME(gaim_get_best)(const gaim_engine_s *, REAL_ *);
+void GAIM_C_NAME(gaim_cancel)(gaim_engine_s *);
+void GAIM_C_NAME(gaim_destroy)(gaim_engine_s *);
+
+/// Evaluation worker main loop (see ProcessEvaluator)
+int GAIM_C_NAME(gaim_worker_serve)(REAL_ (*func)(REAL_ *, size_t));
+
+/// Time budget of the running fitness function call (see eval_timeout_ms)
+int GAIM_C_NAME(gaim_evaluation_expired)(void);
+double GAIM_C_NAME(gaim_evaluation_remaining_ms)(void);
+double GAIM_C_NAME(gaim_evaluation_budget_ms)(void);
+
 #ifdef __cplusplus
 }
 #endif
+
+GAIM_END_NAMESPACE
+
+#ifdef GAIM_DOUBLE
+using namespace gaim_double;
+#endif
+
 #endif  // GENETIC_ALG_H
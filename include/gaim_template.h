@@ -0,0 +1,545 @@
+/* Header file "gaim_template.h" of GAIM package
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file gaim_template.h
+ * Compile-time specialized Genetic Algorithm engine. The genome type and the
+ * selection, crossover, and mutation operators are template parameters, so
+ * the generation loop is inlined and, with a fixed size genome
+ * (std::array), the genome loops are unrolled and no memory is allocated
+ * while evolving. It is meant for small genomes (a few tens of genes), where
+ * the operator dispatch and the allocations of the runtime configured GA
+ * class dominate the run time. The GA class of gaim.h remains the default
+ * front end (configuration files, Island Model, Python interface).
+ *
+ * Only a subset of the operators of the GA class is available:
+ * @li Selection: ktournament_selection, random_selection
+ * @li Crossover: one_point_crossover, uniform_crossover, flat_crossover
+ * @li Mutation: delta_mutation, random_mutation
+ *
+ * The other operators (truncation, linear rank, roulette, stochastic roulette
+ * and Whitley selection; two-point, discrete and first order crossover;
+ * non-uniform, fusion and swap mutation) are only provided by the GA class.
+ * The operator names of ga_parameter_s (selection_method, crossover_method,
+ * mutation_method) are ignored, since the template parameters select them.
+ *
+ * Example:
+ * @code
+ * typedef gaim::GA<std::array<REAL_, 4>,
+ *                  gaim::ktournament_selection,
+ *                  gaim::one_point_crossover,
+ *                  gaim::delta_mutation> fixed_ga;
+ * fixed_ga ga(&ga_pms);
+ * ga.fitness = rastrigin;
+ * ga.evolve(ga_pms.generations);
+ * @endcode
+ */
+// $Log$
+#ifndef GAIM_TEMPLATE_H
+#define GAIM_TEMPLATE_H
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include "gaim.h"
+
+
+namespace gaim {
+
+/**
+ * @brief Genome traits.
+ *
+ * Creates genomes of the requested size. The size of a std::array genome is
+ * fixed at compile-time (extent), while std::vector genomes are allocated at
+ * construction (extent is zero).
+ */
+template <class Genome>
+struct genome_traits {
+    static const std::size_t extent = 0;
+    static Genome make(std::size_t n) { return Genome(n); }
+};
+
+template <std::size_t N>
+struct genome_traits<std::array<REAL_, N>> {
+    static const std::size_t extent = N;
+    static std::array<REAL_, N> make(std::size_t) { return std::array<REAL_, N>(); }
+};
+
+
+/**
+ * @brief Random number generator of the template engine.
+ *
+ * A thin wrapper around pcg32 that provides the few distributions the
+ * operators need without the overhead of the standard distributions.
+ */
+class rng {
+    public:
+        explicit rng(uint64_t seed) : gen(seed) { }
+
+        /// Uniform random number in [0, 1)
+        REAL_ uniform() {
+            return static_cast<REAL_>(gen() >> 8) * static_cast<REAL_>(1.0 / 16777216.0);
+        }
+        /// Uniform random number in [a, b)
+        REAL_ uniform(REAL_ a, REAL_ b) { return a + (b - a) * uniform(); }
+        /// Uniform integer random number in [0, n)
+        std::size_t bounded(uint32_t n) {
+            return static_cast<std::size_t>((static_cast<uint64_t>(gen()) * n) >> 32);
+        }
+        /// Standard normal random number
+        REAL_ normal() { return normal_dist(gen); }
+
+    private:
+        pcg32 gen;
+        std::normal_distribution<REAL_> normal_dist;
+};
+
+
+/**
+ * @brief K-tournament selection (with replacement).
+ *
+ * Draws k individuals randomly and returns the index of the fittest one.
+ */
+struct ktournament_selection {
+    int k;
+
+    explicit ktournament_selection(const sel_parameter_s &pms) : k(pms.k) { }
+
+    template <class Population>
+    std::size_t operator()(const Population &pop, rng &r) const {
+        std::size_t best = r.bounded(pop.size());
+        for (int j = 1; j < k; ++j) {
+            std::size_t idx = r.bounded(pop.size());
+            best = (pop[idx].fitness > pop[best].fitness) ? idx : best;
+        }
+        return best;
+    }
+};
+
+
+/**
+ * @brief Random selection.
+ *
+ * Returns the index of an individual drawn uniformly from the population.
+ */
+struct random_selection {
+    explicit random_selection(const sel_parameter_s &) { }
+
+    template <class Population>
+    std::size_t operator()(const Population &pop, rng &r) const {
+        return r.bounded(pop.size());
+    }
+};
+
+
+/**
+ * @brief One-point crossover.
+ *
+ * The child inherits the genes of one parent up to a random point and the
+ * genes of the other parent after it.
+ */
+struct one_point_crossover {
+    explicit one_point_crossover(const cross_parameter_s &) { }
+
+    template <class Genome>
+    void operator()(const Genome &p1, const Genome &p2, Genome &child, rng &r) const {
+        std::size_t xover = r.bounded(p1.size());
+        bool order = r.bounded(2);
+        const Genome &first = order ? p2 : p1;
+        const Genome &second = order ? p1 : p2;
+        for (std::size_t i = 0; i < child.size(); ++i) {
+            child[i] = (i < xover) ? first[i] : second[i];
+        }
+    }
+};
+
+
+/**
+ * @brief Uniform crossover.
+ *
+ * Every gene of the child comes from either parent with equal probability.
+ */
+struct uniform_crossover {
+    explicit uniform_crossover(const cross_parameter_s &) { }
+
+    template <class Genome>
+    void operator()(const Genome &p1, const Genome &p2, Genome &child, rng &r) const {
+        for (std::size_t i = 0; i < child.size(); ++i) {
+            child[i] = r.bounded(2) ? p2[i] : p1[i];
+        }
+    }
+};
+
+
+/**
+ * @brief Flat crossover.
+ *
+ * Every gene of the child is a random convex combination of the genes of
+ * the parents.
+ */
+struct flat_crossover {
+    explicit flat_crossover(const cross_parameter_s &) { }
+
+    template <class Genome>
+    void operator()(const Genome &p1, const Genome &p2, Genome &child, rng &r) const {
+        for (std::size_t i = 0; i < child.size(); ++i) {
+            REAL_ R = r.uniform();
+            child[i] = R * p1[i] + (1 - R) * p2[i];
+        }
+    }
+};
+
+
+/**
+ * @brief Delta mutation.
+ *
+ * Every gene is perturbed with probability mutation_rate by a normal random
+ * number with zero mean and standard deviation variance.
+ */
+struct delta_mutation {
+    REAL_ mutation_rate;
+    REAL_ variance;
+
+    explicit delta_mutation(const mut_parameter_s &pms)
+        : mutation_rate(pms.mutation_rate), variance(pms.variance) { }
+
+    template <class Genome>
+    void operator()(Genome &genome, rng &r) const {
+        for (std::size_t i = 0; i < genome.size(); ++i) {
+            if (r.uniform() <= mutation_rate) {
+                genome[i] += variance * r.normal();
+            }
+        }
+    }
+};
+
+
+/**
+ * @brief Random mutation.
+ *
+ * A randomly chosen gene is replaced by a uniform random number in
+ * [low_bound, up_bound).
+ */
+struct random_mutation {
+    REAL_ low_bound;
+    REAL_ up_bound;
+
+    explicit random_mutation(const mut_parameter_s &pms)
+        : low_bound(pms.low_bound), up_bound(pms.up_bound) { }
+
+    template <class Genome>
+    void operator()(Genome &genome, rng &r) const {
+        genome[r.bounded(genome.size())] = r.uniform(low_bound, up_bound);
+    }
+};
+
+
+/**
+ * @brief Compile-time specialized Genetic Algorithm class.
+ *
+ * Evolves a population with the same generation step as the GA class of
+ * gaim.h (evaluation, selection of two parents per offspring, crossover,
+ * mutation, replacement of the worst individuals by the best offspring, and
+ * clipping), with the operators given as template parameters instead of
+ * being chosen at runtime.
+ *
+ * @tparam Genome Genome type, std::array<REAL_, N> (fixed size) or
+ *                std::vector<REAL_>
+ * @tparam Selection Selection operator (returns the index of a parent)
+ * @tparam Crossover Crossover operator (writes the child genome)
+ * @tparam Mutation Mutation operator (mutates a genome in place)
+ */
+template <class Genome,
+          class Selection,
+          class Crossover,
+          class Mutation>
+class GA {
+    public:
+        /// Individual of the template engine
+        struct individual {
+            Genome genome;  /**< Individual's Genome */
+            REAL_ fitness;  /**< Individual's Fitness value */
+        };
+
+        GA(ga_parameter_s *);
+
+        /// Evaluation of fitness of individuals
+        void evaluation(std::vector<individual> &);
+        /// Replaces the worst individuals by the best offspring
+        void next_generation(void);
+        /// Clips the genes within their limits
+        void clip_genome(void);
+        /// Main routine for running one single generation step
+        void run_one_generation(void);
+        /// Main routine for evolving a population over generations
+        void evolve(std::size_t);
+
+        std::vector<REAL_> &get_bsf(){ return bsf; }
+        Genome &get_best_genome(){ return bsf_genome; }
+        std::vector<REAL_> &get_average_fitness(){ return fit_avg; }
+        /// Generations the records (BSF, average fitness) correspond to
+        const std::vector<std::size_t> &get_record_generations() const {
+            return recorder.get_generations(); }
+        REAL_ (*fitness)(REAL_ *, size_t);
+
+        std::vector<individual> population; /// Individuals population vector
+        std::vector<individual> offsprings; /// Offsprings vector
+        std::vector<REAL_> bsf;     /// BSF vector (keep track)
+        std::vector<REAL_> fit_avg; /// Average fitness vector (keep track)
+        Genome bsf_genome;  /// BSF genome
+        REAL_ bsf_fitness;  /// Fitness of the BSF genome
+
+    private:
+        RecordPolicy recorder;  /// Statistics recording policy
+        std::size_t current_generation; /// Current generation
+        Selection selection;
+        Crossover crossover;
+        Mutation mutation;
+        rng gen;
+        Genome lower_limit;    /// Genes lower limits
+        Genome upper_limit;    /// Genes upper limits
+        std::size_t mu;        /// Number of individuals within a population
+        std::size_t lambda;    /// Number of offsprings
+        std::size_t replace_perc;  /// Number of individuals being replaced
+        std::size_t elitism;       /// Number of individuals protected from replacement
+        std::size_t genome_size;   /// Genome size (number of genes)
+};
+
+
+/**
+ * @brief Constructor of the template GA class.
+ *
+ * Validates the parameters, initializes the operators and creates a random
+ * population within the genome's interval [a, b].
+ *
+ * @param[in] ga_pms    A structure that contains all the parameters for the GA
+ * @return Nothing
+ */
+template <class Genome, class Selection, class Crossover, class Mutation>
+GA<Genome, Selection, Crossover, Mutation>::GA(ga_parameter_s *ga_pms)
+    : fitness(sphere),
+      bsf_fitness(std::numeric_limits<REAL_>::lowest()),
+      recorder(ga_pms->record_policy,
+               ga_pms->record_interval,
+               ga_pms->record_capacity),
+      current_generation(0),
+      selection(ga_pms->sel_pms),
+      crossover(ga_pms->cross_pms),
+      mutation(ga_pms->mut_pms),
+      gen(std::random_device()()),
+      mu(ga_pms->population_size),
+      lambda(ga_pms->num_offsprings),
+      replace_perc(ga_pms->num_replacement),
+      elitism(ga_pms->elitism),
+      genome_size(ga_pms->genome_size)
+{
+    const std::size_t extent = genome_traits<Genome>::extent;
+
+    if (extent != 0 && extent != genome_size) {
+        std::cout << "Genome size does not match the fixed genome size of the template GA!" << std::endl;
+        exit(-1);
+    }
+    if ((ga_pms->a.size() != genome_size) || (ga_pms->b.size() != genome_size)) {
+        std::cout << "Genome limits [a, b] size is not correct!" << std::endl;
+        std::cout << "Size of a and b = genome size!" << std::endl;
+        exit(-1);
+    }
+    if (mu < 2) {
+        std::cout << "Population size is smaller than 2!" << std::endl;
+        std::cout << "Impossible to have sexual reproduction!" << std::endl;
+        exit(-1);
+    }
+    if (replace_perc > lambda || replace_perc > mu) {
+        std::cout << "Generation replacement dimension is larger than \
+            offsprings population size!" << std::endl;
+        exit(-1);
+    }
+    if (elitism >= mu) {
+        std::cout << "Elitism must be smaller than the population size!" << std::endl;
+        exit(-1);
+    }
+    if (ga_pms->clipping == "file") {
+        std::cout << "Clipping from file is not supported by the template GA!" << std::endl;
+        exit(-1);
+    }
+
+    // Clipping limits (universal clipping uses the limits of the first gene)
+    lower_limit = genome_traits<Genome>::make(genome_size);
+    upper_limit = genome_traits<Genome>::make(genome_size);
+    for (std::size_t j = 0; j < genome_size; ++j) {
+        bool universal = (ga_pms->clipping != "individual");
+        lower_limit[j] = universal ? ga_pms->a[0] : ga_pms->a[j];
+        upper_limit[j] = universal ? ga_pms->b[0] : ga_pms->b[j];
+    }
+
+    population.resize(mu);
+    for (auto &ind : population) {
+        ind.genome = genome_traits<Genome>::make(genome_size);
+        ind.fitness = -10000;
+        for (std::size_t j = 0; j < genome_size; ++j) {
+            ind.genome[j] = gen.uniform(ga_pms->a[j], ga_pms->b[j]);
+        }
+    }
+    offsprings.resize(lambda);
+    for (auto &ind : offsprings) {
+        ind.genome = genome_traits<Genome>::make(genome_size);
+        ind.fitness = -10000;
+    }
+    bsf_genome = population[0].genome;
+}
+
+
+/**
+ * Evaluates the fitness of each individual.
+ *
+ * @param[in] x Vector of individuals
+ * @return Nothing (void)
+ */
+template <class Genome, class Selection, class Crossover, class Mutation>
+void GA<Genome, Selection, Crossover, Mutation>::evaluation(std::vector<individual> &x)
+{
+    for (auto &ind : x) {
+        ind.fitness = fitness(&ind.genome[0], genome_size);
+    }
+}
+
+
+/**
+ * Replaces the replace_perc worst individuals of the population by the
+ * replace_perc best offspring. Only the individuals involved are ordered,
+ * and the elitism best individuals are never replaced.
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+template <class Genome, class Selection, class Crossover, class Mutation>
+void GA<Genome, Selection, Crossover, Mutation>::next_generation(void)
+{
+    auto lower = [](const individual &a, const individual &b) {
+        return a.fitness < b.fitness;
+    };
+    auto higher = [](const individual &a, const individual &b) {
+        return a.fitness > b.fitness;
+    };
+
+    // The elitism best individuals are never replaced
+    std::size_t perc = std::min(replace_perc, mu - elitism);
+    if (perc == 0) {
+        return;
+    }
+    std::nth_element(population.begin(),
+                     population.begin() + (perc - 1),
+                     population.end(),
+                     lower);
+    std::nth_element(offsprings.begin(),
+                     offsprings.begin() + (perc - 1),
+                     offsprings.end(),
+                     higher);
+    for (std::size_t i = 0; i < perc; ++i) {
+        population[i] = offsprings[i];
+    }
+}
+
+
+/**
+ * Clips the genes of every individual within their limits.
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+template <class Genome, class Selection, class Crossover, class Mutation>
+void GA<Genome, Selection, Crossover, Mutation>::clip_genome(void)
+{
+    for (auto &ind : population) {
+        for (std::size_t j = 0; j < genome_size; ++j) {
+            REAL_ g = ind.genome[j] > upper_limit[j] ? upper_limit[j] : ind.genome[j];
+            ind.genome[j] = g < lower_limit[j] ? lower_limit[j] : g;
+        }
+    }
+}
+
+
+/**
+ *  @brief One single step of evolution.
+ *
+ *  Evaluates the population, records the best and the average fitness,
+ *  generates the offspring (selection, crossover and mutation), and replaces
+ *  the worst individuals by the best offspring.
+ *
+ *  @param[in] (void)
+ *  @return Nothing (void)
+ */
+template <class Genome, class Selection, class Crossover, class Mutation>
+void GA<Genome, Selection, Crossover, Mutation>::run_one_generation(void)
+{
+    evaluation(population);
+
+    // Bookkeeping (best and average fitness, single pass)
+    std::size_t best = 0;
+    REAL_ acc = 0;
+    for (std::size_t i = 0; i < mu; ++i) {
+        acc += population[i].fitness;
+        best = (population[i].fitness > population[best].fitness) ? i : best;
+    }
+    if (population[best].fitness > bsf_fitness) {
+        bsf_genome = population[best].genome;
+        bsf_fitness = population[best].fitness;
+    }
+    recorder.record(current_generation, bsf_fitness,
+                    {{&bsf, bsf_fitness},
+                     {&fit_avg, acc / static_cast<REAL_>(mu)}});
+    ++current_generation;
+
+    // Generate new offspring
+    for (auto &child : offsprings) {
+        const individual &parent1 = population[selection(population, gen)];
+        const individual &parent2 = population[selection(population, gen)];
+        crossover(parent1.genome, parent2.genome, child.genome, gen);
+        mutation(child.genome, gen);
+    }
+    evaluation(offsprings);
+
+    next_generation();
+    clip_genome();
+}
+
+
+/**
+ *  @brief Evolves a population over a number of generations.
+ *
+ * @param[in] generations   Total number of generations
+ * @return Nothing (void)
+ */
+template <class Genome, class Selection, class Crossover, class Mutation>
+void GA<Genome, Selection, Crossover, Mutation>::evolve(std::size_t generations)
+{
+    std::size_t n = bsf.size() + generations;
+    if (recorder.get_capacity()) {
+        n = std::min(n, recorder.get_capacity());
+    }
+    bsf.reserve(n);
+    fit_avg.reserve(n);
+    for (std::size_t i = 0; i < generations; ++i) {
+        run_one_generation();
+    }
+}
+
+}   // namespace gaim
+
+#endif  // GAIM_TEMPLATE_H
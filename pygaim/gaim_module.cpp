@@ -0,0 +1,1445 @@
+/* Native Python extension module of GAIM software
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file gaim_module.cpp
+ * Native CPython extension module (_gaim, or _gaim_double for the double
+ * build). It exposes the GA and IM classes as Python objects. The fitness is
+ * a batch callback receiving all the genomes of an evaluation as a single
+ * 2-D buffer, and the evolution runs with the GIL released (it is taken back
+ * only for the callbacks). Results and populations are returned as read-only
+ * buffers viewing the memory of the library (no copies), numpy wraps them
+ * with np.asarray.
+ */
+// $Log$
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+
+#include "gaim.h"
+
+#ifdef GAIM_DOUBLE
+using namespace gaim_double;
+#define GAIM_PY_MODULE "_gaim_double"
+#define GAIM_PY_FORMAT "d"
+#define GAIM_PY_INIT PyInit__gaim_double
+#else
+#define GAIM_PY_MODULE "_gaim"
+#define GAIM_PY_FORMAT "f"
+#define GAIM_PY_INIT PyInit__gaim
+#endif
+
+
+/**
+ * @brief State of the batch fitness callback.
+ *
+ * The first Python exception raised by the callback is kept and re-raised
+ * once the evolution returns; the remaining evaluations skip the callback.
+ */
+typedef struct batch_context {
+    PyObject *fitness = nullptr;    /**< Batch fitness callable */
+    std::atomic<bool> failed;       /**< The callback raised an exception */
+    CancelToken cancel;             /**< Stops the evolution (cancel() or a
+                                      failed callback) */
+    PyObject *type = nullptr;       /**< First exception (type, value, tb) */
+    PyObject *value = nullptr;
+    PyObject *traceback = nullptr;
+    Py_ssize_t shape[2];            /**< Shape of the genomes buffer */
+    Py_ssize_t strides[2];          /**< Strides of the genomes buffer */
+    size_t num_objectives = 1;      /**< Costs per genome (n_objectives) */
+    std::unique_ptr<ProcessEvaluator> workers;  /**< Evaluation worker
+                                                  processes (worker_command) */
+
+    batch_context() : failed(false) {}
+} batch_context_s;
+
+
+/**
+ * @brief Common head of the GA and IM objects. Evolving is refused while
+ * buffers viewing the memory of the object are exported.
+ */
+typedef struct {
+    PyObject_HEAD
+    Py_ssize_t exports;     /**< Number of exported buffers */
+} PyOwner;
+
+
+/// Python GA object
+typedef struct {
+    PyObject_HEAD
+    Py_ssize_t exports;
+    batch_context_s *ctx;
+    ga_parameter_s *ga_pms;
+    pr_parameter_s *pr_pms;
+    GA *ga;
+    ga_results_s *front;    /**< Pareto front of the population */
+} PyGA;
+
+
+/// Python IM object
+typedef struct {
+    PyObject_HEAD
+    Py_ssize_t exports;
+    batch_context_s *ctx;
+    ga_parameter_s *ga_pms;
+    pr_parameter_s *pr_pms;
+    im_parameter_s *im_pms;
+    IM *im;
+    ga_results_s *results;
+} PyIM;
+
+
+/// Read-only view of a REAL_ buffer owned by a GA or IM object
+typedef struct {
+    PyObject_HEAD
+    PyObject *owner;
+    REAL_ *data;
+    int ndim;
+    Py_ssize_t shape[2];
+    Py_ssize_t strides[2];
+} PyView;
+
+
+/// Types of the module (created by PyType_FromSpec at import)
+static PyTypeObject *PyViewType = NULL;
+
+
+/* ------------------------------------------------------------------------- */
+/* Views                                                                      */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * Buffer protocol of the views (read-only, C-contiguous, REAL_ items).
+ */
+static int view_getbuffer(PyObject *obj, Py_buffer *view, int flags)
+{
+    static REAL_ empty = 0;
+    PyView *self = reinterpret_cast<PyView *>(obj);
+
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "GAIM buffers are read-only");
+        return -1;
+    }
+    view->obj = obj;
+    Py_INCREF(obj);
+    view->buf = self->data ? self->data : &empty;
+    view->itemsize = sizeof(REAL_);
+    view->len = self->shape[0] * sizeof(REAL_);
+    if (self->ndim == 2) {
+        view->len *= self->shape[1];
+    }
+    view->readonly = 1;
+    view->ndim = self->ndim;
+    view->format = (flags & PyBUF_FORMAT) ? const_cast<char *>(GAIM_PY_FORMAT) : NULL;
+    view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+    view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    reinterpret_cast<PyOwner *>(self->owner)->exports++;
+    return 0;
+}
+
+
+static void view_releasebuffer(PyObject *obj, Py_buffer *)
+{
+    PyView *self = reinterpret_cast<PyView *>(obj);
+    reinterpret_cast<PyOwner *>(self->owner)->exports--;
+}
+
+
+static void view_dealloc(PyObject *obj)
+{
+    PyView *self = reinterpret_cast<PyView *>(obj);
+    PyTypeObject *type = Py_TYPE(obj);
+    Py_XDECREF(self->owner);
+    type->tp_free(obj);
+    Py_DECREF(type);
+}
+
+
+/**
+ * Returns a memoryview of rows x cols REAL_ (cols = 0 for a 1-D view) owned
+ * by owner. The owner stays alive as long as the memoryview does.
+ *
+ * @param[in] owner GA or IM object
+ * @param[in] data Pointer to the memory
+ * @param[in] rows Number of rows (items of a 1-D view)
+ * @param[in] cols Number of columns (0 for a 1-D view)
+ * @return A new reference to a memoryview (NULL on error)
+ */
+static PyObject *make_view(PyObject *owner, REAL_ *data, size_t rows, size_t cols)
+{
+    PyView *view = PyObject_New(PyView, PyViewType);
+    if (!view) {
+        return NULL;
+    }
+    Py_INCREF(owner);
+    view->owner = owner;
+    view->data = data;
+    view->ndim = cols ? 2 : 1;
+    view->shape[0] = rows;
+    view->shape[1] = cols;
+    view->strides[0] = cols ? cols * sizeof(REAL_) : sizeof(REAL_);
+    view->strides[1] = sizeof(REAL_);
+
+    PyObject *mv = PyMemoryView_FromObject(reinterpret_cast<PyObject *>(view));
+    Py_DECREF(view);
+    return mv;
+}
+
+
+/* ------------------------------------------------------------------------- */
+/* Batch fitness callback                                                     */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * Copies the n costs returned by the Python callback (n genomes times the
+ * objectives). Buffers of REAL_ are copied at once, any other sequence item
+ * by item.
+ */
+static bool read_costs(PyObject *res, REAL_ *costs, size_t n)
+{
+    Py_buffer buf;
+
+    if (PyObject_CheckBuffer(res) &&
+        PyObject_GetBuffer(res, &buf, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == 0) {
+        const char *fmt = buf.format ? buf.format : "B";
+        if (*fmt == '@' || *fmt == '=' || *fmt == '<') {
+            ++fmt;
+        }
+        bool match = (std::strcmp(fmt, GAIM_PY_FORMAT) == 0 &&
+                      buf.len == static_cast<Py_ssize_t>(n * sizeof(REAL_)));
+        if (match) {
+            std::memcpy(costs, buf.buf, n * sizeof(REAL_));
+        }
+        PyBuffer_Release(&buf);
+        if (match) {
+            return true;
+        }
+    } else {
+        PyErr_Clear();
+    }
+
+    PyObject *seq = PySequence_Fast(res, "fitness must return a sequence of costs");
+    if (!seq) {
+        return false;
+    }
+    if (static_cast<size_t>(PySequence_Fast_GET_SIZE(seq)) != n) {
+        PyErr_Format(PyExc_ValueError,
+                     "fitness returned %zd costs instead of %zu",
+                     PySequence_Fast_GET_SIZE(seq), n);
+        Py_DECREF(seq);
+        return false;
+    }
+    PyObject **items = PySequence_Fast_ITEMS(seq);
+    for (size_t i = 0; i < n; ++i) {
+        costs[i] = static_cast<REAL_>(PyFloat_AsDouble(items[i]));
+    }
+    Py_DECREF(seq);
+    return !PyErr_Occurred();
+}
+
+
+/**
+ * Batch fitness function of the GAs (see GA::batch_fitness). It is called
+ * without the GIL, takes it, passes the genomes to the Python callable as a
+ * read-only n x genome_size memoryview (valid only during the call), and
+ * releases the GIL again. With several objectives the callable returns
+ * n x n_objectives costs (row-wise).
+ */
+static void py_batch_fitness(REAL_ *genomes,
+                             size_t n,
+                             size_t genome_size,
+                             REAL_ *costs,
+                             void *data)
+{
+    batch_context_s *ctx = static_cast<batch_context_s *>(data);
+    size_t num_costs = n * ctx->num_objectives;
+    bool ok = false;
+
+    if (!ctx->failed.load()) {
+        PyGILState_STATE gil = PyGILState_Ensure();
+        Py_buffer view;
+        ctx->shape[0] = n;
+        ctx->shape[1] = genome_size;
+        ctx->strides[0] = genome_size * sizeof(REAL_);
+        ctx->strides[1] = sizeof(REAL_);
+        view.obj = NULL;
+        view.buf = genomes;
+        view.len = n * genome_size * sizeof(REAL_);
+        view.itemsize = sizeof(REAL_);
+        view.readonly = 1;
+        view.ndim = 2;
+        view.format = const_cast<char *>(GAIM_PY_FORMAT);
+        view.shape = ctx->shape;
+        view.strides = ctx->strides;
+        view.suboffsets = NULL;
+        view.internal = NULL;
+
+        PyObject *mv = PyMemoryView_FromBuffer(&view);
+        if (mv) {
+            PyObject *res = PyObject_CallFunctionObjArgs(ctx->fitness, mv, NULL);
+            if (res) {
+                ok = read_costs(res, costs, num_costs);
+                Py_DECREF(res);
+            }
+            // The genomes buffer is reused, so the view must not outlive the
+            // call (release fails if the callback kept a reference)
+            PyObject *type, *value, *traceback;
+            PyErr_Fetch(&type, &value, &traceback);
+            PyObject *r = PyObject_CallMethod(mv, "release", NULL);
+            Py_XDECREF(r);
+            PyErr_Clear();
+            PyErr_Restore(type, value, traceback);
+            Py_DECREF(mv);
+        }
+        if (ok && PyErr_CheckSignals() < 0) {
+            ok = false;
+        }
+        if (!ok) {
+            // No point in running the remaining generations
+            ctx->cancel.cancel();
+            if (!ctx->failed.exchange(true)) {
+                PyErr_Fetch(&ctx->type, &ctx->value, &ctx->traceback);
+            } else {
+                PyErr_Clear();
+            }
+        }
+        PyGILState_Release(gil);
+    }
+    if (!ok) {
+        std::fill(costs, costs + num_costs, -std::numeric_limits<REAL_>::max());
+    }
+}
+
+
+/**
+ * Re-raises the exception of the callback (if any) after an evolution.
+ *
+ * @return True if the callback failed (the exception is set)
+ */
+static bool raise_callback_error(batch_context_s *ctx)
+{
+    if (!ctx->failed.load()) {
+        return false;
+    }
+    PyErr_Restore(ctx->type, ctx->value, ctx->traceback);
+    ctx->type = ctx->value = ctx->traceback = nullptr;
+    ctx->failed = false;
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------- */
+/* Parameters                                                                 */
+/* ------------------------------------------------------------------------- */
+
+/*
+ * Each reader removes its keyword from kw (a private copy of the keyword
+ * arguments), so the leftovers are the unknown keywords. They return false
+ * with an exception set on a wrong value.
+ */
+static bool take_size(PyObject *kw, const char *name, size_t *out)
+{
+    PyObject *v = PyDict_GetItemString(kw, name);
+    if (!v) {
+        return true;
+    }
+    Py_ssize_t x = PyLong_AsSsize_t(v);
+    if (x < 0) {
+        if (!PyErr_Occurred()) {
+            PyErr_Format(PyExc_ValueError, "%s must be non-negative", name);
+        }
+        return false;
+    }
+    *out = static_cast<size_t>(x);
+    return PyDict_DelItemString(kw, name) == 0;
+}
+
+
+static bool take_int(PyObject *kw, const char *name, int *out)
+{
+    PyObject *v = PyDict_GetItemString(kw, name);
+    if (!v) {
+        return true;
+    }
+    long x = PyLong_AsLong(v);
+    if (x == -1 && PyErr_Occurred()) {
+        return false;
+    }
+    *out = static_cast<int>(x);
+    return PyDict_DelItemString(kw, name) == 0;
+}
+
+
+static bool take_real(PyObject *kw, const char *name, REAL_ *out)
+{
+    PyObject *v = PyDict_GetItemString(kw, name);
+    if (!v) {
+        return true;
+    }
+    double x = PyFloat_AsDouble(v);
+    if (x == -1.0 && PyErr_Occurred()) {
+        return false;
+    }
+    *out = static_cast<REAL_>(x);
+    return PyDict_DelItemString(kw, name) == 0;
+}
+
+
+static bool take_bool(PyObject *kw, const char *name, bool *out)
+{
+    PyObject *v = PyDict_GetItemString(kw, name);
+    if (!v) {
+        return true;
+    }
+    int x = PyObject_IsTrue(v);
+    if (x < 0) {
+        return false;
+    }
+    *out = x;
+    return PyDict_DelItemString(kw, name) == 0;
+}
+
+
+static bool take_string(PyObject *kw, const char *name, std::string *out)
+{
+    PyObject *v = PyDict_GetItemString(kw, name);
+    if (!v) {
+        return true;
+    }
+    const char *s = PyUnicode_AsUTF8(v);
+    if (!s) {
+        return false;
+    }
+    *out = s;
+    return PyDict_DelItemString(kw, name) == 0;
+}
+
+
+static bool take_reals(PyObject *kw, const char *name, std::vector<REAL_> *out)
+{
+    PyObject *v = PyDict_GetItemString(kw, name);
+    if (!v) {
+        return true;
+    }
+    PyObject *seq = PySequence_Fast(v, "genome limits must be sequences");
+    if (!seq) {
+        return false;
+    }
+    out->clear();
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); ++i) {
+        out->push_back(static_cast<REAL_>(
+                    PyFloat_AsDouble(PySequence_Fast_GET_ITEM(seq, i))));
+    }
+    Py_DECREF(seq);
+    if (PyErr_Occurred()) {
+        return false;
+    }
+    return PyDict_DelItemString(kw, name) == 0;
+}
+
+
+/**
+ * Raises ValueError if an operator name is not one of the choices (the C++
+ * constructors would terminate the interpreter instead).
+ */
+static bool check_choice(const char *name,
+                         const std::string &value,
+                         std::initializer_list<const char *> choices)
+{
+    std::string names;
+    for (const char *c : choices) {
+        if (value == c) {
+            return true;
+        }
+        names += names.empty() ? c : std::string(", ") + c;
+    }
+    PyErr_Format(PyExc_ValueError, "%s must be one of %s (got '%s')",
+                 name, names.c_str(), value.c_str());
+    return false;
+}
+
+
+/**
+ * Fills the GA and logging parameters from the keyword arguments. The names
+ * and the defaults are the ones of the ctypes wrapper (pygaim.GAOptimize).
+ */
+static bool read_ga_parameters(PyObject *kw,
+                               ga_parameter_s *ga_pms,
+                               pr_parameter_s *pr_pms)
+{
+    ga_pms->generations = 1000;
+    ga_pms->population_size = 50;
+    ga_pms->genome_size = 3;
+    ga_pms->num_offsprings = 10;
+    ga_pms->num_replacement = 5;
+    ga_pms->runs = 1;
+    ga_pms->clipping = "universal";
+    ga_pms->clipping_fname = "clip_values_file.dat";
+    ga_pms->sel_pms.selection_method = "ktournament";
+    ga_pms->sel_pms.bias = 1.5;
+    ga_pms->sel_pms.num_parents = 2;
+    ga_pms->sel_pms.lower_bound = 1;
+    ga_pms->sel_pms.k = 2;
+    ga_pms->sel_pms.replace = false;
+    ga_pms->cross_pms.crossover_method = "one_point";
+    ga_pms->mut_pms.mutation_method = "delta";
+    ga_pms->mut_pms.mutation_rate = 0.5;
+    ga_pms->mut_pms.variance = 0.5;
+    ga_pms->mut_pms.low_bound = 0.0;
+    ga_pms->mut_pms.up_bound = 1.0;
+    ga_pms->mut_pms.order = 1;
+    ga_pms->mut_pms.is_real = true;
+
+    pr_pms->where2write = "./data/";
+    pr_pms->experiment_name = "experiment-1";
+    pr_pms->print_fitness = false;
+    pr_pms->print_average_fitness = false;
+    pr_pms->print_bsf = false;
+    pr_pms->print_best_genome = false;
+
+    if (!take_size(kw, "n_generations", &ga_pms->generations) ||
+        !take_size(kw, "population_size", &ga_pms->population_size) ||
+        !take_size(kw, "genome_size", &ga_pms->genome_size) ||
+        !take_size(kw, "n_offsprings", &ga_pms->num_offsprings) ||
+        !take_size(kw, "n_replacements", &ga_pms->num_replacement) ||
+        !take_size(kw, "n_objectives", &ga_pms->num_objectives) ||
+        !take_string(kw, "clipping", &ga_pms->clipping) ||
+        !take_string(kw, "clipping_fname", &ga_pms->clipping_fname) ||
+        !take_string(kw, "selection_method", &ga_pms->sel_pms.selection_method) ||
+        !take_real(kw, "bias", &ga_pms->sel_pms.bias) ||
+        !take_size(kw, "num_parents", &ga_pms->sel_pms.num_parents) ||
+        !take_size(kw, "lower_bound", &ga_pms->sel_pms.lower_bound) ||
+        !take_int(kw, "k", &ga_pms->sel_pms.k) ||
+        !take_bool(kw, "replace", &ga_pms->sel_pms.replace) ||
+        !take_string(kw, "crossover_method", &ga_pms->cross_pms.crossover_method) ||
+        !take_string(kw, "mutation_method", &ga_pms->mut_pms.mutation_method) ||
+        !take_real(kw, "mutation_rate", &ga_pms->mut_pms.mutation_rate) ||
+        !take_real(kw, "mutation_var", &ga_pms->mut_pms.variance) ||
+        !take_real(kw, "low_bound", &ga_pms->mut_pms.low_bound) ||
+        !take_real(kw, "up_bound", &ga_pms->mut_pms.up_bound) ||
+        !take_size(kw, "order", &ga_pms->mut_pms.order) ||
+        !take_bool(kw, "is_real", &ga_pms->mut_pms.is_real) ||
+        !take_size(kw, "elitism", &ga_pms->elitism) ||
+        !take_string(kw, "record_policy", &ga_pms->record_policy) ||
+        !take_size(kw, "record_interval", &ga_pms->record_interval) ||
+        !take_size(kw, "record_capacity", &ga_pms->record_capacity) ||
+        !take_string(kw, "init_method", &ga_pms->init_method) ||
+        !take_string(kw, "seed_fname", &ga_pms->seed_fname) ||
+        !take_string(kw, "surrogate", &ga_pms->surrogate) ||
+        !take_real(kw, "surrogate_fraction", &ga_pms->surrogate_fraction) ||
+        !take_size(kw, "surrogate_k", &ga_pms->surrogate_k) ||
+        !take_size(kw, "surrogate_archive", &ga_pms->surrogate_archive) ||
+        !take_size(kw, "eval_timeout_ms", &ga_pms->eval_timeout_ms) ||
+        !take_real(kw, "timeout_penalty", &ga_pms->timeout_penalty) ||
+        !take_string(kw, "experiment_id", &pr_pms->experiment_name) ||
+        !take_string(kw, "metrics_target", &pr_pms->metrics_target) ||
+        !take_size(kw, "metrics_period_ms", &pr_pms->metrics_period_ms)) {
+        return false;
+    }
+    ga_pms->a.assign(ga_pms->genome_size, -1);
+    ga_pms->b.assign(ga_pms->genome_size, 1);
+    if (!take_reals(kw, "a", &ga_pms->a) || !take_reals(kw, "b", &ga_pms->b) ||
+        !take_reals(kw, "seed_genomes", &ga_pms->seed_genomes)) {
+        return false;
+    }
+    if (!check_choice("selection_method", ga_pms->sel_pms.selection_method,
+                      {"ktournament", "truncation", "linear_rank", "random",
+                       "roulette", "stochastic_roulette", "whitley"}) ||
+        !check_choice("crossover_method", ga_pms->cross_pms.crossover_method,
+                      {"one_point", "two_point", "uniform", "flat",
+                       "discrete", "first_order"}) ||
+        !check_choice("mutation_method", ga_pms->mut_pms.mutation_method,
+                      {"delta", "random", "nonuniform", "fusion",
+                       "swap_mutation"}) ||
+        !check_choice("clipping", ga_pms->clipping,
+                      {"universal", "individual", "file"}) ||
+        !check_choice("init_method", ga_pms->init_method,
+                      {"uniform", "lhs", "sobol"}) ||
+        !check_choice("surrogate", ga_pms->surrogate, {"none", "knn"}) ||
+        !check_choice("record_policy", ga_pms->record_policy,
+                      {"all", "interval", "log", "improvement"})) {
+        return false;
+    }
+    if (ga_pms->a.size() != ga_pms->genome_size ||
+        ga_pms->b.size() != ga_pms->genome_size) {
+        PyErr_SetString(PyExc_ValueError, "a and b must have genome_size items");
+        return false;
+    }
+    if (ga_pms->population_size < 2 || ga_pms->num_offsprings < 2 ||
+        ga_pms->genome_size < 1 || ga_pms->num_objectives < 1) {
+        PyErr_SetString(PyExc_ValueError,
+                        "population_size and n_offsprings must be at least 2 "
+                        "and genome_size and n_objectives at least 1");
+        return false;
+    }
+    if (ga_pms->num_objectives > 1 && ga_pms->surrogate != "none") {
+        PyErr_SetString(PyExc_ValueError,
+                        "the surrogate supports a single objective");
+        return false;
+    }
+    if (ga_pms->seed_genomes.size() % ga_pms->genome_size) {
+        PyErr_SetString(PyExc_ValueError,
+                        "seed_genomes must have a multiple of genome_size items");
+        return false;
+    }
+    return true;
+}
+
+
+static bool take_strings(PyObject *kw, const char *name,
+                         std::vector<std::string> *out)
+{
+    PyObject *v = PyDict_GetItemString(kw, name);
+    if (!v) {
+        return true;
+    }
+    PyObject *seq = PySequence_Fast(v, "file names must be sequences");
+    if (!seq) {
+        return false;
+    }
+    out->clear();
+    for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(seq); ++i) {
+        const char *s = PyUnicode_AsUTF8(PySequence_Fast_GET_ITEM(seq, i));
+        if (!s) {
+            Py_DECREF(seq);
+            return false;
+        }
+        out->push_back(s);
+    }
+    Py_DECREF(seq);
+    return PyDict_DelItemString(kw, name) == 0;
+}
+
+
+/**
+ * Reads the number of vertices (islands) of a connectivity graph file,
+ * raising ValueError if the file cannot be read (IM::IM would terminate the
+ * interpreter instead).
+ */
+static bool graph_vertices(const char *name, const std::string &fname,
+                           size_t *num_vertices)
+{
+    std::ifstream ifile(fname);
+    if (!ifile || !(ifile >> *num_vertices) || *num_vertices < 1) {
+        PyErr_Format(PyExc_ValueError, "%s: cannot read the graph file '%s'",
+                     name, fname.c_str());
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Fills the Island Model parameters from the keyword arguments and checks
+ * them against the GA parameters and the graph files, raising ValueError
+ * where IM::IM would terminate the interpreter. The graph file
+ * (im_graph_fname) is required, and n_islands defaults to its number of
+ * vertices.
+ */
+static bool read_im_parameters(PyObject *kw,
+                               im_parameter_s *im_pms,
+                               const ga_parameter_s *ga_pms)
+{
+    bool has_islands = PyDict_GetItemString(kw, "n_islands") != NULL;
+    bool has_interval = PyDict_GetItemString(kw, "migration_interval") != NULL;
+    size_t num_vertices;
+
+    im_pms->num_islands = 5;
+    im_pms->num_immigrants = 4;
+    im_pms->migration_interval = 500;
+    im_pms->pick_method = "elite";
+    im_pms->replace_method = "poor";
+    im_pms->adj_list_fname = "";
+    im_pms->is_im_enabled = true;
+
+    if (!take_size(kw, "n_islands", &im_pms->num_islands) ||
+        !take_size(kw, "n_immigrants", &im_pms->num_immigrants) ||
+        !take_size(kw, "migration_interval", &im_pms->migration_interval) ||
+        !take_string(kw, "pickup_method", &im_pms->pick_method) ||
+        !take_string(kw, "replace_method", &im_pms->replace_method) ||
+        !take_string(kw, "im_graph_fname", &im_pms->adj_list_fname) ||
+        !take_string(kw, "topology_method", &im_pms->topology_method) ||
+        !take_size(kw, "rewiring_interval", &im_pms->rewiring_interval) ||
+        !take_size(kw, "rewiring_degree", &im_pms->rewiring_degree) ||
+        !take_strings(kw, "epoch_graph_fnames", &im_pms->epoch_graph_fnames) ||
+        !check_choice("pickup_method", im_pms->pick_method,
+                      {"random", "elite", "poor"}) ||
+        !check_choice("replace_method", im_pms->replace_method,
+                      {"random", "elite", "poor"}) ||
+        !check_choice("topology_method", im_pms->topology_method,
+                      {"static", "random", "fitness", "epoch"})) {
+        return false;
+    }
+
+    if (!has_interval) {
+        im_pms->migration_interval = std::min(im_pms->migration_interval,
+                                              ga_pms->generations);
+    }
+    if (im_pms->migration_interval < 1 ||
+        im_pms->migration_interval > ga_pms->generations) {
+        PyErr_SetString(PyExc_ValueError,
+                        "migration_interval must be in [1, n_generations]");
+        return false;
+    }
+    if (im_pms->adj_list_fname.empty()) {
+        PyErr_SetString(PyExc_ValueError, "im_graph_fname is required");
+        return false;
+    }
+    if (!graph_vertices("im_graph_fname", im_pms->adj_list_fname, &num_vertices)) {
+        return false;
+    }
+    if (!has_islands) {
+        im_pms->num_islands = num_vertices;
+    } else if (im_pms->num_islands != num_vertices) {
+        PyErr_Format(PyExc_ValueError,
+                     "n_islands is %zu but the graph file has %zu islands",
+                     im_pms->num_islands, num_vertices);
+        return false;
+    }
+    if (im_pms->rewiring_interval < 1) {
+        PyErr_SetString(PyExc_ValueError, "rewiring_interval must be at least 1");
+        return false;
+    }
+    if ((im_pms->topology_method == "random" || im_pms->topology_method == "fitness") &&
+        (im_pms->rewiring_degree < 1 || im_pms->rewiring_degree >= num_vertices)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "rewiring_degree must be in [1, n_islands)");
+        return false;
+    }
+    if (im_pms->topology_method == "epoch") {
+        if (im_pms->epoch_graph_fnames.empty()) {
+            PyErr_SetString(PyExc_ValueError,
+                            "the epoch topology requires epoch_graph_fnames");
+            return false;
+        }
+        for (auto &fname : im_pms->epoch_graph_fnames) {
+            size_t n;
+            if (!graph_vertices("epoch_graph_fnames", fname, &n)) {
+                return false;
+            }
+            if (n != num_vertices) {
+                PyErr_Format(PyExc_ValueError,
+                             "epoch graph '%s' has %zu islands, expected %zu",
+                             fname.c_str(), n, num_vertices);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Copies the keyword arguments, so they can be consumed by the readers.
+ */
+static PyObject *copy_kwargs(PyObject *kwargs)
+{
+    return kwargs ? PyDict_Copy(kwargs) : PyDict_New();
+}
+
+
+/**
+ * Raises TypeError for the keywords left over by the readers.
+ */
+static bool check_leftovers(PyObject *kw)
+{
+    if (PyDict_Size(kw) == 0) {
+        return true;
+    }
+    PyObject *keys = PyDict_Keys(kw);
+    PyObject *repr = keys ? PyObject_Repr(keys) : NULL;
+    if (repr) {
+        PyErr_Format(PyExc_TypeError, "unknown parameters: %U", repr);
+    }
+    Py_XDECREF(repr);
+    Py_XDECREF(keys);
+    return false;
+}
+
+
+/**
+ * Parses the fitness callable (single positional argument, None if the
+ * fitness is evaluated by worker processes).
+ */
+static bool parse_fitness(PyObject *args, batch_context_s *ctx)
+{
+    PyObject *fitness;
+    if (!PyArg_ParseTuple(args, "O", &fitness)) {
+        return false;
+    }
+    if (fitness != Py_None && !PyCallable_Check(fitness)) {
+        PyErr_SetString(PyExc_TypeError, "fitness must be callable");
+        return false;
+    }
+    Py_INCREF(fitness);
+    ctx->fitness = fitness;
+    return true;
+}
+
+
+/**
+ * Starts the evaluation worker processes running worker_command (see
+ * ProcessEvaluator and pygaim.worker.serve), n_workers of them (0 for one
+ * per hardware thread). Without a command the fitness must be callable.
+ * The workers return a single cost per genome.
+ */
+static bool read_worker_parameters(PyObject *kw, batch_context_s *ctx,
+                                   const ga_parameter_s *ga_pms)
+{
+    std::string command;
+    size_t num_workers = 0;
+
+    if (!take_string(kw, "worker_command", &command) ||
+        !take_size(kw, "n_workers", &num_workers)) {
+        return false;
+    }
+    if (command.empty()) {
+        if (ctx->fitness == Py_None) {
+            PyErr_SetString(PyExc_TypeError,
+                            "fitness must be callable (or None with "
+                            "worker_command)");
+            return false;
+        }
+        return true;
+    }
+    if (ctx->fitness != Py_None) {
+        PyErr_SetString(PyExc_ValueError,
+                        "fitness must be None with worker_command");
+        return false;
+    }
+    if (ga_pms->num_objectives > 1) {
+        PyErr_SetString(PyExc_ValueError,
+                        "worker_command supports a single objective");
+        return false;
+    }
+    ctx->workers.reset(new ProcessEvaluator(num_workers, ga_pms->genome_size,
+                                            command));
+    return true;
+}
+
+
+/**
+ * Plugs the fitness in a GA: the worker processes if any, the Python
+ * callback otherwise.
+ */
+static void set_fitness(GA &ga, batch_context_s *ctx)
+{
+    ctx->num_objectives = ga.get_num_objectives();
+    if (ctx->workers) {
+        ga.batch_fitness = process_batch_fitness;
+        ga.batch_data = ctx->workers.get();
+    } else {
+        ga.batch_fitness = py_batch_fitness;
+        ga.batch_data = ctx;
+    }
+}
+
+
+static bool check_exports(PyObject *owner)
+{
+    if (reinterpret_cast<PyOwner *>(owner)->exports) {
+        PyErr_SetString(PyExc_BufferError,
+                        "release the arrays viewing the results (or copy "
+                        "them) before evolving again");
+        return false;
+    }
+    return true;
+}
+
+
+/* ------------------------------------------------------------------------- */
+/* GA object                                                                  */
+/* ------------------------------------------------------------------------- */
+
+static int ga_init(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    PyGA *self = reinterpret_cast<PyGA *>(obj);
+
+    if (self->ctx) {
+        PyErr_SetString(PyExc_RuntimeError, "GA is already initialized");
+        return -1;
+    }
+    self->ctx = new batch_context_s();
+    self->ga_pms = new ga_parameter_s();
+    self->pr_pms = new pr_parameter_s();
+    self->front = new ga_results_s();
+
+    if (!parse_fitness(args, self->ctx)) {
+        return -1;
+    }
+    PyObject *kw = copy_kwargs(kwargs);
+    if (!kw) {
+        return -1;
+    }
+    bool ok = read_ga_parameters(kw, self->ga_pms, self->pr_pms) &&
+        read_worker_parameters(kw, self->ctx, self->ga_pms) &&
+        check_leftovers(kw);
+    Py_DECREF(kw);
+    if (!ok) {
+        return -1;
+    }
+
+    self->ga = new GA(self->ga_pms);
+    set_fitness(*self->ga, self->ctx);
+    self->ga->cancel_token = &self->ctx->cancel;
+    return 0;
+}
+
+
+static void ga_dealloc(PyObject *obj)
+{
+    PyGA *self = reinterpret_cast<PyGA *>(obj);
+    if (self->ctx) {
+        Py_XDECREF(self->ctx->fitness);
+        delete self->ctx;
+    }
+    delete self->ga;
+    delete self->ga_pms;
+    delete self->pr_pms;
+    delete self->front;
+    PyTypeObject *type = Py_TYPE(obj);
+    type->tp_free(obj);
+    Py_DECREF(type);
+}
+
+
+static bool ga_ready(PyGA *self)
+{
+    if (!self->ga) {
+        PyErr_SetString(PyExc_RuntimeError, "GA is not initialized");
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * GA.evolve(generations=None). Evolves the population without the GIL.
+ */
+static PyObject *ga_evolve(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    static const char *keywords[] = {"generations", NULL};
+    PyGA *self = reinterpret_cast<PyGA *>(obj);
+    Py_ssize_t generations = -1;
+    bool bad_alloc = false;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|n",
+                                     const_cast<char **>(keywords),
+                                     &generations)) {
+        return NULL;
+    }
+    if (!ga_ready(self) || !check_exports(obj)) {
+        return NULL;
+    }
+    size_t n = (generations < 0) ? self->ga_pms->generations : generations;
+
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        self->ga->evolve(n, 0, self->pr_pms);
+        self->ctx->cancel.reset();
+    } catch (std::bad_alloc &) {
+        bad_alloc = true;
+    }
+    Py_END_ALLOW_THREADS
+
+    if (raise_callback_error(self->ctx)) {
+        return NULL;
+    }
+    if (bad_alloc) {
+        return PyErr_NoMemory();
+    }
+    Py_RETURN_NONE;
+}
+
+
+/**
+ * GA.cancel(). Stops a running evolve (called from another thread) after the
+ * current generation.
+ */
+static PyObject *ga_cancel(PyObject *obj, PyObject *)
+{
+    PyGA *self = reinterpret_cast<PyGA *>(obj);
+    if (!ga_ready(self)) {
+        return NULL;
+    }
+    self->ctx->cancel.cancel();
+    Py_RETURN_NONE;
+}
+
+
+static PyObject *ga_get_bsf(PyObject *obj, void *)
+{
+    PyGA *self = reinterpret_cast<PyGA *>(obj);
+    if (!ga_ready(self)) {
+        return NULL;
+    }
+    std::vector<REAL_> &x = self->ga->get_bsf();
+    return make_view(obj, x.data(), x.size(), 0);
+}
+
+
+static PyObject *ga_get_average_fitness(PyObject *obj, void *)
+{
+    PyGA *self = reinterpret_cast<PyGA *>(obj);
+    if (!ga_ready(self)) {
+        return NULL;
+    }
+    std::vector<REAL_> &x = self->ga->get_average_fitness();
+    return make_view(obj, x.data(), x.size(), 0);
+}
+
+
+static PyObject *ga_get_best_genome(PyObject *obj, void *)
+{
+    PyGA *self = reinterpret_cast<PyGA *>(obj);
+    if (!ga_ready(self)) {
+        return NULL;
+    }
+    std::vector<REAL_> &x = self->ga->get_best_genome();
+    return make_view(obj, x.data(), x.size(), 0);
+}
+
+
+static PyObject *ga_get_population(PyObject *obj, void *)
+{
+    PyGA *self = reinterpret_cast<PyGA *>(obj);
+    if (!ga_ready(self)) {
+        return NULL;
+    }
+    // Packing the same population again never moves an exported buffer
+    self->ga->pack_genomes(self->ga->population);
+    return make_view(obj, self->ga->genome_matrix.data(),
+                     self->ga->population.size(), self->ga_pms->genome_size);
+}
+
+
+/**
+ * Packs the Pareto front of the population (empty with a single objective).
+ * Packing the same front again never moves an exported buffer.
+ */
+static bool ga_pack_front(PyGA *self)
+{
+    if (!ga_ready(self)) {
+        return false;
+    }
+    if (self->ga->get_num_objectives() > 1) {
+        pack_pareto_front(self->ga->get_pareto_front(), *self->front);
+    }
+    return true;
+}
+
+
+static PyObject *ga_get_pareto_genomes(PyObject *obj, void *)
+{
+    PyGA *self = reinterpret_cast<PyGA *>(obj);
+    if (!ga_pack_front(self)) {
+        return NULL;
+    }
+    std::vector<REAL_> &x = self->front->pareto_genomes;
+    size_t cols = self->ga_pms->genome_size;
+    return make_view(obj, x.data(), x.size() / cols, cols);
+}
+
+
+static PyObject *ga_get_pareto_objectives(PyObject *obj, void *)
+{
+    PyGA *self = reinterpret_cast<PyGA *>(obj);
+    if (!ga_pack_front(self)) {
+        return NULL;
+    }
+    std::vector<REAL_> &x = self->front->pareto_objectives;
+    size_t cols = self->ga_pms->num_objectives;
+    return make_view(obj, x.data(), x.size() / cols, cols);
+}
+
+
+static PyMethodDef ga_methods[] = {
+    {"evolve", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(ga_evolve)),
+     METH_VARARGS | METH_KEYWORDS,
+     "evolve(generations=None)\n\nEvolves the population (n_generations by "
+     "default) with the GIL released."},
+    {"cancel", ga_cancel, METH_NOARGS,
+     "cancel()\n\nStops a running evolve (from another thread) after the "
+     "current generation."},
+    {NULL, NULL, 0, NULL}
+};
+
+
+static PyGetSetDef ga_getset[] = {
+    {const_cast<char *>("bsf"), ga_get_bsf, NULL,
+     const_cast<char *>("Best-so-far fitness record (read-only view)"), NULL},
+    {const_cast<char *>("average_fitness"), ga_get_average_fitness, NULL,
+     const_cast<char *>("Average fitness record (read-only view)"), NULL},
+    {const_cast<char *>("best_genome"), ga_get_best_genome, NULL,
+     const_cast<char *>("Best-so-far genome (read-only view)"), NULL},
+    {const_cast<char *>("population"), ga_get_population, NULL,
+     const_cast<char *>("Genomes of the population, population_size x "
+                        "genome_size (read-only view)"), NULL},
+    {const_cast<char *>("pareto_genomes"), ga_get_pareto_genomes, NULL,
+     const_cast<char *>("Genomes of the Pareto front of the population, "
+                        "n x genome_size (read-only view)"), NULL},
+    {const_cast<char *>("pareto_objectives"), ga_get_pareto_objectives, NULL,
+     const_cast<char *>("Objectives of the Pareto front of the population, "
+                        "n x n_objectives (read-only view)"), NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+
+/* ------------------------------------------------------------------------- */
+/* IM object                                                                  */
+/* ------------------------------------------------------------------------- */
+
+static int im_init(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    PyIM *self = reinterpret_cast<PyIM *>(obj);
+
+    if (self->ctx) {
+        PyErr_SetString(PyExc_RuntimeError, "IM is already initialized");
+        return -1;
+    }
+    self->ctx = new batch_context_s();
+    self->ga_pms = new ga_parameter_s();
+    self->pr_pms = new pr_parameter_s();
+    self->im_pms = new im_parameter_s();
+    self->results = new ga_results_s();
+
+    if (!parse_fitness(args, self->ctx)) {
+        return -1;
+    }
+    PyObject *kw = copy_kwargs(kwargs);
+    if (!kw) {
+        return -1;
+    }
+    bool ok = read_ga_parameters(kw, self->ga_pms, self->pr_pms) &&
+        read_im_parameters(kw, self->im_pms, self->ga_pms) &&
+        read_worker_parameters(kw, self->ctx, self->ga_pms) &&
+        check_leftovers(kw);
+    Py_DECREF(kw);
+    if (!ok) {
+        return -1;
+    }
+
+    self->im = new IM(self->im_pms, self->ga_pms);
+    self->im->cancel_token = &self->ctx->cancel;
+    for (auto &island : self->im->island) {
+        set_fitness(island, self->ctx);
+    }
+    return 0;
+}
+
+
+static void im_dealloc(PyObject *obj)
+{
+    PyIM *self = reinterpret_cast<PyIM *>(obj);
+    if (self->ctx) {
+        Py_XDECREF(self->ctx->fitness);
+        delete self->ctx;
+    }
+    delete self->im;
+    delete self->ga_pms;
+    delete self->pr_pms;
+    delete self->im_pms;
+    delete self->results;
+    PyTypeObject *type = Py_TYPE(obj);
+    type->tp_free(obj);
+    Py_DECREF(type);
+}
+
+
+static bool im_ready(PyIM *self)
+{
+    if (!self->im) {
+        PyErr_SetString(PyExc_RuntimeError, "IM is not initialized");
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * IM.evolve(return_type="minimum"). Evolves the islands (one thread each)
+ * without the GIL and keeps the results of the chosen island.
+ */
+static PyObject *im_evolve(PyObject *obj, PyObject *args, PyObject *kwargs)
+{
+    static const char *keywords[] = {"return_type", NULL};
+    PyIM *self = reinterpret_cast<PyIM *>(obj);
+    const char *return_type = "minimum";
+    bool bad_alloc = false;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|s",
+                                     const_cast<char **>(keywords),
+                                     &return_type)) {
+        return NULL;
+    }
+    if (!im_ready(self) || !check_exports(obj)) {
+        return NULL;
+    }
+    std::string rtype(return_type);
+
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        self->im->evolve_islands(self->im_pms, self->pr_pms);
+        self->ctx->cancel.reset();
+        *self->results = return_best_results(self->im->island, rtype);
+    } catch (std::bad_alloc &) {
+        bad_alloc = true;
+    }
+    Py_END_ALLOW_THREADS
+
+    if (raise_callback_error(self->ctx)) {
+        return NULL;
+    }
+    if (bad_alloc) {
+        return PyErr_NoMemory();
+    }
+    Py_RETURN_NONE;
+}
+
+
+/**
+ * IM.cancel(). Stops a running evolve (called from another thread) after the
+ * current generation of the islands.
+ */
+static PyObject *im_cancel(PyObject *obj, PyObject *)
+{
+    PyIM *self = reinterpret_cast<PyIM *>(obj);
+    if (!im_ready(self)) {
+        return NULL;
+    }
+    self->ctx->cancel.cancel();
+    Py_RETURN_NONE;
+}
+
+
+/**
+ * IM.island_population(i). Genomes of island i (read-only view).
+ */
+static PyObject *im_island_population(PyObject *obj, PyObject *args)
+{
+    PyIM *self = reinterpret_cast<PyIM *>(obj);
+    Py_ssize_t i;
+
+    if (!PyArg_ParseTuple(args, "n", &i) || !im_ready(self)) {
+        return NULL;
+    }
+    if (i < 0 || static_cast<size_t>(i) >= self->im->island.size()) {
+        PyErr_SetString(PyExc_IndexError, "island index out of range");
+        return NULL;
+    }
+    GA &ga = self->im->island[i];
+    ga.pack_genomes(ga.population);
+    return make_view(obj, ga.genome_matrix.data(), ga.population.size(),
+                     self->ga_pms->genome_size);
+}
+
+
+static PyObject *im_get_bsf(PyObject *obj, void *)
+{
+    PyIM *self = reinterpret_cast<PyIM *>(obj);
+    if (!im_ready(self)) {
+        return NULL;
+    }
+    std::vector<REAL_> &x = self->results->bsf;
+    return make_view(obj, x.data(), x.size(), 0);
+}
+
+
+static PyObject *im_get_average_fitness(PyObject *obj, void *)
+{
+    PyIM *self = reinterpret_cast<PyIM *>(obj);
+    if (!im_ready(self)) {
+        return NULL;
+    }
+    std::vector<REAL_> &x = self->results->average_fitness;
+    return make_view(obj, x.data(), x.size(), 0);
+}
+
+
+static PyObject *im_get_best_genome(PyObject *obj, void *)
+{
+    PyIM *self = reinterpret_cast<PyIM *>(obj);
+    if (!im_ready(self)) {
+        return NULL;
+    }
+    std::vector<REAL_> &x = self->results->genome;
+    return make_view(obj, x.data(), x.size(), 0);
+}
+
+
+static PyObject *im_get_pareto_genomes(PyObject *obj, void *)
+{
+    PyIM *self = reinterpret_cast<PyIM *>(obj);
+    if (!im_ready(self)) {
+        return NULL;
+    }
+    std::vector<REAL_> &x = self->results->pareto_genomes;
+    size_t cols = self->ga_pms->genome_size;
+    return make_view(obj, x.data(), x.size() / cols, cols);
+}
+
+
+static PyObject *im_get_pareto_objectives(PyObject *obj, void *)
+{
+    PyIM *self = reinterpret_cast<PyIM *>(obj);
+    if (!im_ready(self)) {
+        return NULL;
+    }
+    std::vector<REAL_> &x = self->results->pareto_objectives;
+    size_t cols = self->ga_pms->num_objectives;
+    return make_view(obj, x.data(), x.size() / cols, cols);
+}
+
+
+static PyObject *im_get_num_islands(PyObject *obj, void *)
+{
+    PyIM *self = reinterpret_cast<PyIM *>(obj);
+    if (!im_ready(self)) {
+        return NULL;
+    }
+    return PyLong_FromSize_t(self->im->island.size());
+}
+
+
+static PyMethodDef im_methods[] = {
+    {"evolve", reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)(void)>(im_evolve)),
+     METH_VARARGS | METH_KEYWORDS,
+     "evolve(return_type='minimum')\n\nEvolves the islands with the GIL "
+     "released and keeps the results of the island chosen by return_type "
+     "(minimum, maximum, random)."},
+    {"island_population", im_island_population, METH_VARARGS,
+     "island_population(i)\n\nGenomes of island i, population_size x "
+     "genome_size (read-only view)."},
+    {"cancel", im_cancel, METH_NOARGS,
+     "cancel()\n\nStops a running evolve (from another thread) after the "
+     "current generation of the islands."},
+    {NULL, NULL, 0, NULL}
+};
+
+
+static PyGetSetDef im_getset[] = {
+    {const_cast<char *>("bsf"), im_get_bsf, NULL,
+     const_cast<char *>("Best-so-far fitness record (read-only view)"), NULL},
+    {const_cast<char *>("average_fitness"), im_get_average_fitness, NULL,
+     const_cast<char *>("Average fitness record (read-only view)"), NULL},
+    {const_cast<char *>("best_genome"), im_get_best_genome, NULL,
+     const_cast<char *>("Best-so-far genome (read-only view)"), NULL},
+    {const_cast<char *>("pareto_genomes"), im_get_pareto_genomes, NULL,
+     const_cast<char *>("Genomes of the Pareto front of all the islands, "
+                        "n x genome_size (read-only view)"), NULL},
+    {const_cast<char *>("pareto_objectives"), im_get_pareto_objectives, NULL,
+     const_cast<char *>("Objectives of the Pareto front of all the islands, "
+                        "n x n_objectives (read-only view)"), NULL},
+    {const_cast<char *>("num_islands"), im_get_num_islands, NULL,
+     const_cast<char *>("Number of islands"), NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+
+/* ------------------------------------------------------------------------- */
+/* Module                                                                     */
+/* ------------------------------------------------------------------------- */
+
+static struct PyModuleDef gaim_module = {
+    PyModuleDef_HEAD_INIT,
+    GAIM_PY_MODULE,
+    "GAIM native bindings (" GAIM_PRECISION " precision).\n\n"
+    "GA(fitness, **parameters) and IM(fitness, **parameters) take the\n"
+    "parameters of pygaim.GAOptimize. fitness(genomes) receives an\n"
+    "n x genome_size read-only buffer (valid only during the call) and\n"
+    "returns n fitness values (maximized).",
+    -1,
+    NULL, NULL, NULL, NULL, NULL
+};
+
+
+static PyType_Slot view_slots[] = {
+    {Py_tp_dealloc, reinterpret_cast<void *>(view_dealloc)},
+    {Py_bf_getbuffer, reinterpret_cast<void *>(view_getbuffer)},
+    {Py_bf_releasebuffer, reinterpret_cast<void *>(view_releasebuffer)},
+    {Py_tp_doc, const_cast<char *>("Buffer viewing memory owned by a GA or IM")},
+    {0, NULL}
+};
+
+
+static PyType_Slot ga_slots[] = {
+    {Py_tp_init, reinterpret_cast<void *>(ga_init)},
+    {Py_tp_new, reinterpret_cast<void *>(PyType_GenericNew)},
+    {Py_tp_dealloc, reinterpret_cast<void *>(ga_dealloc)},
+    {Py_tp_methods, ga_methods},
+    {Py_tp_getset, ga_getset},
+    {Py_tp_doc, const_cast<char *>("GA(fitness, **parameters)\n\nGenetic "
+                                   "Algorithm with a batch fitness callback.")},
+    {0, NULL}
+};
+
+
+static PyType_Slot im_slots[] = {
+    {Py_tp_init, reinterpret_cast<void *>(im_init)},
+    {Py_tp_new, reinterpret_cast<void *>(PyType_GenericNew)},
+    {Py_tp_dealloc, reinterpret_cast<void *>(im_dealloc)},
+    {Py_tp_methods, im_methods},
+    {Py_tp_getset, im_getset},
+    {Py_tp_doc, const_cast<char *>("IM(fitness, **parameters)\n\nIsland "
+                                   "Model with a batch fitness callback.")},
+    {0, NULL}
+};
+
+
+static PyType_Spec view_spec = {GAIM_PY_MODULE ".View", sizeof(PyView), 0,
+                                Py_TPFLAGS_DEFAULT, view_slots};
+static PyType_Spec ga_spec = {GAIM_PY_MODULE ".GA", sizeof(PyGA), 0,
+                              Py_TPFLAGS_DEFAULT, ga_slots};
+static PyType_Spec im_spec = {GAIM_PY_MODULE ".IM", sizeof(PyIM), 0,
+                              Py_TPFLAGS_DEFAULT, im_slots};
+
+
+PyMODINIT_FUNC GAIM_PY_INIT(void)
+{
+    PyViewType = reinterpret_cast<PyTypeObject *>(PyType_FromSpec(&view_spec));
+    if (!PyViewType) {
+        return NULL;
+    }
+    PyObject *m = PyModule_Create(&gaim_module);
+    if (!m) {
+        return NULL;
+    }
+    PyObject *ga_type = PyType_FromSpec(&ga_spec);
+    if (!ga_type || PyModule_AddObject(m, "GA", ga_type) < 0) {
+        Py_XDECREF(ga_type);
+        Py_DECREF(m);
+        return NULL;
+    }
+    PyObject *im_type = PyType_FromSpec(&im_spec);
+    if (!im_type || PyModule_AddObject(m, "IM", im_type) < 0) {
+        Py_XDECREF(im_type);
+        Py_DECREF(m);
+        return NULL;
+    }
+    if (PyModule_AddStringConstant(m, "precision", GAIM_PRECISION) < 0) {
+        Py_DECREF(m);
+        return NULL;
+    }
+    return m;
+}
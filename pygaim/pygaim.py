@@ -4,9 +4,9 @@ import matplotlib.pylab as plt
 import matplotlib.ticker as mticker
 
 
-def c2numpy(arr, length):
+def c2numpy(arr, length, c_real=C.c_float):
     address = C.addressof(arr.contents)
-    arr = np.ctypeslib.as_array((C.c_float * length).from_address(address))
+    arr = np.ctypeslib.as_array((c_real * length).from_address(address))
     return arr
 
 
@@ -50,7 +50,9 @@ class GAOptimize():
                  log_fitness=False,
                  log_average_fitness=True,
                  log_bsf=True,
-                 log_best_genome=True):
+                 log_best_genome=True,
+                 log_parameters=False,
+                 precision="float"):
         self.n_generations = n_generations
         self.population_size = population_size
         self.genome_size = genome_size
@@ -87,26 +89,36 @@ class GAOptimize():
         self.log_average_fitness = log_average_fitness
         self.log_bsf = log_bsf
         self.log_best_genome = log_best_genome
+        self.log_parameters = log_parameters
 
-        arr_dtype = C.POINTER(C.c_float*self.genome_size)
-        self.a = np.array(a, 'f').ctypes.data_as(arr_dtype)
-        self.b = np.array(b, 'f').ctypes.data_as(arr_dtype)
+        # Scalar type (libgaim.so exports a float and a double build)
+        if precision == "float":
+            c_real, dtype, suffix = C.c_float, 'f', ''
+        elif precision == "double":
+            c_real, dtype, suffix = C.c_double, 'd', '_double'
+        else:
+            raise ValueError("precision must be either float or double")
+        self.c_real = c_real
 
-        self.genome = np.zeros((self.genome_size,), 'f')
-        self.genome_p = self.genome.ctypes.data_as(C.POINTER(C.c_float))
+        arr_dtype = C.POINTER(c_real*self.genome_size)
+        self.a = np.array(a, dtype).ctypes.data_as(arr_dtype)
+        self.b = np.array(b, dtype).ctypes.data_as(arr_dtype)
 
-        self.bsf = np.zeros((self.n_generations,), 'f')
-        self.bsf_p = self.bsf.ctypes.data_as(C.POINTER(C.c_float))
+        self.genome = np.zeros((self.genome_size,), dtype)
+        self.genome_p = self.genome.ctypes.data_as(C.POINTER(c_real))
 
-        self.avg = np.zeros((self.n_generations,), 'f')
-        self.avg_p = self.avg.ctypes.data_as(C.POINTER(C.c_float))
+        self.bsf = np.zeros((self.n_generations,), dtype)
+        self.bsf_p = self.bsf.ctypes.data_as(C.POINTER(c_real))
+
+        self.avg = np.zeros((self.n_generations,), dtype)
+        self.avg_p = self.avg.ctypes.data_as(C.POINTER(c_real))
 
         library_path = "/home/gdetorak/packages/gaim/lib/libgaim.so"
         pygaim = C.cdll.LoadLibrary(library_path)
-        self.ga_optimize = pygaim.ga_optimization_python
+        self.ga_optimize = getattr(pygaim, "ga_optimization_python" + suffix)
 
-        self.CMPFUNC = C.CFUNCTYPE(C.c_float,
-                                   C.POINTER(C.c_float*self.genome_size),
+        self.CMPFUNC = C.CFUNCTYPE(c_real,
+                                   C.POINTER(c_real*self.genome_size),
                                    C.c_size_t)
 
         self.ga_optimize.argtypes = [self.CMPFUNC,
@@ -116,22 +128,22 @@ class GAOptimize():
                                      C.c_size_t,
                                      C.c_size_t,
                                      C.c_size_t,
-                                     C.POINTER(C.c_float*self.genome_size),
-                                     C.POINTER(C.c_float*self.genome_size),
+                                     C.POINTER(c_real*self.genome_size),
+                                     C.POINTER(c_real*self.genome_size),
                                      C.c_char_p,
                                      C.c_char_p,
                                      C.c_char_p,
-                                     C.c_float,
+                                     c_real,
                                      C.c_size_t,
                                      C.c_size_t,
                                      C.c_size_t,
                                      C.c_bool,
                                      C.c_char_p,
                                      C.c_char_p,
-                                     C.c_float,
-                                     C.c_float,
-                                     C.c_float,
-                                     C.c_float,
+                                     c_real,
+                                     c_real,
+                                     c_real,
+                                     c_real,
                                      C.c_size_t,
                                      C.c_bool,
                                      C.c_bool,
@@ -148,9 +160,10 @@ class GAOptimize():
                                      C.c_bool,
                                      C.c_bool,
                                      C.c_bool,
-                                     C.POINTER(C.POINTER(C.c_float)),
-                                     C.POINTER(C.POINTER(C.c_float)),
-                                     C.POINTER(C.POINTER(C.c_float))]
+                                     C.c_bool,
+                                     C.POINTER(C.POINTER(c_real)),
+                                     C.POINTER(C.POINTER(c_real)),
+                                     C.POINTER(C.POINTER(c_real))]
         self.ga_optimize.restype = None
 
         self.callback = self.CMPFUNC(objective_func)
@@ -195,6 +208,7 @@ class GAOptimize():
                          self.log_average_fitness,
                          self.log_bsf,
                          self.log_best_genome,
+                         self.log_parameters,
                          C.byref(self.genome_p),
                          C.byref(self.bsf_p),
                          C.byref(self.avg_p))
@@ -0,0 +1,139 @@
+import numpy as np
+
+try:
+    from pygaim import _gaim, _gaim_double
+except ImportError:
+    import _gaim
+    import _gaim_double
+
+
+def _module(precision):
+    if precision == "float":
+        return _gaim
+    elif precision == "double":
+        return _gaim_double
+    raise ValueError("precision must be either float or double")
+
+
+def _batch(objective_func):
+    """!
+    Wraps a batch objective function so it receives the genomes as a 2-D
+    numpy array (a view of the library buffer, valid only during the call).
+    With several objectives the (n, n_objectives) costs are flattened
+    row-wise.
+    """
+    if objective_func is None:
+        return None
+
+    def fitness(genomes):
+        return np.ravel(objective_func(np.asarray(genomes)))
+    return fitness
+
+
+def _flatten_seeds(parameters):
+    """!
+    Flattens the seed genomes (warm start), given as a (n, genome_size) array
+    (e.g., the population of a previous run), row-wise.
+    """
+    if "seed_genomes" in parameters:
+        parameters["seed_genomes"] = np.ravel(parameters["seed_genomes"]).tolist()
+
+
+class GA():
+    """!
+    Native GA (no ctypes). objective_func receives all the genomes of an
+    evaluation as a (n, genome_size) numpy array and returns n fitness values
+    (the GA maximizes them). seed_genomes (an array of genomes, e.g. the
+    population of a previous run) and seed_fname warm start the population.
+    The evolution runs with the GIL released. The results (bsf,
+    average_fitness, best_genome, population) are read-only numpy views of the
+    library buffers; copy them (or delete them) before calling evolve again.
+    cancel() (from another thread) stops a running evolve after the current
+    generation; eval_timeout_ms gives each genome a time budget: the workers
+    (worker_command) that overrun it are killed and their genome gets
+    timeout_penalty, and objective_func reports the genomes it gives up by
+    returning timeout_penalty for them.
+    With worker_command (and objective_func None) the fitness is evaluated by
+    n_workers processes running the command, which calls
+    pygaim.worker.serve(objective_func).
+    With n_objectives > 1 objective_func returns a (n, n_objectives) array
+    (all maximized), the GA runs in NSGA-II mode and pareto_genomes and
+    pareto_objectives hold the non-dominated individuals of the population.
+    """
+    def __init__(self, objective_func, precision="float", **parameters):
+        _flatten_seeds(parameters)
+        self.ga = _module(precision).GA(_batch(objective_func), **parameters)
+
+    def evolve(self, generations=None):
+        self.ga.evolve(generations)
+
+    def cancel(self):
+        self.ga.cancel()
+
+    @property
+    def bsf(self):
+        return np.asarray(self.ga.bsf)
+
+    @property
+    def average_fitness(self):
+        return np.asarray(self.ga.average_fitness)
+
+    @property
+    def best_genome(self):
+        return np.asarray(self.ga.best_genome)
+
+    @property
+    def population(self):
+        return np.asarray(self.ga.population)
+
+    @property
+    def pareto_genomes(self):
+        return np.asarray(self.ga.pareto_genomes)
+
+    @property
+    def pareto_objectives(self):
+        return np.asarray(self.ga.pareto_objectives)
+
+
+class IM():
+    """!
+    Native Island Model (one thread per island, see GA for the objective
+    function and the results). pareto_genomes and pareto_objectives hold
+    the Pareto front of all the islands.
+    """
+    def __init__(self, objective_func, precision="float", **parameters):
+        _flatten_seeds(parameters)
+        self.im = _module(precision).IM(_batch(objective_func), **parameters)
+
+    def evolve(self, return_type="minimum"):
+        self.im.evolve(return_type)
+
+    def cancel(self):
+        self.im.cancel()
+
+    def island_population(self, i):
+        return np.asarray(self.im.island_population(i))
+
+    @property
+    def num_islands(self):
+        return self.im.num_islands
+
+    @property
+    def bsf(self):
+        return np.asarray(self.im.bsf)
+
+    @property
+    def average_fitness(self):
+        return np.asarray(self.im.average_fitness)
+
+    @property
+    def best_genome(self):
+        return np.asarray(self.im.best_genome)
+
+    @property
+    def pareto_genomes(self):
+        return np.asarray(self.im.pareto_genomes)
+
+    @property
+    def pareto_objectives(self):
+        return np.asarray(self.im.pareto_objectives)
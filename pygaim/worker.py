@@ -0,0 +1,52 @@
+import mmap
+import os
+import struct
+
+import numpy as np
+
+# Header of the shared memory of a worker (see worker_header_s in gaim.h)
+_HEADER = struct.Struct("=8sIIQQ")
+# Socket and shared memory of the worker (inherited file descriptors)
+_FD = 3
+_SHM_FD = 4
+
+
+def _read_all(fd, n):
+    data = b""
+    while len(data) < n:
+        chunk = os.read(fd, n - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+
+def serve(objective_func):
+    """!
+    Main loop of an evaluation worker process started by a GA or IM created
+    with worker_command (e.g. worker_command="python3 my_objective.py").
+    objective_func receives the genomes of a request as a (n, genome_size)
+    numpy array (a view of the shared memory, valid only during the call) and
+    returns n fitness values. It returns once the optimization is done.
+    """
+    shm = mmap.mmap(_SHM_FD, 0)
+    os.close(_SHM_FD)
+    magic, version, value_size, genome_size, capacity = \
+        _HEADER.unpack_from(shm, 0)
+    if magic != b"GAIMWORK" or version != 1:
+        raise RuntimeError("invalid shared memory of the worker")
+    dtype = np.float32 if value_size == 4 else np.float64
+    genomes = np.frombuffer(shm, dtype=dtype, count=capacity * genome_size,
+                            offset=_HEADER.size).reshape(capacity, genome_size)
+    costs = np.frombuffer(shm, dtype=dtype, count=capacity,
+                          offset=_HEADER.size + genomes.nbytes)
+
+    while True:
+        request = _read_all(_FD, 8)
+        if request is None:
+            break
+        n = struct.unpack("=Q", request)[0]
+        costs[:n] = objective_func(genomes[:n])
+        os.write(_FD, request)
+    del genomes, costs
+    shm.close()
@@ -9,15 +9,18 @@ echo "Testing Genetic Algorithm methods"
 echo "************************"
 #res=$(./bin/test_ga)
 ./bin/test_ga
+./bin/test_ga_double
 
 echo "************************"
 echo "Testing logging functions"
 echo "************************"
 # res=$(./bin/test_prints)
 ./bin/test_prints
+./bin/test_prints_double
 
 echo "************************"
 echo "Testing Island Model functions"
 echo "************************"
 # res=$(./bin/test_im)
 ./bin/test_im
+./bin/test_im_double
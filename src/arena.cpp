@@ -0,0 +1,211 @@
+/* Arena allocator cpp file for GAIM software
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file arena.cpp
+ * Implements the generation-scoped arena allocator that serves the temporary
+ * buffers of a GA.
+ */
+// $Log$
+#include "gaim.h"
+#include <new>
+
+GAIM_BEGIN_NAMESPACE
+
+
+/**
+ * @brief Constructor of Arena class. No memory is reserved until the first
+ * allocation.
+ *
+ * @param[in] size Minimum size of a chunk in bytes
+ * @return Nothing
+ */
+Arena::Arena(size_t size)
+    : current(0), offset(0), chunk_size(size ? size : 1024)
+{
+}
+
+
+/**
+ * @brief Copy constructor of Arena class. The blocks of an arena belong to a
+ * single GA, so the copy starts empty (with the same chunk size).
+ */
+Arena::Arena(const Arena &other)
+    : current(0), offset(0), chunk_size(other.chunk_size)
+{
+}
+
+
+/**
+ * @brief Copy assignment of Arena class (the arena is emptied, see the copy
+ * constructor).
+ */
+Arena &Arena::operator=(const Arena &other)
+{
+    if (this != &other) {
+        release();
+        chunk_size = other.chunk_size;
+    }
+    return *this;
+}
+
+
+/**
+ * @brief Move constructor of Arena class. The chunks are handed over and the
+ * moved-from arena is left empty.
+ */
+Arena::Arena(Arena &&other) noexcept
+    : chunks(std::move(other.chunks)),
+      current(other.current),
+      offset(other.offset),
+      chunk_size(other.chunk_size),
+      stats(other.stats)
+{
+    other.chunks.clear();
+    other.current = 0;
+    other.offset = 0;
+    other.stats = arena_stats_s();
+}
+
+
+/**
+ * @brief Move assignment of Arena class (see the move constructor).
+ */
+Arena &Arena::operator=(Arena &&other) noexcept
+{
+    if (this != &other) {
+        release();
+        chunks.swap(other.chunks);
+        current = other.current;
+        offset = other.offset;
+        chunk_size = other.chunk_size;
+        stats = other.stats;
+        other.current = 0;
+        other.offset = 0;
+        other.stats = arena_stats_s();
+    }
+    return *this;
+}
+
+
+/**
+ * @brief Destructor of Arena class.
+ */
+Arena::~Arena()
+{
+    release();
+}
+
+
+/**
+ * Returns all the chunks to the heap and clears the statistics.
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void Arena::release(void)
+{
+    for (auto &c : chunks) {
+        std::free(c.first);
+    }
+    chunks.clear();
+    current = 0;
+    offset = 0;
+    stats = arena_stats_s();
+}
+
+
+/**
+ * Returns a block of memory. The offset of the current chunk is bumped; when
+ * the block does not fit, the next reserved chunk is used or a new chunk is
+ * reserved from the heap.
+ *
+ * @param[in] bytes Size of the block
+ * @param[in] alignment Alignment of the block (power of two)
+ * @return A pointer to the block
+ */
+void *Arena::allocate(size_t bytes, size_t alignment)
+{
+    while (true) {
+        if (current < chunks.size()) {
+            size_t start = (offset + alignment - 1) & ~(alignment - 1);
+            if (start + bytes <= chunks[current].second) {
+                offset = start + bytes;
+                stats.bytes += bytes;
+                stats.peak_bytes = std::max(stats.peak_bytes, stats.bytes);
+                ++stats.allocations;
+                ++stats.total_allocations;
+                return chunks[current].first + start;
+            }
+            if (current + 1 < chunks.size()) {
+                ++current;
+                offset = 0;
+                continue;
+            }
+        }
+        // Reserve a new chunk (malloc aligns to max_align_t)
+        size_t size = std::max(chunk_size, bytes + alignment);
+        char *data = static_cast<char *>(std::malloc(size));
+        if (!data) {
+            throw std::bad_alloc();
+        }
+        chunks.push_back(std::make_pair(data, size));
+        current = chunks.size() - 1;
+        offset = 0;
+        stats.capacity += size;
+        ++stats.chunks;
+    }
+}
+
+
+/**
+ * Releases all the blocks at once. The chunks are kept for the next
+ * generation; if more than one chunk was needed, they are merged into one
+ * chunk large enough for the whole generation.
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void Arena::reset(void)
+{
+    if (chunks.size() > 1) {
+        size_t capacity = stats.capacity;
+        arena_stats_s old = stats;
+        release();
+        chunk_size = std::max(chunk_size, capacity);
+        stats.peak_bytes = old.peak_bytes;
+        stats.resets = old.resets;
+        stats.total_allocations = old.total_allocations;
+
+        char *data = static_cast<char *>(std::malloc(chunk_size));
+        if (!data) {
+            throw std::bad_alloc();
+        }
+        chunks.push_back(std::make_pair(data, chunk_size));
+        stats.capacity = chunk_size;
+        stats.chunks = 1;
+    }
+    current = 0;
+    offset = 0;
+    stats.bytes = 0;
+    stats.allocations = 0;
+    ++stats.resets;
+}
+
+GAIM_END_NAMESPACE
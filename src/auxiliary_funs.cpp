@@ -29,8 +29,15 @@
 #include <sys/stat.h> 
 #include <sys/types.h> 
 #include <cstdint>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 #include "gaim.h"
 
+GAIM_BEGIN_NAMESPACE
+
 
 /**
  * Vector's Euclidean norm. It computes the Euclidean norm of a vector of type
@@ -57,7 +64,7 @@ REAL_ vector_norm(std::vector<REAL_> x) {
  * @return A vector of REAL_ that contains the norms of all population's
  * individuals
  */
-std::vector<REAL_> compute_population_norms(std::vector<GA> x) {
+std::vector<REAL_> compute_population_norms(const std::vector<GA> &x) {
     std::vector<REAL_> norms;
     for (auto &p : x) {
         norms.push_back(vector_norm(p.get_best_genome()));
@@ -94,6 +101,47 @@ int argmin(std::vector<REAL_> x) {
 }   
 
 
+/**
+ * Picks the GA whose best genome is returned, based on the Euclidean norm of
+ * the best genomes.
+ *
+ * @param[in] population A vector of type GA
+ * @param[in] return_type Which genome is returned (minimum, maximum, random)
+ * @return The index of the chosen GA
+ */
+static int best_results_index(const std::vector<GA> &population,
+                              std::string return_type) {
+    std::vector<REAL_> norms;
+
+    norms = compute_population_norms(population);
+
+    if (return_type == "minimum") {
+        return argmin(norms);
+    }else if (return_type == "random") {
+        return (int) int_random(0, norms.size()-1);
+    }
+    return argmax(norms);
+}
+
+
+/**
+ * Stores the Pareto front of all the GAs (runs or islands) in the results
+ * (multi-objective mode only).
+ */
+static void pareto_results(const std::vector<GA> &population, ga_results_s &res)
+{
+    if (population.empty() || population[0].get_num_objectives() < 2) {
+        return;
+    }
+    std::vector<individual_s> fronts;
+    for (auto &ga : population) {
+        std::vector<individual_s> front = ga.get_pareto_front();
+        fronts.insert(fronts.end(), front.begin(), front.end());
+    }
+    pack_pareto_front(pareto_front(fronts), res);
+}
+
+
 /**
  * Return best results. It computes the best genome based on the Euclidean
  * norm. 
@@ -101,24 +149,47 @@ int argmin(std::vector<REAL_> x) {
  * @param[in] x A vector of type REAL_
  * @return A data structure of type ga_results_s
  */
-ga_results_s return_best_results(std::vector<GA> population,
+ga_results_s return_best_results(const std::vector<GA> &population,
                                  std::string return_type) {
     int best_index(0);
-    std::vector<REAL_> norms;
     ga_results_s res;
 
-    norms = compute_population_norms(population);
-
-    if (return_type == "minimum") {
-        best_index = argmin(norms);
-    }else if (return_type == "random") {
-        best_index = (int) int_random(0, norms.size()-1);
-    } else {
-        best_index = argmax(norms);
-    }
+    best_index = best_results_index(population, return_type);
     res.bsf = population[best_index].get_bsf();
     res.average_fitness = population[best_index].get_average_fitness();
     res.genome = population[best_index].get_best_genome();
+    for (auto &ga : population) {
+        res.profile.push_back(ga.profile);
+    }
+    pareto_results(population, res);
+    return res;
+}
+
+
+/**
+ * Return best results (consuming version). The records and the genome of the
+ * chosen GA are moved into the results and the GAs are destroyed right after,
+ * so the results never coexist with a copy of the populations.
+ *
+ * @param[in] population A vector of type GA (it is left empty)
+ * @param[in] return_type Which genome is returned (minimum, maximum, random)
+ * @return A data structure of type ga_results_s
+ */
+ga_results_s return_best_results(std::vector<GA> &&population,
+                                 std::string return_type) {
+    int best_index(0);
+    ga_results_s res;
+
+    best_index = best_results_index(population, return_type);
+    res.bsf = std::move(population[best_index].get_bsf());
+    res.average_fitness = std::move(population[best_index].get_average_fitness());
+    res.genome = std::move(population[best_index].get_best_genome());
+    res.profile.reserve(population.size());
+    for (auto &ga : population) {
+        res.profile.push_back(ga.profile);
+    }
+    pareto_results(population, res);
+    std::vector<GA>().swap(population);
     return res;
 }
 
@@ -157,21 +228,6 @@ REAL_ float_random(REAL_ a, REAL_ b) {
 }
 
 
-/**
- * Removes an element from a vector by swaping the element at position n with 
- * the last one and poping it out of the vector.
- *
- * @param[in] v The input vector from whith an element will be deleted.
- * @param[in] n The size_type of the vector (position of deleted element).
- * @return (void)
- */
-void remove_at(std::vector<size_t> &v, std::vector<size_t>::size_type n)
-{
-    std::swap(v[n], v.back());
-    v.pop_back();
-}
-
-
 /**
  * Computes the cumulative fitness of a population based on which individuals
  * have not been yet selected. This function is used in the
@@ -182,7 +238,7 @@ void remove_at(std::vector<size_t> &v, std::vector<size_t>::size_type n)
  *
  * @see roulette_wheel_selection()
  */
-REAL_ cumulative_fitness(std::vector<individual_s> population) {
+REAL_ cumulative_fitness(const std::vector<individual_s> &population) {
     REAL_ cumulative_fit = 0.0;
 
     for (auto &ind : population) {
@@ -201,7 +257,7 @@ REAL_ cumulative_fitness(std::vector<individual_s> population) {
  * @param[in] population A vector of the entire population.
  * @return The maximum fitness of a population.
  */
-REAL_ maximum_fitness(std::vector<individual_s> population)
+REAL_ maximum_fitness(const std::vector<individual_s> &population)
 {
     REAL_ max_fitness(0);
 
@@ -227,7 +283,7 @@ REAL_ maximum_fitness(std::vector<individual_s> population)
  * @return The maximum fitness of a population (of the non-selected
  * individuals).
  */
-REAL_ nonselected_maximum_fitness(std::vector<individual_s> population)
+REAL_ nonselected_maximum_fitness(const std::vector<individual_s> &population)
 {
     REAL_ max_fitness(0);
 
@@ -250,7 +306,7 @@ REAL_ nonselected_maximum_fitness(std::vector<individual_s> population)
  * @param[in] y Data struct of type const individual_s.
  * @return True if x.fitness < y.fitness, false otherwise.
  */
-bool compare_fitness(const individual_s x, const individual_s y)
+bool compare_fitness(const individual_s &x, const individual_s &y)
 {
     return (x.fitness < y.fitness);
 }
@@ -270,12 +326,51 @@ bool compare_fitness(const individual_s x, const individual_s y)
  * @return The current accumulated fitness yielded in the accumulation (usually
  * for the whole population.)
  */
-REAL_ average_fitness(REAL_ x, const individual_s y)
+REAL_ average_fitness(REAL_ x, const individual_s &y)
 {
     return x + y.fitness;
 }
 
 
+/**
+ * Computes the fitness statistics of a population (lowest, highest, and
+ * average fitness, variance, sum, and the indices of the worst and the best
+ * individuals) in a single pass. The sums are accumulated in double precision.
+ *
+ * @param[in] population A vector of the entire population.
+ * @return A population_stats_s structure.
+ */
+population_stats_s population_statistics(const std::vector<individual_s> &population)
+{
+    population_stats_s stats;
+    double sum = 0, sq = 0;
+    size_t n = population.size();
+
+    if (n == 0) {
+        return stats;
+    }
+    stats.min = stats.max = population[0].fitness;
+    for (size_t i = 0; i < n; ++i) {
+        REAL_ f = population[i].fitness;
+        sum += f;
+        sq += static_cast<double>(f) * f;
+        if (f < stats.min) {
+            stats.min = f;
+            stats.argmin = i;
+        }
+        if (f > stats.max) {
+            stats.max = f;
+            stats.argmax = i;
+        }
+    }
+    double mean = sum / n;
+    stats.sum = static_cast<REAL_>(sum);
+    stats.mean = static_cast<REAL_>(mean);
+    stats.variance = static_cast<REAL_>(std::max(sq / n - mean * mean, 0.0));
+    return stats;
+}
+
+
 /**
  * Checks if the given path (directory or file) exists. 
  *
@@ -323,16 +418,20 @@ int mkdir_(const std::string &path)
 
 
 /**
- * Attempts to make a directory.
+ * Attempts to make a directory. It is called by the logging functions right
+ * before a file is written, so nothing is created unless something is saved.
  *
  * @param[in] path const string that contains the name (path) of the new
  *             directory. 
  *
- * @return Zero upon successfully created directory, one otherwise.
+ * @return Zero upon successfully created (or existing) directory, one
+ * otherwise.
  */
 int make_dir(const std::string &path) {
+    static std::mutex mtx;  // Islands may log (and create it) concurrently
     int flag;
     if (path != "stdout") {
+        std::lock_guard<std::mutex> lock(mtx);
         if (!is_path_exist(path)) {
             flag = mkdir_(path);
             if (flag) { return -1; }
@@ -340,3 +439,403 @@ int make_dir(const std::string &path) {
     }
     return 0;
 }
+
+
+/**
+ * Parses a text clipping values file.
+ *
+ * @param[in] fname Name of the clipping values file
+ * @param[in] num_values Number of values to read
+ * @param[out] num_read Number of values found in the file (nullptr to ignore)
+ * @return The values (owned by the returned pointer)
+ */
+static std::shared_ptr<const REAL_> parse_clipping_file(const std::string &fname,
+                                                        size_t num_values,
+                                                        size_t *num_read=nullptr)
+{
+    auto ifile = std::fstream(fname, std::ios::in);
+    if (!ifile) {
+        std::cout << "Unable to open file " << fname << std::endl;
+        fatal_error(1);
+    }
+    std::shared_ptr<std::vector<REAL_>> values(new std::vector<REAL_>(num_values));
+    size_t n = 0;
+    for (auto &v : *values) {
+        if (ifile >> v) {
+            ++n;
+        }
+    }
+    if (num_read) {
+        *num_read = n;
+    }
+    return std::shared_ptr<const REAL_>(values, values->data());
+}
+
+
+/**
+ * Memory-maps a binary clipping values file (see convert_clipping_file). The
+ * mapping is read-only and released with the last pointer to it. A file
+ * written in the other precision is converted once into memory instead.
+ * While mapped, the file must only be replaced atomically (written elsewhere
+ * and renamed over it, as convert_clipping_file does): truncating it in place
+ * makes the GAs reading the mapping crash (SIGBUS).
+ *
+ * @param[in] fname Name of the clipping values file
+ * @param[in] header Header of the file
+ * @param[in] size Size of the file in bytes
+ * @param[in] mu Population size
+ * @param[in] genome_size Genome size
+ * @return The values (mu x 2 x genome_size)
+ */
+static std::shared_ptr<const REAL_> map_clipping_file(const std::string &fname,
+                                                      const clipping_header_s &header,
+                                                      size_t size,
+                                                      size_t mu,
+                                                      size_t genome_size)
+{
+    size_t num_values = mu * 2 * genome_size;
+
+    if (header.version != 1 ||
+        (header.value_size != sizeof(float) && header.value_size != sizeof(double))) {
+        std::cerr << "ERROR: Unsupported clipping values file " << fname << "!"
+            << std::endl;
+        fatal_error();
+    }
+    if (header.population_size != mu || header.genome_size != genome_size ||
+        size < sizeof(clipping_header_s) + num_values * header.value_size) {
+        std::cerr << "ERROR: Clipping values file " << fname << " holds "
+            << header.population_size << " x " << header.genome_size
+            << " limits, expected " << mu << " x " << genome_size << "!"
+            << std::endl;
+        fatal_error();
+    }
+
+    int fd = open(fname.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cout << "Unable to open file " << fname << std::endl;
+        fatal_error(1);
+    }
+    void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "ERROR: Cannot map file " << fname << ": "
+            << strerror(errno) << std::endl;
+        fatal_error();
+    }
+    const char *data = static_cast<const char *>(base) + sizeof(clipping_header_s);
+
+    if (header.value_size == sizeof(REAL_)) {
+        return std::shared_ptr<const REAL_>(reinterpret_cast<const REAL_ *>(data),
+                                            [base, size](const REAL_ *) {
+                                                munmap(base, size);
+                                            });
+    }
+
+    std::shared_ptr<std::vector<REAL_>> values(new std::vector<REAL_>(num_values));
+    if (header.value_size == sizeof(float)) {
+        const float *v = reinterpret_cast<const float *>(data);
+        std::copy(v, v + num_values, values->begin());
+    } else {
+        const double *v = reinterpret_cast<const double *>(data);
+        std::copy(v, v + num_values, values->begin());
+    }
+    munmap(base, size);
+    return std::shared_ptr<const REAL_>(values, values->data());
+}
+
+
+/// Parsed (or mapped) clipping values files
+struct clipping_file {
+    size_t num_values;
+    std::shared_ptr<const REAL_> values;
+};
+static FileCache<clipping_file> clipping_cache;
+
+
+/**
+ * Returns the version of a file (see file_version_s).
+ *
+ * @param[in] buffer Status of the file (stat)
+ * @return The version of the file
+ */
+file_version_s get_file_version(const struct stat &buffer)
+{
+    return {buffer.st_dev, buffer.st_ino, buffer.st_size,
+            buffer.st_mtim.tv_sec, buffer.st_mtim.tv_nsec};
+}
+
+
+/**
+ * Tells whether two versions of a file are the same.
+ *
+ * @param[in] lhs Version of a file
+ * @param[in] rhs Version of a file
+ * @return True if the device, inode, size and modification time are equal
+ */
+bool operator==(const file_version_s &lhs, const file_version_s &rhs)
+{
+    return lhs.device == rhs.device && lhs.inode == rhs.inode &&
+           lhs.size == rhs.size && lhs.mtime_s == rhs.mtime_s &&
+           lhs.mtime_ns == rhs.mtime_ns;
+}
+
+
+/**
+ * Drops the cached clipping values files and connectivity graphs, e.g., for a
+ * long-running service that reads many files. The values still used by a GA
+ * remain valid until the GA is destroyed.
+ *
+ * @return Nothing (void)
+ */
+void clear_file_caches(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(clipping_cache.mtx);
+        clipping_cache.clear();
+    }
+    IM::clear_graph_cache();
+}
+
+
+/**
+ * Reads a clipping values file. For every individual the file contains
+ * genome_size lower limits followed by genome_size upper limits, either as
+ * text or in the binary format of convert_clipping_file. A binary file is
+ * memory-mapped instead of parsed. A file is read only once: the next calls
+ * (the other islands or independent runs, or later optimizations) share the
+ * same read-only values for as long as the file is not modified (see
+ * FileCache).
+ *
+ * @param[in] fname Name of the clipping values file
+ * @param[in] mu Population size
+ * @param[in] genome_size Genome size
+ * @return A shared read-only array of mu x 2 x genome_size limits
+ */
+std::shared_ptr<const REAL_> read_clipping_file(const std::string &fname,
+                                                size_t mu,
+                                                size_t genome_size)
+{
+    struct stat buffer;
+    clipping_header_s header;
+    size_t num_values = mu * 2 * genome_size;
+
+    if (stat(fname.c_str(), &buffer)) {
+        std::cout << "Unable to open file " << fname << std::endl;
+        fatal_error(1);
+    }
+    file_version_s version = get_file_version(buffer);
+
+    std::lock_guard<std::mutex> lock(clipping_cache.mtx);
+    clipping_file *cached = clipping_cache.find(fname, version);
+    if (cached && cached->num_values == num_values) {
+        return cached->values;
+    }
+
+    auto ifile = std::fstream(fname, std::ios::in | std::ios::binary);
+    bool binary = ifile.read(reinterpret_cast<char *>(&header), sizeof(header)) &&
+                  !std::memcmp(header.magic, "GAIMCLIP", sizeof(header.magic));
+    ifile.close();
+
+    std::shared_ptr<const REAL_> values;
+    if (binary) {
+        values = map_clipping_file(fname, header, buffer.st_size, mu, genome_size);
+    } else {
+        values = parse_clipping_file(fname, num_values);
+    }
+    clipping_cache.insert(fname, version, {num_values, values});
+    return values;
+}
+
+
+/**
+ * Converts a text clipping values file into the binary format, which is
+ * memory-mapped instead of parsed (see read_clipping_file). The binary file
+ * starts with a clipping_header_s header followed by the limits in the
+ * precision of the build (native byte order). It is written to a temporary
+ * file renamed over binary_fname, so GAs still mapping a previous version
+ * keep reading it.
+ *
+ * @param[in] text_fname Name of the text clipping values file
+ * @param[in] binary_fname Name of the binary file to write
+ * @param[in] mu Population size
+ * @param[in] genome_size Genome size
+ * @return Zero on success, -1 if the text file holds fewer than
+ *         mu x 2 x genome_size values or the binary file cannot be written
+ */
+int convert_clipping_file(const std::string &text_fname,
+                          const std::string &binary_fname,
+                          size_t mu,
+                          size_t genome_size)
+{
+    clipping_header_s header;
+    size_t num_values = mu * 2 * genome_size, num_read;
+    std::shared_ptr<const REAL_> values = parse_clipping_file(text_fname,
+                                                              num_values,
+                                                              &num_read);
+    if (num_read != num_values) {
+        std::cerr << "ERROR: " << text_fname << " holds " << num_read
+            << " values, expected " << num_values << "!" << std::endl;
+        return -1;
+    }
+
+    std::memcpy(header.magic, "GAIMCLIP", sizeof(header.magic));
+    header.version = 1;
+    header.value_size = sizeof(REAL_);
+    header.population_size = mu;
+    header.genome_size = genome_size;
+
+    std::vector<char> tmp(binary_fname.begin(), binary_fname.end());
+    const char suffix[] = ".XXXXXX";
+    tmp.insert(tmp.end(), suffix, suffix + sizeof(suffix));
+    int fd = mkstemp(tmp.data());
+    if (fd < 0) {
+        return -1;
+    }
+    fchmod(fd, 0644);
+    close(fd);
+
+    auto ofile = std::fstream(tmp.data(),
+                              std::ios::out | std::ios::binary | std::ios::trunc);
+    ofile.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    ofile.write(reinterpret_cast<const char *>(values.get()),
+                num_values * sizeof(REAL_));
+    ofile.close();
+    if (!ofile || std::rename(tmp.data(), binary_fname.c_str())) {
+        unlink(tmp.data());
+        return -1;
+    }
+    return 0;
+}
+
+
+/// True while a FatalErrorGuard is alive on this thread
+static thread_local bool fatal_error_guarded = false;
+
+
+/**
+ * @brief Constructor of FatalErrorGuard class.
+ */
+FatalErrorGuard::FatalErrorGuard() : previous(fatal_error_guarded)
+{
+    fatal_error_guarded = true;
+}
+
+
+/**
+ * @brief Destructor of FatalErrorGuard class.
+ */
+FatalErrorGuard::~FatalErrorGuard()
+{
+    fatal_error_guarded = previous;
+}
+
+
+/**
+ * Ends the program after an error has been reported. Within a
+ * FatalErrorGuard it throws FatalError instead, so the caller can recover.
+ *
+ * @param[in] status Exit status of the program
+ * @return Never returns
+ */
+void fatal_error(int status)
+{
+    if (fatal_error_guarded) {
+        throw FatalError();
+    }
+    exit(status);
+}
+
+
+/**
+ * Reads seed genomes (warm start, see ga_parameter_s::seed_fname). The file
+ * stores genomes row-wise as raw values in the precision of the build, the
+ * format of write_seed_genomes and of the best genome files of a previous run
+ * (print_best_genome). If fname is a directory, all its best_genome_*.dat
+ * files are read (in name order), i.e., the best genome of every island or
+ * independent run of a previous optimization.
+ *
+ * @param[in] fname Name of the seed genomes file or of a results directory
+ * @param[in] genome_size Genome size
+ * @return The genomes stored row-wise (n x genome_size)
+ */
+std::vector<REAL_> read_seed_genomes(const std::string &fname, size_t genome_size)
+{
+    std::vector<std::string> fnames;
+    std::vector<REAL_> genomes;
+    struct stat buffer;
+
+    if (stat(fname.c_str(), &buffer)) {
+        std::cerr << "ERROR: Unable to open the seed genomes file " << fname << "!" << std::endl;
+        fatal_error();
+    }
+    if (S_ISDIR(buffer.st_mode)) {
+        std::string dir = (fname.back() == '/') ? fname : fname + "/";
+        DIR *d = opendir(dir.c_str());
+        for (struct dirent *e = d ? readdir(d) : nullptr; e; e = readdir(d)) {
+            std::string name(e->d_name);
+            if (!name.compare(0, 12, "best_genome_") && name.size() > 16 &&
+                !name.compare(name.size() - 4, 4, ".dat")) {
+                fnames.push_back(dir + name);
+            }
+        }
+        if (d) { closedir(d); }
+        std::sort(fnames.begin(), fnames.end());
+    } else {
+        fnames.push_back(fname);
+    }
+
+    for (auto &f : fnames) {
+        if (stat(f.c_str(), &buffer) ||
+            buffer.st_size % (genome_size * sizeof(REAL_))) {
+            std::cerr << "ERROR: " << f << " does not contain genomes of "
+                      << genome_size << " " << GAIM_PRECISION << " values!" << std::endl;
+            fatal_error();
+        }
+        size_t offset = genomes.size();
+        genomes.resize(offset + buffer.st_size / sizeof(REAL_));
+        auto ifile = std::fstream(f, std::ios::in | std::ios::binary);
+        ifile.read(reinterpret_cast<char *>(genomes.data() + offset), buffer.st_size);
+        if (!ifile) {
+            std::cerr << "ERROR: Unable to read the seed genomes file " << f << "!" << std::endl;
+            fatal_error();
+        }
+    }
+    return genomes;
+}
+
+
+/**
+ * Writes the genomes of the n fittest individuals of a population (all of
+ * them if n is zero or larger than the population), fittest first, in the
+ * format of read_seed_genomes, so a later optimization can start from them.
+ *
+ * @param[in] fname Name of the file to write
+ * @param[in] population Population (any order)
+ * @param[in] n Number of genomes to write
+ * @return Zero on success, -1 if the file cannot be written
+ */
+int write_seed_genomes(const std::string &fname,
+                       const std::vector<individual_s> &population,
+                       size_t n)
+{
+    std::vector<const individual_s *> order;
+    for (auto &ind : population) {
+        order.push_back(&ind);
+    }
+    if (!n || n > order.size()) {
+        n = order.size();
+    }
+    std::partial_sort(order.begin(), order.begin() + n, order.end(),
+                      [](const individual_s *x, const individual_s *y) {
+                          return x->fitness > y->fitness; });
+
+    auto ofile = std::fstream(fname, std::ios::out | std::ios::binary | std::ios::trunc);
+    for (size_t i = 0; i < n; ++i) {
+        ofile.write(reinterpret_cast<const char *>(order[i]->genome.data()),
+                    order[i]->genome.size() * sizeof(REAL_));
+    }
+    ofile.close();
+    return ofile ? 0 : -1;
+}
+
+GAIM_END_NAMESPACE
@@ -0,0 +1,222 @@
+/* Batch optimization service cpp file for GAIM software
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file batch_solver.cpp
+ * Implements the batch optimization service. Small GA problems are queued
+ * and multiplexed on a fixed pool of worker threads; each worker reuses the
+ * GAs it has already built, so a problem costs its evolution and not the
+ * construction of a GA.
+ */
+// $Log$
+#include "gaim.h"
+#include <tuple>
+
+GAIM_BEGIN_NAMESPACE
+
+/// Maximum number of GAs (problem shapes) a worker keeps for reuse
+static const size_t max_cached_engines = 16;
+
+
+/**
+ * @brief Constructor of BatchSolver class. Starts the workers.
+ *
+ * @param[in] num_workers Number of worker threads (0 uses one per hardware
+ *                        thread)
+ * @return Nothing
+ */
+BatchSolver::BatchSolver(size_t num_workers)
+    : next_ticket(0), pending(0), stopping(false)
+{
+    if (!num_workers) {
+        num_workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workers.reserve(num_workers);
+    for (size_t i = 0; i < num_workers; ++i) {
+        workers.emplace_back(&BatchSolver::run, this);
+    }
+}
+
+
+/**
+ * @brief Destructor of BatchSolver class. The queued problems are solved
+ * before the workers are stopped.
+ */
+BatchSolver::~BatchSolver()
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    cv_work.notify_all();
+    for (auto &w : workers) {
+        w.join();
+    }
+}
+
+
+/**
+ * Queues a problem. The problem is copied, so the caller may reuse it.
+ *
+ * @param[in] problem GA parameters and fitness function
+ * @return The ticket of the problem (see get)
+ */
+size_t BatchSolver::submit(const batch_problem_s &problem)
+{
+    size_t ticket;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        ticket = next_ticket++;
+        uncollected.insert(ticket);
+        queue.emplace_back(ticket, problem);
+        ++pending;
+    }
+    cv_work.notify_one();
+    return ticket;
+}
+
+
+/**
+ * Waits until a problem is solved and hands over its results. The results of
+ * a ticket can be collected only once: collecting them again (or collecting
+ * an unknown ticket) terminates the process instead of waiting forever.
+ *
+ * @param[in] ticket Ticket returned by submit
+ * @return The results of the problem (best genome, BSF and average fitness)
+ */
+ga_results_s BatchSolver::get(size_t ticket)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    if (!uncollected.erase(ticket)) {
+        std::cerr << "ERROR: Batch problem ticket " << ticket
+            << ((ticket < next_ticket) ? " was already collected!" : " is unknown!")
+            << std::endl;
+        exit(-1);
+    }
+    std::map<size_t, ga_results_s>::iterator it;
+    cv_done.wait(lock, [&]{ return (it = done.find(ticket)) != done.end(); });
+    ga_results_s res = std::move(it->second);
+    done.erase(it);
+    return res;
+}
+
+
+/**
+ * Queues a number of problems and waits for all of them.
+ *
+ * @param[in] problems Problems to solve
+ * @return The results of the problems (in the same order)
+ */
+std::vector<ga_results_s> BatchSolver::solve(const std::vector<batch_problem_s> &problems)
+{
+    std::vector<size_t> tickets;
+    std::vector<ga_results_s> res;
+
+    tickets.reserve(problems.size());
+    for (auto &p : problems) {
+        tickets.push_back(submit(p));
+    }
+    res.reserve(problems.size());
+    for (auto t : tickets) {
+        res.push_back(get(t));
+    }
+    return res;
+}
+
+
+/**
+ * Waits until all the queued problems are solved (their results are kept
+ * until they are collected with get).
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void BatchSolver::wait(void)
+{
+    std::unique_lock<std::mutex> lock(mtx);
+    cv_done.wait(lock, [this]{ return pending == 0; });
+}
+
+
+/**
+ * Worker thread. It takes problems from the queue and evolves them on a GA
+ * of the same shape (population size, number of offspring, genome size),
+ * built on first use and reset for every next problem.
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void BatchSolver::run(void)
+{
+    typedef std::tuple<size_t, size_t, size_t> shape_t;
+    std::map<shape_t, std::unique_ptr<GA>> engines;
+
+    while (true) {
+        std::pair<size_t, batch_problem_s> job;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv_work.wait(lock, [this]{ return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            job = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        const batch_problem_s &problem = job.second;
+        const ga_parameter_s *ga_pms = &problem.ga_pms;
+        shape_t shape(ga_pms->population_size,
+                      ga_pms->num_offsprings,
+                      ga_pms->genome_size);
+        auto it = engines.find(shape);
+        GA *ga;
+        if (it != engines.end()) {
+            ga = it->second.get();
+            ga->reset(ga_pms);
+        } else {
+            if (engines.size() >= max_cached_engines) {
+                engines.clear();
+            }
+            ga = new GA(ga_pms);
+            engines[shape].reset(ga);
+        }
+        ga->fitness = problem.fitness ? problem.fitness : sphere;
+        ga->batch_fitness = problem.batch_fitness;
+        ga->batch_data = problem.batch_data;
+
+        ga->step(ga_pms->generations);
+
+        ga_results_s res;
+        res.bsf = std::move(ga->get_bsf());
+        res.average_fitness = std::move(ga->get_average_fitness());
+        res.genome = std::move(ga->get_best_genome());
+        res.profile.push_back(ga->profile);
+        if (ga->get_num_objectives() > 1) {
+            pack_pareto_front(ga->get_pareto_front(), res);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            done.emplace(job.first, std::move(res));
+            --pending;
+        }
+        cv_done.notify_all();
+    }
+}
+
+GAIM_END_NAMESPACE
@@ -28,6 +28,8 @@
 // $Log$
 #include "gaim.h"
 
+GAIM_BEGIN_NAMESPACE
+
 
 /**
  * @brief Assigns the appropriate crossover operator to the pointer function
@@ -57,7 +59,7 @@ void GA::select_crossover_method(void) {
         crossover = &GA::order_one_crossover;
     } else {
         std::cout << "Error: GA Crossover method not found!" << std::endl;
-        exit(-1);
+        fatal_error();
     }
 }
 
@@ -297,3 +299,5 @@ std::vector<REAL_> GA::order_one_crossover(std::vector<REAL_> parent1,
     }
     return child1;
 }
+
+GAIM_END_NAMESPACE
@@ -0,0 +1,311 @@
+/* Handle-based C API cpp file for GAIM software
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file engine.cpp
+ * Implements the handle-based C API. An engine wraps either a GA or an IM
+ * that stays alive between the calls, so a caller can step generations,
+ * inspect and replace populations, and reuse the same engine for many
+ * optimizations without paying the setup every time.
+ */
+// $Log$
+#include "gaim.h"
+#include <limits>
+#include <memory>
+
+GAIM_BEGIN_NAMESPACE
+
+
+/**
+ * @brief Optimization engine behind a gaim_engine_s handle.
+ */
+struct gaim_engine {
+    ga_parameter_s ga_pms;
+    pr_parameter_s pr_pms;
+    im_parameter_s im_pms;
+    std::unique_ptr<GA> ga;     /**< Single GA (IM disabled) */
+    std::unique_ptr<IM> im;     /**< Island Model (IM enabled) */
+    std::vector<GA *> gas;      /**< The GA or the islands of the IM */
+    CancelToken cancel;         /**< Cancels the running step (gaim_cancel) */
+};
+
+
+/**
+ * Creates an engine from parameter structures (C++ counterpart of
+ * gaim_create). An Island Model is created if im_pms.is_im_enabled is set,
+ * a single GA otherwise. Nothing is logged, the state of the engine is read
+ * through the API. Invalid parameters (or unreadable clipping, seed and graph
+ * files) are reported and the engine is not created (see FatalErrorGuard).
+ *
+ * @param[in] ga_pms Structure of GA parameters
+ * @param[in] pr_pms Structure of printing parameters
+ * @param[in] im_pms Structure of IM parameters
+ * @param[in] func Fitness function (nullptr keeps the default one)
+ * @return A new engine (release it with gaim_destroy), nullptr on error
+ */
+gaim_engine_s *gaim_create_from_parameters(const ga_parameter_s &ga_pms,
+                                           const pr_parameter_s &pr_pms,
+                                           const im_parameter_s &im_pms,
+                                           REAL_ (*func)(REAL_ *, size_t))
+{
+    std::unique_ptr<gaim_engine_s> engine(new gaim_engine_s);
+    FatalErrorGuard guard;
+
+    engine->ga_pms = ga_pms;
+    engine->pr_pms = pr_pms;
+    engine->im_pms = im_pms;
+    try {
+        if (engine->im_pms.is_im_enabled) {
+            engine->im.reset(new IM(&engine->im_pms, &engine->ga_pms));
+            engine->im->cancel_token = &engine->cancel;
+            for (auto &island : engine->im->island) {
+                engine->gas.push_back(&island);
+            }
+        } else {
+            engine->ga.reset(new GA(&engine->ga_pms));
+            engine->ga->cancel_token = &engine->cancel;
+            engine->gas.push_back(engine->ga.get());
+        }
+    } catch (const FatalError &) {
+        return nullptr;
+    }
+    if (func) {
+        for (auto ga : engine->gas) {
+            ga->fitness = func;
+        }
+    }
+    return engine.release();
+}
+
+
+/**
+ * Creates an engine from a configuration file (see read_parameters_file).
+ * An unreadable or invalid configuration is reported on the standard error
+ * and the process keeps running.
+ *
+ * @param[in] config_fname Configuration file name
+ * @param[in] func Fitness function (NULL keeps the default one)
+ * @return A new engine (release it with gaim_destroy), NULL on error
+ */
+gaim_engine_s *GAIM_C_NAME(gaim_create)(const char *config_fname,
+                                        REAL_ (*func)(REAL_ *, size_t))
+{
+    ga_parameter_s ga_pms;
+    pr_parameter_s pr_pms;
+    im_parameter_s im_pms;
+
+    if (!config_fname) {
+        std::cerr << "ERROR: gaim_create needs a configuration file!" << std::endl;
+        return NULL;
+    }
+    try {
+        FatalErrorGuard guard;
+        std::tie(ga_pms, pr_pms, im_pms) = read_parameters_file(config_fname);
+    } catch (const FatalError &) {
+        return NULL;
+    }
+    return gaim_create_from_parameters(ga_pms, pr_pms, im_pms, func);
+}
+
+
+/**
+ * Sets a batch fitness function on every GA of the engine (see
+ * GA::batch_fitness).
+ *
+ * @param[in] engine Engine handle
+ * @param[in] func Batch fitness function (NULL restores the fitness function)
+ * @param[in] data User data passed to func
+ * @return Nothing (void)
+ */
+void GAIM_C_NAME(gaim_set_batch_fitness)(gaim_engine_s *engine,
+                                         void (*func)(REAL_ *, size_t, size_t,
+                                                      REAL_ *, void *),
+                                         void *data)
+{
+    for (auto ga : engine->gas) {
+        ga->batch_fitness = func;
+        ga->batch_data = data;
+    }
+}
+
+
+/**
+ * Runs a number of generations (with migrations for an Island Model),
+ * continuing from the previous call. It returns early if gaim_cancel is
+ * called meanwhile.
+ *
+ * @param[in] engine Engine handle
+ * @param[in] generations Number of generations to run
+ * @return The number of generations run so far
+ */
+size_t GAIM_C_NAME(gaim_step)(gaim_engine_s *engine, size_t generations)
+{
+    if (engine->im) {
+        engine->im->step_islands(generations, &engine->im_pms, &engine->pr_pms);
+    } else {
+        engine->ga->step(generations);
+    }
+    engine->cancel.reset();
+    return engine->gas[0]->get_generation();
+}
+
+
+/**
+ * Fills in the dimensions of the engine, so the caller can size its buffers.
+ *
+ * @param[in] engine Engine handle
+ * @param[out] info Sizes and number of generations run so far
+ * @return Nothing (void)
+ */
+void GAIM_C_NAME(gaim_get_info)(const gaim_engine_s *engine, gaim_info_s *info)
+{
+    info->genome_size = engine->ga_pms.genome_size;
+    info->population_size = engine->gas[0]->population.size();
+    info->num_islands = engine->gas.size();
+    info->generation = engine->gas[0]->get_generation();
+}
+
+
+/**
+ * Copies the population of an island (0 for a single GA) to caller buffers.
+ * The genomes are stored row-wise (population_size x genome_size).
+ *
+ * @param[in] engine Engine handle
+ * @param[in] island Island index
+ * @param[out] genomes Buffer of population_size x genome_size values (or NULL)
+ * @param[out] fitness Buffer of population_size values (or NULL)
+ * @return The number of individuals copied (0 if island is out of range)
+ */
+size_t GAIM_C_NAME(gaim_get_population)(const gaim_engine_s *engine,
+                                        size_t island,
+                                        REAL_ *genomes,
+                                        REAL_ *fitness)
+{
+    if (island >= engine->gas.size()) {
+        return 0;
+    }
+    const std::vector<individual_s> &population = engine->gas[island]->population;
+    size_t genome_size = engine->ga_pms.genome_size;
+
+    for (size_t i = 0; i < population.size(); ++i) {
+        if (genomes) {
+            std::copy(population[i].genome.begin(), population[i].genome.end(),
+                      genomes + i * genome_size);
+        }
+        if (fitness) {
+            fitness[i] = population[i].fitness;
+        }
+    }
+    return population.size();
+}
+
+
+/**
+ * Replaces the genomes of the first n individuals of an island (0 for a
+ * single GA), e.g. to warm start a new optimization on a reused engine. The
+ * genomes are clipped and evaluated at the next step; until then their
+ * fitness is the lowest representable value. The island forgets its
+ * best-so-far individual and its records, which belong to the previous
+ * optimization.
+ *
+ * @param[in] engine Engine handle
+ * @param[in] island Island index
+ * @param[in] genomes Genomes stored row-wise (n x genome_size)
+ * @param[in] n Number of genomes (at most population_size)
+ * @return 0 on success, -1 if island or n is out of range
+ */
+int GAIM_C_NAME(gaim_set_population)(gaim_engine_s *engine,
+                                     size_t island,
+                                     const REAL_ *genomes,
+                                     size_t n)
+{
+    if (island >= engine->gas.size() ||
+        n > engine->gas[island]->population.size()) {
+        return -1;
+    }
+    GA *ga = engine->gas[island];
+    size_t genome_size = engine->ga_pms.genome_size;
+
+    for (size_t i = 0; i < n; ++i) {
+        ga->population[i].genome.assign(genomes + i * genome_size,
+                                        genomes + (i + 1) * genome_size);
+        ga->population[i].fitness = -std::numeric_limits<REAL_>::max();
+        ga->population[i].is_evaluated = false;
+    }
+    ga->clip_genome();
+    ga->clear_records();
+    return 0;
+}
+
+
+/**
+ * Returns the best-so-far individual over all the islands.
+ *
+ * @param[in] engine Engine handle
+ * @param[out] genome Buffer of genome_size values (or NULL)
+ * @return The best-so-far fitness (the lowest representable value before the
+ * first step)
+ */
+REAL_ GAIM_C_NAME(gaim_get_best)(const gaim_engine_s *engine, REAL_ *genome)
+{
+    const GA *best = nullptr;
+
+    for (auto ga : engine->gas) {
+        if (!ga->bsf_genome.empty() &&
+            (!best || ga->bsf_fitness > best->bsf_fitness)) {
+            best = ga;
+        }
+    }
+    if (!best) {
+        return -std::numeric_limits<REAL_>::max();
+    }
+    if (genome) {
+        std::copy(best->bsf_genome.begin(), best->bsf_genome.end(), genome);
+    }
+    return best->bsf_fitness;
+}
+
+
+/**
+ * Cancels the running gaim_step of an engine (called from another thread, a
+ * signal handler or a fitness function). The step returns after the current
+ * generation; the engine remains usable. If no step is running, the next one
+ * stops early.
+ *
+ * @param[in] engine Engine handle
+ * @return Nothing (void)
+ */
+void GAIM_C_NAME(gaim_cancel)(gaim_engine_s *engine)
+{
+    engine->cancel.cancel();
+}
+
+
+/**
+ * Releases an engine.
+ *
+ * @param[in] engine Engine handle (NULL is ignored)
+ * @return Nothing (void)
+ */
+void GAIM_C_NAME(gaim_destroy)(gaim_engine_s *engine)
+{
+    delete engine;
+}
+
+GAIM_END_NAMESPACE
@@ -25,6 +25,9 @@
 // $Log$
 #include "gaim.h"
 #include <numeric>
+#include <memory>
+
+GAIM_BEGIN_NAMESPACE
 
 
 /**
@@ -36,9 +39,15 @@
  * @param[in] ga_pms    A structure that contains all the parameters for the GA
  * @return Nothing
  */
-GA::GA(ga_parameter_s *ga_pms)
+GA::GA(const ga_parameter_s *ga_pms)
+    : recorder(ga_pms->record_policy,
+               ga_pms->record_interval,
+               ga_pms->record_capacity)
 {
-    REAL_ bound_val;
+    metrics = nullptr;
+    cancel_token = nullptr;
+    current_generation = 0;
+    bsf_fitness = -std::numeric_limits<REAL_>::max();
     // alpha and beta are vectors
     alpha = ga_pms->a;  // Lower bound for genes [a, b]
     beta = ga_pms->b;   // Upper bound for genes [a, b]
@@ -48,20 +57,18 @@ GA::GA(ga_parameter_s *ga_pms)
          (beta.size() != ga_pms->genome_size)) {
         std::cout << "Genome limits [a, b] size is not correct!" << std::endl;
         std::cout << "Size of a and b = genome size!" << std::endl;
-        exit(-1);
+        fatal_error();
     }
 
     // Initialize random number generator
     std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> genes(alpha[0], beta[0]);
 
     // Assign and validate mu values
     mu = ga_pms->population_size;   // Population size
     if (mu < 2) {
         std::cout << "Population size is smaller than 2!" << std::endl; 
         std::cout << "Impossible to have sexual reproduction!" << std::endl;
-        exit(-1);
+        fatal_error();
     }
     // Assign and validate lambda values
     lambda = ga_pms->num_offsprings;    // Number of offspring
@@ -69,11 +76,22 @@ GA::GA(ga_parameter_s *ga_pms)
     if (replace_perc > lambda) {
         std::cout << "Generation replacement dimension is larger than \
             offsprings population size!" << std::endl;
-        exit(-1);
+        fatal_error();
+    }
+    elitism = ga_pms->elitism;  // Number of protected individuals
+    if (elitism >= mu) {
+        std::cout << "Elitism must be smaller than the population size!" << std::endl;
+        fatal_error();
     }
     genome_size = ga_pms->genome_size;  // Genome size
+    generations = ga_pms->generations;  // Total number of generations
+
+    vrng_seed(&vrng, (static_cast<uint64_t>(rd()) << 32) | rd());
 
     fitness = sphere;  // Define the cost function (example -> sphere)
+    multi_fitness = sphere_objectives;  // Multi-objective example
+    batch_fitness = nullptr;
+    batch_data = nullptr;
 
     // Initialize selection method
     selection_method = ga_pms->sel_pms.selection_method;
@@ -100,86 +118,328 @@ GA::GA(ga_parameter_s *ga_pms)
 
     select_mutation_method();
 
-    // Initialize the population vector
-    for (size_t i = 0; i < mu; ++i) {
-        population.push_back(individual_s());
-        population[i].id = i;               // Unique ID
-        population[i].fitness = -10000;     // Fitness value
-        population[i].is_selected = false;
-        for (size_t j = 0; j < genome_size; ++j) {
-            population[i].genome.push_back(genes(gen)); // Genome
-            genes = std::uniform_real_distribution<>(alpha[j], beta[j]);
-        }
-    }
-    sorted_population = population; // Sort the population based on fitness
+    // Surrogate-assisted evaluation (optional)
+    init_surrogate(ga_pms);
 
-    // Initialize the offsprings vector
-    for (size_t i = 0; i < lambda; ++i) {
-        offsprings.push_back(individual_s());
-        offsprings[i].id = i;
-        offsprings[i].fitness = -10000;
-        for (size_t j = 0; j < genome_size; ++j) {
-            offsprings[i].genome.push_back(genes(gen)); 
-            genes = std::uniform_real_distribution<>(alpha[j], beta[j]);
-        }
-    }
+    // Time budget of the evaluations (optional)
+    init_timeout(ga_pms);
+
+    // Multi-objective mode (optional)
+    init_objectives(ga_pms);
+
+    // Initialize the population and the offsprings vectors
+    init_population(ga_pms);
 
     // initialize clamping values (clipping)
-    // corresponding file (see config file)
+    init_clipping(ga_pms);
+}
+
+
+/**
+ * Sets the clipping limits. With "universal" clipping every gene is clamped
+ * within [a[0], b[0]], with "individual" clipping gene j within
+ * [a[j], b[j]]; both are stored once per GA. With "file" clipping every
+ * individual has its own limits, read from clipping_fname (see
+ * read_clipping_file) and shared with the other GAs using the same file.
+ *
+ * @param[in] ga_pms    A structure that contains all the parameters for the GA
+ * @return Nothing (void)
+ */
+void GA::init_clipping(const ga_parameter_s *ga_pms)
+{
+    clipping_bounds.reset();
     if (ga_pms->clipping == "file") {
-        auto ifile = std::fstream(ga_pms->clipping_fname, std::ios::in);
-        if (!ifile) {
-            std::cout << "Unable to open file " << ga_pms->clipping_fname\
-                << std::endl;
-            exit(1);
-        }
-        
-        for (size_t i = 0; i < mu; ++i) {
-            for (size_t j = 0; j < ga_pms->genome_size; ++j) {
-                ifile >> bound_val;
-                population[i].lower_limit.push_back(bound_val);
-            }
-            for (size_t j = 0; j < ga_pms->genome_size; ++j) {
-                ifile >> bound_val;
-                population[i].upper_limit.push_back(bound_val);
-            }
-        }
+        clipping_bounds = read_clipping_file(ga_pms->clipping_fname, mu,
+                                             genome_size);
+        lower_limit.clear();
+        upper_limit.clear();
+        universal_clipping = false;
     } else if (ga_pms->clipping == "individual") {
-        for (size_t i = 0; i < mu; ++i) {
-            for (size_t j = 0; j < ga_pms->genome_size; ++j) {
-                population[i].lower_limit.push_back(alpha[j]);
-            }
-            for (size_t j = 0; j < ga_pms->genome_size; ++j) {
-                population[i].upper_limit.push_back(beta[j]);
-            }
-        }
+        lower_limit.assign(alpha.begin(), alpha.begin() + genome_size);
+        upper_limit.assign(beta.begin(), beta.begin() + genome_size);
+        universal_clipping = false;
     } else {
-        for (size_t i = 0; i < mu; ++i) {
-            for (size_t j = 0; j < ga_pms->genome_size; ++j) {
-                population[i].lower_limit.push_back(alpha[0]);
-            }
-            for (size_t j = 0; j < ga_pms->genome_size; ++j) {
-                population[i].upper_limit.push_back(beta[0]);
-            }
-        }
+        lower_limit.assign(genome_size, alpha[0]);
+        upper_limit.assign(genome_size, beta[0]);
+        universal_clipping = true;
+    }
+}
+
+
+/**
+ * Sets the surrogate model pre-screening the offspring (see
+ * ga_parameter_s::surrogate). Its archive starts empty.
+ *
+ * @param[in] ga_pms    A structure that contains all the parameters for the GA
+ * @return Nothing (void)
+ */
+void GA::init_surrogate(const ga_parameter_s *ga_pms)
+{
+    surrogate = SurrogateModel(ga_pms->surrogate,
+                               ga_pms->surrogate_k,
+                               ga_pms->surrogate_archive,
+                               ga_pms->a,
+                               ga_pms->b);
+    surrogate_fraction = ga_pms->surrogate_fraction;
+    if (surrogate.enabled() && (surrogate_fraction <= 0 || surrogate_fraction > 1)) {
+        std::cerr << "ERROR: The surrogate fraction must be in (0, 1]!" << std::endl;
+        fatal_error();
+    }
+}
+
+
+/**
+ * Sets the time budget of the fitness function calls (see
+ * ga_parameter_s::eval_timeout_ms) and the fitness of the evaluations that
+ * overrun it.
+ *
+ * @param[in] ga_pms    A structure that contains all the parameters for the GA
+ * @return Nothing (void)
+ */
+void GA::init_timeout(const ga_parameter_s *ga_pms)
+{
+    eval_timeout_ms = ga_pms->eval_timeout_ms;
+    timeout_penalty = ga_pms->timeout_penalty;
+}
+
+
+/**
+ * Sets the number of objectives. Above one objective the GA runs in
+ * multi-objective mode: the individuals are evaluated by multi_fitness (or
+ * batch_fitness, num_objectives costs per genome) only when their genome
+ * changes, ranked by non-domination and crowding, and the population and
+ * the offspring compete for survival (NSGA-II). The num_replacement and
+ * elitism parameters do not apply, and the surrogate is not supported.
+ *
+ * @param[in] ga_pms    A structure that contains all the parameters for the GA
+ * @return Nothing (void)
+ */
+void GA::init_objectives(const ga_parameter_s *ga_pms)
+{
+    num_objectives = ga_pms->num_objectives;
+    if (num_objectives < 1) {
+        std::cerr << "ERROR: The number of objectives must be positive!" << std::endl;
+        fatal_error();
+    }
+    if (num_objectives > 1 && surrogate.enabled()) {
+        std::cerr << "ERROR: The surrogate supports a single objective!" << std::endl;
+        fatal_error();
+    }
+}
+
+
+/**
+ * @brief Re-initializes the GA for a new problem, reusing its memory.
+ *
+ * When the shape of the problem (population size, number of offspring,
+ * genome size) is unchanged, the population is redrawn in place within the
+ * new limits, the operators are re-selected, and the records, counters and
+ * profile are cleared, so nothing is reallocated. Otherwise the GA is
+ * rebuilt from scratch. The fitness functions and the metrics slot are kept.
+ *
+ * @param[in] ga_pms    A structure that contains all the parameters for the GA
+ * @return Nothing (void)
+ */
+void GA::reset(const ga_parameter_s *ga_pms)
+{
+    if (ga_pms->population_size != mu || ga_pms->num_offsprings != lambda ||
+        ga_pms->genome_size != genome_size) {
+        REAL_ (*fitness_)(REAL_ *, size_t) = fitness;
+        void (*multi_fitness_)(REAL_ *, size_t, REAL_ *, size_t) = multi_fitness;
+        void (*batch_fitness_)(REAL_ *, size_t, size_t, REAL_ *, void *) = batch_fitness;
+        void *batch_data_ = batch_data;
+        island_metrics_s *metrics_ = metrics;
+        const CancelToken *cancel_token_ = cancel_token;
+
+        *this = GA(ga_pms);
+        fitness = fitness_;
+        multi_fitness = multi_fitness_;
+        batch_fitness = batch_fitness_;
+        batch_data = batch_data_;
+        metrics = metrics_;
+        cancel_token = cancel_token_;
+        return;
+    }
+
+    alpha = ga_pms->a;
+    beta = ga_pms->b;
+    if ((alpha.size() != genome_size) && (beta.size() != genome_size)) {
+        std::cout << "Genome limits [a, b] size is not correct!" << std::endl;
+        std::cout << "Size of a and b = genome size!" << std::endl;
+        fatal_error();
+    }
+    replace_perc = ga_pms->num_replacement;
+    if (replace_perc > lambda) {
+        std::cout << "Generation replacement dimension is larger than \
+            offsprings population size!" << std::endl;
+        fatal_error();
+    }
+    elitism = ga_pms->elitism;
+    if (elitism >= mu) {
+        std::cout << "Elitism must be smaller than the population size!" << std::endl;
+        fatal_error();
+    }
+    generations = ga_pms->generations;
+
+    // Operators
+    selection_method = ga_pms->sel_pms.selection_method;
+    bias = ga_pms->sel_pms.bias;
+    num_parents = ga_pms->sel_pms.num_parents;
+    lower_bound = ga_pms->sel_pms.lower_bound;
+    k = ga_pms->sel_pms.k;
+    replace = ga_pms->sel_pms.replace;
+    select_selection_method();
+    crossover_method = ga_pms->cross_pms.crossover_method;
+    select_crossover_method();
+    mutation_method = ga_pms->mut_pms.mutation_method;
+    mutation_rate = ga_pms->mut_pms.mutation_rate;
+    variance = ga_pms->mut_pms.variance;
+    low_bound = ga_pms->mut_pms.low_bound;
+    up_bound = ga_pms->mut_pms.up_bound;
+    order = ga_pms->mut_pms.order;
+    is_real = ga_pms->mut_pms.is_real;
+    select_mutation_method();
+    init_surrogate(ga_pms);
+    init_timeout(ga_pms);
+    init_objectives(ga_pms);
+
+    // Redraw the population and the offspring within the new limits
+    init_clipping(ga_pms);
+    init_population(ga_pms);
+
+    // Records and counters
+    recorder = RecordPolicy(ga_pms->record_policy,
+                            ga_pms->record_interval,
+                            ga_pms->record_capacity);
+    clear_records();
+    current_generation = 0;
+    stats = population_stats_s();
+    immigrant.clear();
+    profile = ga_profile_s();
+    arena.reset();
+}
+
+
+/**
+ * Forgets the best-so-far individual and the records (BSF, average, highest
+ * and lowest fitness), e.g. when the population is replaced by the one of
+ * another optimization.
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void GA::clear_records(void)
+{
+    recorder.clear();
+    bsf.clear();
+    fit_avg.clear();
+    hfi.clear();
+    lfi.clear();
+    bsf_genome.clear();
+    bsf_fitness = -std::numeric_limits<REAL_>::max();
+}
+
+
+/// Deadline of the fitness function call running on this thread (see
+/// gaim_evaluation_expired) and the budget of each of its genomes
+static thread_local std::chrono::steady_clock::time_point evaluation_deadline;
+static thread_local size_t evaluation_budget = 0;
+static thread_local bool evaluation_timed = false;
+
+
+/**
+ * Starts the time budget of a fitness function call on this thread.
+ *
+ * @param[in] budget_ms Time budget of a genome in milliseconds (0 disables it)
+ * @param[in] n Number of genomes evaluated by the call
+ * @return Nothing (void)
+ */
+static void start_evaluation_budget(size_t budget_ms, size_t n=1)
+{
+    evaluation_timed = (budget_ms > 0);
+    evaluation_budget = budget_ms;
+    if (evaluation_timed) {
+        evaluation_deadline = std::chrono::steady_clock::now() +
+                              std::chrono::milliseconds(budget_ms * n);
+    }
+}
+
+
+/**
+ * Ends the time budget of a fitness function call on this thread.
+ *
+ * @return True if the call overran its budget
+ */
+static bool stop_evaluation_budget(void)
+{
+    bool expired = evaluation_timed &&
+                   std::chrono::steady_clock::now() > evaluation_deadline;
+    evaluation_timed = false;
+    evaluation_budget = 0;
+    return expired;
+}
+
+
+/**
+ * Checks the time budget of the running fitness function call (see
+ * ga_parameter_s::eval_timeout_ms). A cooperative fitness function polls it
+ * and returns early once it is expired; its result is discarded anyway.
+ *
+ * @return 1 if the budget of the call is exhausted, 0 otherwise (or if the
+ * call has no budget)
+ */
+int GAIM_C_NAME(gaim_evaluation_expired)(void)
+{
+    return evaluation_timed &&
+           std::chrono::steady_clock::now() > evaluation_deadline;
+}
+
+
+/**
+ * Returns the time left to the running fitness function call, e.g. to bound
+ * the wait for a result computed by a worker process.
+ *
+ * @return The remaining time in milliseconds (0 once expired), or -1 if the
+ * call has no budget
+ */
+double GAIM_C_NAME(gaim_evaluation_remaining_ms)(void)
+{
+    if (!evaluation_timed) {
+        return -1;
     }
+    std::chrono::duration<double, std::milli> left =
+        evaluation_deadline - std::chrono::steady_clock::now();
+    return std::max(left.count(), 0.0);
 }
 
 
 /**
- * @brief Destructor of GA class
+ * Returns the time budget of a single genome of the running fitness function
+ * call. A batch function (see GA::batch_fitness) gives that budget to each
+ * of its genomes, e.g. ProcessEvaluator kills the workers that overrun it.
+ *
+ * @return The budget of a genome in milliseconds, or -1 if the call has no
+ * budget
  */
-GA::~GA()
+double GAIM_C_NAME(gaim_evaluation_budget_ms)(void)
 {
-    population.clear();
-    offsprings.clear();
-    sorted_population.clear();
+    return evaluation_timed ? static_cast<double>(evaluation_budget) : -1;
 }
 
 
 /**
  * Evaluates the fitness of each individual based on a predefined cost
- * function. 
+ * function. If a batch fitness function is set, the genomes are packed
+ * (see pack_genomes) and evaluated with a single call.
+ *
+ * With a time budget (eval_timeout_ms), the evaluation of a genome that
+ * overruns it gets timeout_penalty, whatever the function returns. A call
+ * cannot be interrupted, so a function that may hang must poll
+ * gaim_evaluation_expired (or bound the wait for its worker processes with
+ * gaim_evaluation_remaining_ms). A batch call has the budget of all its
+ * genomes, and its costs start as timeout_penalty: the function reports the
+ * genomes that overrun their own budget (gaim_evaluation_budget_ms) by
+ * leaving their costs untouched, and the finished ones keep their costs.
  *
  * @param[in] x Vector of individuals (population)
  * @return Nothing (void)
@@ -188,8 +448,90 @@ GA::~GA()
  */
 void GA::evaluation(std::vector<individual_s> &x)
 {
+    size_t timeouts = 0;
+    size_t m = num_objectives;
+    GAIM_PROFILE_START(t);
+    if (batch_fitness) {
+        pack_genomes(x);
+        batch_costs.resize(x.size() * m);
+        if (eval_timeout_ms) {
+            std::fill(batch_costs.begin(), batch_costs.end(), timeout_penalty);
+        }
+        start_evaluation_budget(eval_timeout_ms, x.size());
+        batch_fitness(&genome_matrix[0], x.size(), genome_size,
+                      &batch_costs[0], batch_data);
+        stop_evaluation_budget();
+        for (size_t i = 0; i < x.size(); ++i) {
+            // Genomes left unfinished by the batch function
+            if (eval_timeout_ms &&
+                std::count(batch_costs.begin() + i * m,
+                           batch_costs.begin() + (i + 1) * m,
+                           timeout_penalty) == static_cast<std::ptrdiff_t>(m)) {
+                ++timeouts;
+            }
+            if (m > 1) {
+                x[i].objectives.assign(batch_costs.begin() + i * m,
+                                       batch_costs.begin() + (i + 1) * m);
+            } else {
+                x[i].fitness = batch_costs[i];
+            }
+        }
+    } else if (m > 1) {
+        for (size_t i = 0; i < x.size(); ++i) {
+            x[i].objectives.resize(m);
+            start_evaluation_budget(eval_timeout_ms);
+            multi_fitness(&x[i].genome[0], x[i].genome.size(),
+                          &x[i].objectives[0], m);
+            if (stop_evaluation_budget()) {
+                std::fill(x[i].objectives.begin(), x[i].objectives.end(),
+                          timeout_penalty);
+                ++timeouts;
+            }
+        }
+    } else {
+        for (size_t i = 0; i < x.size(); ++i) {
+            start_evaluation_budget(eval_timeout_ms);
+            x[i].fitness = fitness(&x[i].genome[0], x[i].genome.size());
+            if (stop_evaluation_budget()) {
+                x[i].fitness = timeout_penalty;
+                ++timeouts;
+            }
+        }
+    }
+    for (auto &ind : x) {
+        ind.is_evaluated = true;
+        // Timed out genomes would mislead the surrogate
+        if (surrogate.enabled() && !(timeouts && ind.fitness == timeout_penalty)) {
+            surrogate.add(&ind.genome[0], ind.fitness);
+        }
+    }
+    GAIM_PROFILE_STOP(profile, t, evaluation_ns);
+    GAIM_PROFILE_COUNT(profile, evaluations, x.size());
+    GAIM_PROFILE_COUNT(profile, timeouts, timeouts);
+    if (metrics) {
+        metrics->evaluations.fetch_add(x.size(), std::memory_order_relaxed);
+        if (timeouts) {
+            metrics->timeouts.fetch_add(timeouts, std::memory_order_relaxed);
+        }
+    }
+}
+
+
+/**
+ * Packs the genomes of a vector of individuals row-wise into genome_matrix
+ * (one row per individual). The buffer is owned by the GA and reused, so a
+ * batch fitness function sees all the genomes as a single n x genome_size
+ * matrix.
+ *
+ * @param[in] x Vector of individuals
+ * @return Nothing (void)
+ */
+void GA::pack_genomes(const std::vector<individual_s> &x)
+{
+    genome_matrix.resize(x.size() * genome_size);
     for (size_t i = 0; i < x.size(); ++i) {
-        x[i].fitness = fitness(&x[i].genome[0], x[i].genome.size());
+        std::copy(x[i].genome.begin(), x[i].genome.end(),
+                  genome_matrix.begin() + i * genome_size);
     }
 }
 
@@ -202,10 +544,12 @@ void GA::evaluation(std::vector<individual_s> &x)
  */
 void GA::sort_population(void)
 {
+    GAIM_PROFILE_START(t);
     sorted_population = population;
     std::sort(sorted_population.begin(),
               sorted_population.end(),
               compare_fitness);
+    GAIM_PROFILE_STOP(profile, t, sorting_ns);
 }
 
 
@@ -213,7 +557,9 @@ void GA::sort_population(void)
  * The basic operation for forming the next generation. It determines which 
  * offspring individuals will pass their genomes to the next generation and 
  * which parents will be replaced. By default, it replaces the worst parents
- * by the best offspring. 
+ * by the best offspring. The elitism best individuals are never replaced.
+ * Only the worst parents and the best offspring are partitioned
+ * (nth_element), the populations are not sorted.
  *
  * @param[in] perc The percentage of old individuals that will be replaced by
  * new individuals.
@@ -223,17 +569,29 @@ void GA::sort_population(void)
  */
 void GA::next_generation(size_t perc=3)
 {
-    std::sort(population.begin(), population.end(), compare_fitness);
-    std::sort(offsprings.begin(), offsprings.end(), compare_fitness);
+    GAIM_PROFILE_START(t);
     if (perc > lambda) {
         std::cout << "Percentage of offspring is larger than the\
             available number of offspring!" << std::endl;
-        exit(-1);
+        fatal_error();
+    }
+    perc = std::min(perc, mu - elitism);
+    if (perc > 0) {
+        std::nth_element(population.begin(),
+                         population.begin() + (perc - 1),
+                         population.end(),
+                         compare_fitness);
+        std::nth_element(offsprings.begin(),
+                         offsprings.end() - perc,
+                         offsprings.end(),
+                         compare_fitness);
     }
     for (size_t i = 0, j = lambda-1; i < perc; ++i, --j) {
         population[i].genome = offsprings[j].genome;
         population[i].fitness = offsprings[j].fitness;
+        population[i].is_evaluated = offsprings[j].is_evaluated;
     }
+    GAIM_PROFILE_STOP(profile, t, replacement_ns);
 }
 
 
@@ -259,24 +617,42 @@ void GA::reset_selection_flags()
 
 /**
  * Clips the value of genes indipendently based on predermined lower and upper
- * boundaries.
+ * boundaries (see init_clipping). Limits shared by all the genes are
+ * broadcast, so only the genomes are streamed from memory.
  *
  * @param[in] (void)
  * @return Nothing (void)
- *
- * @warning This methods has to be called only when the lower and upper
- * boundaries (limits) for every individual's genome have been initialized
- * properly.
  */
 void GA::clip_genome()
 {
-    // Alternative we could use replace_if
-    for (auto &ind : population) {
-        for (size_t i = 0; i < ind.genome.size(); ++i) {
-            if (ind.genome[i] > ind.upper_limit[i]) { ind.genome[i] = ind.upper_limit[i];}
-            if (ind.genome[i] < ind.lower_limit[i]) { ind.genome[i] = ind.lower_limit[i];}
+    GAIM_PROFILE_START(t);
+    if (surrogate.enabled() || num_objectives > 1) {
+        // A clipped genome loses its fitness (evaluate_stale)
+        for (size_t i = 0; i < population.size(); ++i) {
+            const REAL_ *lower = get_lower_limit(i), *upper = get_upper_limit(i);
+            const std::vector<REAL_> &g = population[i].genome;
+            for (size_t j = 0; j < g.size(); ++j) {
+                if (g[j] < lower[j] || g[j] > upper[j]) {
+                    population[i].is_evaluated = false;
+                    break;
+                }
+            }
         }
     }
+    if (universal_clipping) {
+        for (auto &ind : population) {
+            simd_clip_uniform(&ind.genome[0], lower_limit[0], upper_limit[0],
+                              ind.genome.size());
+        }
+    } else {
+        for (size_t i = 0; i < population.size(); ++i) {
+            simd_clip(&population[i].genome[0],
+                      get_lower_limit(i),
+                      get_upper_limit(i),
+                      population[i].genome.size());
+        }
+    }
+    GAIM_PROFILE_STOP(profile, t, clipping_ns);
 }
 
 
@@ -302,32 +678,42 @@ void GA::run_one_generation(void)
 
     // Iteration index
     static size_t iter_index = 0;
+    // Evaluate fitness of each individual (with a surrogate or several
+    // objectives, only the new and the changed ones)
+    if (surrogate.enabled() || num_objectives > 1) {
+        evaluate_stale(population);
+    } else {
+        evaluation(population);
+    }
 
-    // Evaluate fitness of each individual
-    evaluation(population);
+    // Several objectives: the fitness is the rank by non-domination and
+    // crowding
+    if (num_objectives > 1) {
+        rank_population();
+    }
 
-    // Sort the entire population based on fitness
-    sort_population();
+    // Fitness statistics (single pass, no sorting)
+    update_statistics();
 
-    // Bookkeeping
-    best_individual = sorted_population[sorted_population.size()-1];
-    hfi.push_back(best_individual.fitness);   // Best fitness
-    bsf_genome = best_individual.genome;  // Best so far genome
-    lfi.push_back(sorted_population[0].fitness);    // Lowest fitness
-
-    // Average fitness across population
-    REAL_ acc = std::accumulate(population.begin(),
-                                population.end(),
-                                0,
-                                average_fitness);
-    fit_avg.push_back(acc / static_cast<REAL_>(mu));
-    
-    bsf.push_back(best_individual.fitness);
+    // Elitism: the archived best-so-far individual is never lost
+    if (elitism && num_objectives == 1) {
+        restore_elite();
+    }
+
+    // Bookkeeping: best so far genome (archived outside the population,
+    // copied only when it improves)
+    if (stats.max > bsf_fitness) {
+        bsf_genome = population[stats.argmax].genome;
+        bsf_fitness = stats.max;
+    }
+
+    record_statistics(stats.max, stats.min, stats.mean);
 
     // Generate new offspring
     for(size_t i = 0; i < lambda-1; ++i) {
         // Parents selection
         // parents = selection(2, 2, false);
+        GAIM_PROFILE_START(t_sel);
         parents = (this->*selection)(population);
         parent1 = parents[0];
         parent2 = parents[1];
@@ -338,37 +724,180 @@ void GA::run_one_generation(void)
         // This has to be placed outside the loop in case the selection method
         // is placed outside the loop
         reset_selection_flags();
+        GAIM_PROFILE_STOP(profile, t_sel, selection_ns);
 
         // Crossover
+        GAIM_PROFILE_START(t_cross);
         child = (this->*crossover)(parent1.genome, parent2.genome);
         // child = order_one_crossover(parent1.genome, parent2.genome);
+        GAIM_PROFILE_STOP(profile, t_cross, crossover_ns);
 
         // Mutation
+        GAIM_PROFILE_START(t_mut);
         child = (this->*mutation)(child);
+        GAIM_PROFILE_STOP(profile, t_mut, mutation_ns);
 
         // Append the offspring genome list
         offsprings[i].genome = child;
+        offsprings[i].is_evaluated = false;
+    }
+    // Evaluate offspring fitness (with a surrogate, only the most promising)
+    if (surrogate.enabled()) {
+        screen_offsprings();
+    } else {
+        evaluation(offsprings);
     }
-    // Evaluate offspring fitness
-    evaluation(offsprings);
 
-    // Integrate offspring in the initial population
-    next_generation(replace_perc);
+    // Integrate offspring in the initial population (with several
+    // objectives, the best of both survive)
+    if (num_objectives > 1) {
+        survival_selection();
+    } else {
+        next_generation(replace_perc);
+    }
     
     // Clip genome
     clip_genome();
     
     // Increase iteration index
     iter_index++;
+    GAIM_PROFILE_COUNT(profile, generations, 1);
+    GAIM_PROFILE_COUNT(profile, allocations, arena.get_stats().allocations);
+
+    // Live metrics
+    if (metrics) {
+        publish_metrics();
+    }
+
+    // Release the temporary buffers of this generation
+    arena.reset();
 }
 #endif
 
+
+/**
+ * Appends the statistics of the current generation to the records (BSF,
+ * average, highest and lowest fitness) if the recording policy says so (see
+ * RecordPolicy::record).
+ *
+ * @param[in] best Best fitness of the current generation
+ * @param[in] lowest Lowest fitness of the current generation
+ * @param[in] average Average fitness of the current generation
+ * @return Nothing (void)
+ */
+void GA::record_statistics(REAL_ best, REAL_ lowest, REAL_ average)
+{
+    recorder.record(current_generation, bsf_fitness,
+                    {{&bsf, bsf_fitness},   // Best so far fitness
+                     {&hfi, best},          // Highest fitness of the generation
+                     {&lfi, lowest},        // Lowest fitness
+                     {&fit_avg, average}});
+}
+
+
+/**
+ * Re-inserts the archived best-so-far individual in place of the worst
+ * individual, if the best individual of the (evaluated) population is worse
+ * than it. This happens when the population loses its best individual, for
+ * instance when immigrants replace the elite of an island. It relies on the
+ * statistics of the current generation, so no sorting is involved.
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void GA::restore_elite(void)
+{
+    if (stats.max >= bsf_fitness) {
+        return;
+    }
+    population[stats.argmin].genome = bsf_genome;
+    population[stats.argmin].fitness = bsf_fitness;
+    population[stats.argmin].is_evaluated = true;
+    update_statistics();
+}
+
+
+/**
+ * Computes the fitness statistics of the population once per generation (see
+ * population_statistics). Elitism, logging, live metrics and migration use
+ * them instead of scanning or sorting the population again (argmax is the
+ * index of the best individual of the generation).
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void GA::update_statistics(void)
+{
+    stats = population_statistics(population);
+}
+
+
+/**
+ * Publishes the current state of the GA to its live metrics slot (see
+ * MetricsExporter). The stores are relaxed, so the GA never synchronizes with
+ * the exporter thread. The diversity (mean standard deviation of the genes
+ * across the population) is computed only when the exporter requests it.
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void GA::publish_metrics(void)
+{
+    metrics->generation.store(current_generation + 1, std::memory_order_relaxed);
+    metrics->bsf.store(bsf_fitness, std::memory_order_relaxed);
+    metrics->average_fitness.store(stats.mean, std::memory_order_relaxed);
+
+    if (metrics->diversity_requested.load(std::memory_order_relaxed)) {
+        size_t genome_size = population[0].genome.size();
+        arena_vector<REAL_> mean(genome_size, 0, arena_allocator<REAL_>(&arena));
+        arena_vector<REAL_> sq(genome_size, 0, arena_allocator<REAL_>(&arena));
+        REAL_ std_sum = 0;
+
+        for (size_t i = 0; i < mu; ++i) {
+            for (size_t j = 0; j < genome_size; ++j) {
+                mean[j] += population[i].genome[j];
+                sq[j] += population[i].genome[j] * population[i].genome[j];
+            }
+        }
+        for (size_t j = 0; j < genome_size; ++j) {
+            mean[j] /= static_cast<REAL_>(mu);
+            REAL_ var = sq[j] / static_cast<REAL_>(mu) - mean[j] * mean[j];
+            std_sum += std::sqrt(std::max<REAL_>(var, 0));
+        }
+        metrics->diversity.store(std_sum / static_cast<REAL_>(genome_size),
+                                 std::memory_order_relaxed);
+        metrics->diversity_requested.store(false, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Runs a number of generations, continuing the generation count of the
+ * previous calls. Unlike evolve, it neither logs nor exports metrics, so the
+ * population can be inspected or modified between the calls.
+ * A cancelled cancel_token stops it before the next generation.
+ *
+ * @param[in] generations Number of generations to run
+ * @return Nothing (void)
+ */
+void GA::step(size_t generations)
+{
+    for (size_t i = 0; i < generations; ++i) {
+        if (cancel_token && cancel_token->is_cancelled()) {
+            break;
+        }
+        run_one_generation();
+        ++current_generation;
+    }
+}
+
+
 /**
  *  @brief Evolves a population based on previously defined operators.
  *
  *  Evolves a population of individuals based on operations such as selection,
  *  crossover, and mutation that have been predefined. It executes the  
- *  evolutionary step over the total number of generations. 
+ *  evolutionary step over the total number of generations (fewer if the
+ *  cancel_token is cancelled). 
  *  Finally, it prints out results either to STDOUT or to file.
  *
  * @param[in] generations   Total number of generations
@@ -380,17 +909,41 @@ void GA::run_one_generation(void)
  */
 void GA::evolve(size_t generations,
                 size_t unique_id,
-                pr_parameter_s *pms)
+                const pr_parameter_s *pms)
 {
 #ifdef TIME
     auto start = std::chrono::high_resolution_clock::now();
 #endif
+    // A standalone GA exports its own live metrics (if requested)
+    std::unique_ptr<MetricsExporter> exporter;
+    if (!metrics && !pms->metrics_target.empty()) {
+        exporter.reset(new MetricsExporter(pms->metrics_target,
+                                           pms->metrics_period_ms,
+                                           1,
+                                           pms->experiment_name));
+        metrics = exporter->slot(0);
+        exporter->start();
+    }
+
     current_generation = 0;
     for(size_t i = 0; i < generations; ++i) {
+        if (cancel_token && cancel_token->is_cancelled()) {
+            break;
+        }
         run_one_generation();
         ++current_generation;
+#ifdef GAIM_PROFILE
+        if (pms->profile_interval &&
+            !(current_generation % pms->profile_interval)) {
+            print_profile(profile, current_generation, unique_id, pms->where2write);
+        }
+#endif
     }
     sort_population();
+    if (exporter) {
+        exporter->stop();
+        metrics = nullptr;
+    }
 #ifdef TIME
     auto end = std::chrono::high_resolution_clock::now();
     auto taken = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
@@ -407,6 +960,8 @@ void GA::evolve(size_t generations,
         print_bsf(bsf, unique_id, pms->where2write);
     } 
     if (pms->print_best_genome) {
-        print_best_genome(best_individual.genome, unique_id, pms->where2write);
+        print_best_genome(bsf_genome, unique_id, pms->where2write);
     }
 }
+
+GAIM_END_NAMESPACE
@@ -0,0 +1,343 @@
+/* Population initialization cpp file for GAIM software
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file initialization.cpp
+ * Implements the initialization of the population: uniform random genomes,
+ * Latin hypercube sampling, and (randomized) Sobol sequences. Large
+ * populations are filled in parallel, in chunks that draw from their own RNG
+ * streams, so the initial population does not depend on the number of
+ * threads.
+ */
+// $Log$
+#include "gaim.h"
+#include <atomic>
+
+GAIM_BEGIN_NAMESPACE
+
+/// Number of genes below which the population is initialized by one thread
+static const size_t parallel_init_genes = 1 << 18;
+/// Individuals (or genes for the Latin hypercube) per initialization chunk
+static const size_t init_chunk_size = 256;
+/// Bits of the Sobol points
+static const int sobol_bits = 32;
+
+
+/**
+ * Runs f(c) for every chunk c in [0, num_chunks). If the work is large
+ * enough, the chunks are shared by the hardware threads.
+ *
+ * @param[in] num_chunks Number of chunks
+ * @param[in] genes Total number of genes to initialize
+ * @param[in] f Function to run on each chunk
+ * @return Nothing (void)
+ */
+template <class F>
+static void for_each_chunk(size_t num_chunks, size_t genes, F f)
+{
+    size_t num_threads = std::min<size_t>(std::thread::hardware_concurrency(),
+                                          num_chunks);
+    if (genes < parallel_init_genes || num_threads < 2) {
+        for (size_t c = 0; c < num_chunks; ++c) {
+            f(c);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&]() {
+            for (size_t c = next++; c < num_chunks; c = next++) {
+                f(c);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+}
+
+
+/**
+ * Multiplies two polynomials over GF(2) modulo the polynomial p of degree d.
+ */
+static uint64_t gf2_mulmod(uint64_t a, uint64_t b, uint64_t p, int d)
+{
+    uint64_t r = 0;
+    while (b) {
+        if (b & 1) { r ^= a; }
+        b >>= 1;
+        a <<= 1;
+        if (a >> d) { a ^= p; }
+    }
+    return r;
+}
+
+
+/**
+ * Raises x to the power e modulo the polynomial p of degree d over GF(2).
+ */
+static uint64_t gf2_powmod_x(uint64_t e, uint64_t p, int d)
+{
+    uint64_t r = 1, base = (d > 1) ? 2 : (2 ^ p);
+    while (e) {
+        if (e & 1) { r = gf2_mulmod(r, base, p, d); }
+        base = gf2_mulmod(base, base, p, d);
+        e >>= 1;
+    }
+    return r;
+}
+
+
+/**
+ * Checks if the polynomial p of degree d is primitive over GF(2), i.e., x
+ * has order 2^d - 1 modulo p.
+ */
+static bool is_primitive(uint64_t p, int d)
+{
+    uint64_t order = (1ULL << d) - 1, n = order;
+
+    if (!(p & 1) || gf2_powmod_x(order, p, d) != 1) {
+        return false;
+    }
+    for (uint64_t q = 2; q * q <= n; ++q) {
+        if (n % q) { continue; }
+        while (!(n % q)) { n /= q; }
+        if (gf2_powmod_x(order / q, p, d) == 1) { return false; }
+    }
+    if (n > 1 && n != order && gf2_powmod_x(order / n, p, d) == 1) {
+        return false;
+    }
+    return true;
+}
+
+
+/**
+ * Returns (at least) n primitive polynomials over GF(2), in increasing degree.
+ * A polynomial is stored as its coefficients bits (bit d is x^d).
+ */
+static std::vector<uint64_t> primitive_polynomials(size_t n)
+{
+    static std::mutex mtx;
+    static std::vector<uint64_t> polys;
+    static int degree = 0;
+
+    std::lock_guard<std::mutex> lock(mtx);
+    while (polys.size() < n && degree < sobol_bits) {
+        ++degree;
+        for (uint64_t p = (1ULL << degree) | 1; p < (2ULL << degree); p += 2) {
+            if (is_primitive(p, degree)) {
+                polys.push_back(p);
+            }
+        }
+    }
+    if (polys.size() < n) {
+        std::cerr << "ERROR: Too many genes for the Sobol initialization!" << std::endl;
+        fatal_error();
+    }
+    return polys;
+}
+
+
+/**
+ * Computes the direction numbers of a randomized Sobol sequence. Dimension 0
+ * is the van der Corput sequence; dimension j > 0 uses the j-th primitive
+ * polynomial with random odd initial numbers m_k < 2^k.
+ *
+ * @param[in] dims Number of dimensions (genes)
+ * @param[in] rng RNG state drawing the initial numbers
+ * @return dims x sobol_bits direction numbers
+ */
+static std::vector<uint32_t> sobol_directions(size_t dims, vrng_s *rng)
+{
+    std::vector<uint32_t> v(dims * sobol_bits);
+    std::vector<uint64_t> polys = primitive_polynomials(dims ? dims - 1 : 0);
+    std::vector<uint64_t> m(sobol_bits + 1);
+
+    for (int k = 0; k < sobol_bits; ++k) {
+        v[k] = 1u << (sobol_bits - 1 - k);
+    }
+    for (size_t j = 1; j < dims; ++j) {
+        uint64_t p = polys[j - 1];
+        int s = 0;
+        while (p >> (s + 1)) { ++s; }
+
+        for (int k = 1; k <= s && k <= sobol_bits; ++k) {
+            m[k] = (vrng_bounded(rng, 1u << (k - 1)) << 1) | 1;
+        }
+        for (int k = s + 1; k <= sobol_bits; ++k) {
+            m[k] = m[k - s] ^ (m[k - s] << s);
+            for (int i = 1; i < s; ++i) {
+                if ((p >> (s - i)) & 1) {
+                    m[k] ^= m[k - i] << i;
+                }
+            }
+        }
+        for (int k = 1; k <= sobol_bits; ++k) {
+            v[j * sobol_bits + k - 1] = static_cast<uint32_t>(m[k] << (sobol_bits - k));
+        }
+    }
+    return v;
+}
+
+
+/**
+ * Initializes the genomes of the population (and allocates the offspring)
+ * with the initialization method of the parameters:
+ * @li uniform  Every gene is drawn uniformly from [a_j, b_j] (default)
+ * @li lhs      Latin hypercube sampling: for every gene, each of the
+ *              population_size strata of [a_j, b_j] holds exactly one
+ *              individual
+ * @li sobol    Points of a Sobol low-discrepancy sequence, randomized by
+ *              random direction numbers and a random digital shift (for a
+ *              population of 2^m individuals every gene is stratified as
+ *              in lhs)
+ *
+ * The storage is allocated upfront and large populations are filled by all
+ * the hardware threads, each chunk drawing from its own RNG stream (seeded
+ * from the GA's RNG).
+ *
+ * Finally, the seed genomes (seed_genomes followed by the genomes of
+ * seed_fname) replace the first individuals (warm start). Extra seeds are
+ * ignored.
+ *
+ * @param[in] ga_pms    A structure that contains all the parameters for the GA
+ * @return Nothing (void)
+ */
+void GA::init_population(const ga_parameter_s *ga_pms)
+{
+    const std::string &method = ga_pms->init_method;
+    size_t num_chunks = (mu + init_chunk_size - 1) / init_chunk_size;
+    size_t genes = mu * genome_size;
+    uint64_t seed = (static_cast<uint64_t>(vrng_bounded(&vrng, 0xffffffffu)) << 32) |
+                    vrng_bounded(&vrng, 0xffffffffu);
+
+    if (method != "uniform" && method != "lhs" && method != "sobol") {
+        std::cerr << "ERROR: No such initialization method exists!" << std::endl;
+        fatal_error();
+    }
+
+    population.resize(mu);
+    for_each_chunk(num_chunks, genes, [&](size_t c) {
+        vrng_s rng;
+        vrng_seed(&rng, seed + 0x9e3779b97f4a7c15ULL * (c + 1));
+        for (size_t i = c * init_chunk_size; i < std::min(mu, (c + 1) * init_chunk_size); ++i) {
+            individual_s &ind = population[i];
+            ind.id = i;
+            ind.fitness = -10000;
+            ind.is_selected = false;
+            ind.is_evaluated = false;
+            ind.genome.resize(genome_size);
+            if (method == "uniform") {
+                for (size_t j = 0; j < genome_size; ++j) {
+                    ind.genome[j] = alpha[j] + (beta[j] - alpha[j]) * vrng_real(&rng);
+                }
+            }
+        }
+    });
+
+    if (method == "lhs") {
+        // One random permutation of the strata per gene
+        size_t gene_chunks = (genome_size + init_chunk_size - 1) / init_chunk_size;
+        for_each_chunk(gene_chunks, genes, [&](size_t c) {
+            vrng_s rng;
+            std::vector<uint32_t> strata(mu);
+            vrng_seed(&rng, ~seed + 0x9e3779b97f4a7c15ULL * (c + 1));
+            for (size_t j = c * init_chunk_size;
+                 j < std::min(genome_size, (c + 1) * init_chunk_size); ++j) {
+                REAL_ width = (beta[j] - alpha[j]) / static_cast<REAL_>(mu);
+                for (size_t i = 0; i < mu; ++i) {
+                    strata[i] = i;
+                }
+                for (size_t i = mu - 1; i > 0; --i) {
+                    std::swap(strata[i], strata[vrng_bounded(&rng, i + 1)]);
+                }
+                for (size_t i = 0; i < mu; ++i) {
+                    population[i].genome[j] = alpha[j] +
+                        (static_cast<REAL_>(strata[i]) + vrng_real(&rng)) * width;
+                }
+            }
+        });
+    } else if (method == "sobol") {
+        std::vector<uint32_t> v = sobol_directions(genome_size, &vrng);
+        std::vector<uint32_t> shift(genome_size);
+        for (auto &s : shift) {
+            s = vrng_bounded(&vrng, 0xffffffffu);
+        }
+        for_each_chunk(num_chunks, genes, [&](size_t c) {
+            size_t first = c * init_chunk_size;
+            size_t last = std::min(mu, (c + 1) * init_chunk_size);
+            std::vector<uint32_t> x(genome_size, 0);
+            // Point first from its Gray code, the next ones incrementally
+            uint64_t gray = first ^ (first >> 1);
+            for (int k = 0; k < sobol_bits && gray; ++k, gray >>= 1) {
+                if (gray & 1) {
+                    for (size_t j = 0; j < genome_size; ++j) {
+                        x[j] ^= v[j * sobol_bits + k];
+                    }
+                }
+            }
+            for (size_t i = first; i < last; ++i) {
+                if (i > first) {
+                    int k = 0;
+                    for (size_t n = i - 1; n & 1; n >>= 1) { ++k; }
+                    for (size_t j = 0; j < genome_size; ++j) {
+                        x[j] ^= v[j * sobol_bits + k];
+                    }
+                }
+                for (size_t j = 0; j < genome_size; ++j) {
+                    double u = static_cast<double>(x[j] ^ shift[j]) / 4294967296.0;
+                    population[i].genome[j] = alpha[j] +
+                        (beta[j] - alpha[j]) * static_cast<REAL_>(u);
+                }
+            }
+        });
+    }
+
+    // Warm start: the seed genomes replace the first individuals
+    std::vector<REAL_> seeds(ga_pms->seed_genomes);
+    if (!ga_pms->seed_fname.empty()) {
+        std::vector<REAL_> file_seeds = read_seed_genomes(ga_pms->seed_fname, genome_size);
+        seeds.insert(seeds.end(), file_seeds.begin(), file_seeds.end());
+    }
+    if (seeds.size() % genome_size) {
+        std::cerr << "ERROR: The seed genomes must have genome_size genes!" << std::endl;
+        fatal_error();
+    }
+    for (size_t i = 0; i < std::min(mu, seeds.size() / genome_size); ++i) {
+        std::copy(seeds.begin() + i * genome_size, seeds.begin() + (i + 1) * genome_size,
+                  population[i].genome.begin());
+    }
+
+    // The offspring are overwritten by the crossover
+    offsprings.resize(lambda);
+    for (size_t i = 0; i < lambda; ++i) {
+        offsprings[i].id = i;
+        offsprings[i].fitness = -10000;
+        offsprings[i].is_evaluated = false;
+        offsprings[i].genome.resize(genome_size);
+        for (size_t j = 0; j < genome_size; ++j) {
+            offsprings[i].genome[j] = alpha[j] + (beta[j] - alpha[j]) * vrng_real(&vrng);
+        }
+    }
+    sorted_population = population;
+}
+
+GAIM_END_NAMESPACE
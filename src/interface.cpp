@@ -25,7 +25,8 @@
 // $Log$
 #include "gaim.h"
 
-extern "C"
+GAIM_BEGIN_NAMESPACE
+
 /**
  * @brief Interface function for calling GAIM from within any other C/C++ 
  * source code of software (libgaim).
@@ -102,6 +103,8 @@ extern "C"
  * @param[in] log_bsf Enable/disable the track of Best So far Fitness (BSF)
  * fitness. 
  * @param[in] log_best_genome Enable/disable the track of the best genome
+ * @param[in] log_parameters Enable/disable printing the parameters (and the
+ * type of optimization) before the optimization starts
  *
  * @return res A ga_results_s data structure that contains the average
  * fitness, the BSF, and the best genome found from the GA.
@@ -144,17 +147,13 @@ ga_results_s ga_optimization(REAL_ (*func)(REAL_ *, size_t),
                              bool log_fitness,
                              bool log_average_fitness,
                              bool log_bsf,
-                             bool log_best_genome) {
+                             bool log_best_genome,
+                             bool log_parameters) {
     ga_results res;
     ga_parameter_s ga_pms;
     pr_parameter_s pr_pms;
     im_parameter_s im_pms;
 
-    if (make_dir(log_path)) {
-        std::cout << "ERROR: Cannot create directory " << log_path << "\n";
-        exit(-1);
-    }
-        
     ga_pms.sel_pms.selection_method = selection_method;
     ga_pms.sel_pms.bias = bias;
     ga_pms.sel_pms.num_parents = num_parents;
@@ -208,9 +207,13 @@ ga_results_s ga_optimization(REAL_ (*func)(REAL_ *, size_t),
     im_pms.is_im_enabled = is_im_enabled;
     im_pms.adj_list_fname = im_graph_fname;
 
-    print_parameters(ga_pms, pr_pms, im_pms);
+    if (log_parameters) {
+        print_parameters(ga_pms, pr_pms, im_pms);
+    }
     if (im_pms.is_im_enabled) {
-        printf("Optimizing using Island Model!\n");
+        if (log_parameters) {
+            printf("Optimizing using Island Model!\n");
+        }
         res = run_islands(func,
                           im_pms,
                           ga_pms,
@@ -218,15 +221,20 @@ ga_results_s ga_optimization(REAL_ (*func)(REAL_ *, size_t),
                           std::string(return_type));    
     } else {
         if (ga_pms.runs == 1) {
-            printf("Optimizing using a single GA!\n");
+            if (log_parameters) {
+                printf("Optimizing using a single GA!\n");
+            }
             GA gen_alg(&ga_pms);
             gen_alg.fitness = func;
             gen_alg.evolve(ga_pms.generations, 0, &pr_pms);
-            res.bsf = gen_alg.get_bsf();
-            res.average_fitness = gen_alg.get_average_fitness();
-            res.genome = gen_alg.get_best_genome();
+            res.bsf = std::move(gen_alg.get_bsf());
+            res.average_fitness = std::move(gen_alg.get_average_fitness());
+            res.genome = std::move(gen_alg.get_best_genome());
+            res.profile.push_back(gen_alg.profile);
         } else if (ga_pms.runs > 1) {
-            printf("Running %d independent GAs!\n", ga_pms.runs);
+            if (log_parameters) {
+                printf("Running %d independent GAs!\n", ga_pms.runs);
+            }
             res = independent_runs(func, &ga_pms, &pr_pms, return_type);
         } else {
             printf("Negative number of runs is illegal!\n");
@@ -246,7 +254,7 @@ ga_results_s ga_optimization(REAL_ (*func)(REAL_ *, size_t),
  *
  * See ga_optimization for more details on the arguments.
  * */
-void ga_optimization_python(REAL_ (*func)(REAL_ *, size_t),
+void GAIM_C_NAME(ga_optimization_python)(REAL_ (*func)(REAL_ *, size_t),
                             size_t n_generations,
                             size_t population_size,
                             size_t genome_size,
@@ -285,6 +293,7 @@ void ga_optimization_python(REAL_ (*func)(REAL_ *, size_t),
                             bool log_average_fitness,
                             bool log_bsf,
                             bool log_best_genome,
+                            bool log_parameters,
                             REAL_ **genome,
                             REAL_ **bsf,
                             REAL_ **avg_fitness) {
@@ -296,11 +305,6 @@ void ga_optimization_python(REAL_ (*func)(REAL_ *, size_t),
     std::vector<REAL_> a_(a, a + genome_size);
     std::vector<REAL_> b_(b, b + genome_size);
 
-    if (make_dir(log_path)) {
-        std::cout << "ERROR: Cannot create directory " << log_path << "\n";
-        exit(-1);
-    }
-    
     ga_pms.sel_pms.selection_method = std::string(selection_method);
     ga_pms.sel_pms.bias = bias;
     ga_pms.sel_pms.num_parents = num_parents;
@@ -354,9 +358,13 @@ void ga_optimization_python(REAL_ (*func)(REAL_ *, size_t),
     im_pms.is_im_enabled = is_im_enabled;
     im_pms.adj_list_fname = std::string(im_graph_fname);
 
-    print_parameters(ga_pms, pr_pms, im_pms);
+    if (log_parameters) {
+        print_parameters(ga_pms, pr_pms, im_pms);
+    }
     if (im_pms.is_im_enabled) {
-        printf("Optimizing using Island Model!\n");
+        if (log_parameters) {
+            printf("Optimizing using Island Model!\n");
+        }
         res = run_islands(func,
                           im_pms,
                           ga_pms,
@@ -370,16 +378,21 @@ void ga_optimization_python(REAL_ (*func)(REAL_ *, size_t),
         /* island_model.run_islands(&im_pms, &pr_pms); */
     } else {
         if (ga_pms.runs == 1) {
-            printf("Optimizing using a single GA!\n");
+            if (log_parameters) {
+                printf("Optimizing using a single GA!\n");
+            }
             GA gen_alg(&ga_pms);
             gen_alg.fitness = func;
             gen_alg.evolve(ga_pms.generations, 0, &pr_pms);
 
-            res.average_fitness = gen_alg.get_average_fitness();
-            res.bsf = gen_alg.get_bsf();
-            res.genome = gen_alg.get_best_genome();
+            res.average_fitness = std::move(gen_alg.get_average_fitness());
+            res.bsf = std::move(gen_alg.get_bsf());
+            res.genome = std::move(gen_alg.get_best_genome());
+            res.profile.push_back(gen_alg.profile);
         } else if (ga_pms.runs > 1) {
-            printf("Running %d independent GAs!\n", ga_pms.runs);
+            if (log_parameters) {
+                printf("Running %d independent GAs!\n", ga_pms.runs);
+            }
             res = independent_runs(func,
                                    &ga_pms,
                                    &pr_pms,
@@ -398,3 +411,5 @@ void ga_optimization_python(REAL_ (*func)(REAL_ *, size_t),
         (*genome)[i] = res.genome[i];
     }
 }
+
+GAIM_END_NAMESPACE
@@ -25,12 +25,15 @@
 // $Log$
 #include "gaim.h"
 #include <utility>
+#include <memory>
+#include <sys/stat.h>
+
+GAIM_BEGIN_NAMESPACE
 // #include "barrier.h"
 
 
 /* std::mutex mtx;     // Mutex for locking threads */
 // _pthread_barrier_t barrier; // Barrier for sync threads */
-pthread_barrier_t barrier; // Barrier for sync threads */
 
 
 /**
@@ -44,9 +47,11 @@ pthread_barrier_t barrier; // Barrier for sync threads */
  * @param[in] ga_pms Structure of GA parameters
  * @return Nothing
  */
-IM::IM(im_parameter_s *im_pms, ga_parameter_s *ga_pms)
+IM::IM(im_parameter_s *im_pms, const ga_parameter_s *ga_pms)
 {
     size_t num_vertices;
+    cancel_token = nullptr;
+    cancel_generation = SIZE_MAX;
     a = ga_pms->a;  // Lower bound of genome [a, b]
     b = ga_pms->b;  // Upper bound of genome [a, b]
     num_islands = im_pms->num_islands;      // Number of islands
@@ -56,7 +61,7 @@ IM::IM(im_parameter_s *im_pms, ga_parameter_s *ga_pms)
     if (migration_interval > ga_pms->generations) {
         std::cerr << "Migration interval exceeds number of generations!" 
             << std::endl;
-        exit(-1);
+        fatal_error();
     }
 
     // Compute the migration steps 
@@ -73,9 +78,56 @@ IM::IM(im_parameter_s *im_pms, ga_parameter_s *ga_pms)
         im_pms->num_islands = num_vertices;
     }
 
-    // Initialize the GA for each island
+    // Initialize the topology policy
+    topology_method = im_pms->topology_method;
+    rewiring_interval = im_pms->rewiring_interval;
+    rewiring_degree = im_pms->rewiring_degree;
+    num_migrations = 0;
+    current_epoch = 0;
+    base_adj_list = adj_list;
+    topology_rng.seed(pcg_extras::seed_seq_from<std::random_device>());
+
+    if (rewiring_interval < 1) {
+        std::cerr << "Rewiring interval must be at least 1!" << std::endl;
+        fatal_error();
+    }
+
+    if (topology_method == "random" || topology_method == "fitness") {
+        if (rewiring_degree < 1 || rewiring_degree >= num_islands) {
+            std::cerr << "Rewiring degree must be in [1, #islands)!"
+                << std::endl;
+            fatal_error();
+        }
+    } else if (topology_method == "epoch") {
+        if (im_pms->epoch_graph_fnames.empty()) {
+            std::cerr << "Epoch topology requires at least one graph file!"
+                << std::endl;
+            fatal_error();
+        }
+        for (auto &fname : im_pms->epoch_graph_fnames) {
+            std::map<int, std::vector<int>> epoch_graph;
+            if (read_connectivity_graph(fname, epoch_graph) != num_islands) {
+                std::cerr << "Epoch graph " << fname
+                    << " does not match the number of islands!" << std::endl;
+                fatal_error();
+            }
+            epoch_adj_lists.push_back(epoch_graph);
+        }
+    } else if (topology_method != "static") {
+        std::cerr << "ERROR: No such topology method exists!" << std::endl;
+        fatal_error();
+    }
+
+    // Initialize the GA for each island (constructed in place, no copies)
+    island.reserve(num_islands);
     for (size_t i = 0; i < num_islands; ++i) {
-       island.push_back(GA(ga_pms));
+       island.emplace_back(ga_pms);
+    }
+
+    // Every island draws its migrants with its own RNG (island threads)
+    migration_rng.resize(num_islands);
+    for (auto &rng : migration_rng) {
+        rng.seed(pcg_extras::seed_seq_from<std::random_device>());
     }
 }
 
@@ -114,30 +166,158 @@ IM::~IM()
  */
 size_t IM::read_connectivity_graph(std::string fname)
 {
-    int source, content;
-    size_t num_vertices, num_edges;
+    return read_connectivity_graph(fname, adj_list);
+}
+
+
+/// Parsed connectivity graph files
+struct graph_file {
+    size_t num_vertices;
+    std::vector<std::pair<int, int>> edges;     // (destination, source)
+};
+static FileCache<graph_file> graph_cache;
+
 
-    auto ifile = std::fstream(fname, std::ios::in);
-    if (!ifile) {
+/**
+ *  Reads a connectivity graph (same format as above) into the given adjacency
+ *  list instead of the island model's current topology. A file is parsed
+ *  only once; later Island Models reading the same (unmodified) file reuse
+ *  the parsed graph (see FileCache).
+ *
+ *  @param[in] fname The name of the file that contains the graph
+ *  @param[out] graph Adjacency list the edges are appended to
+ *  @return num_vertices The number of vertices (islands) found in the file.
+ */
+size_t IM::read_connectivity_graph(std::string fname,
+                                   std::map<int, std::vector<int>> &graph)
+{
+    struct stat buffer;
+
+    if (stat(fname.c_str(), &buffer)) {
         std::cout << "Unable to open file " << fname << std::endl;
-        exit(1);
+        fatal_error(1);
     }
+    file_version_s version = get_file_version(buffer);
+
+    std::lock_guard<std::mutex> lock(graph_cache.mtx);
+    graph_file *cached = graph_cache.find(fname, version);
+    if (!cached) {
+        int source, content;
+        size_t num_vertices, num_edges;
+        graph_file parsed = {0, {}};
+
+        auto ifile = std::fstream(fname, std::ios::in);
+        if (!ifile) {
+            std::cout << "Unable to open file " << fname << std::endl;
+            fatal_error(1);
+        }
 
-    ifile >> num_vertices;
-    for (size_t i = 0; i < num_vertices; ++i) {
-        ifile >> source;
-        ifile >> num_edges;
-        for (size_t j = 0; j < num_edges; ++j) {
-            ifile >> content;
-            if (content < 0 && content > (int) num_islands) {
-                std::cerr << "Error: Invalid destination island!" << std::endl;
-                exit(-1);
+        ifile >> num_vertices;
+        for (size_t i = 0; i < num_vertices; ++i) {
+            ifile >> source;
+            ifile >> num_edges;
+            for (size_t j = 0; j < num_edges; ++j) {
+                ifile >> content;
+                if (content < 0 && content > (int) num_islands) {
+                    std::cerr << "Error: Invalid destination island!" << std::endl;
+                    fatal_error();
+                }
+                parsed.edges.push_back(std::make_pair(source, content));
             }
-            adj_list[source].push_back(content);
         }
+        ifile.close();
+        parsed.num_vertices = num_vertices;
+        cached = &graph_cache.insert(fname, version, std::move(parsed));
+    }
+
+    for (auto &e : cached->edges) {
+        graph[e.first].push_back(e.second);
+    }
+    return cached->num_vertices;
+}
+
+
+/**
+ * Drops the parsed connectivity graphs (see clear_file_caches).
+ *
+ * @return Nothing (void)
+ */
+void IM::clear_graph_cache(void)
+{
+    std::lock_guard<std::mutex> lock(graph_cache.mtx);
+    graph_cache.clear();
+}
+
+
+/**
+ * Updates the connectivity graph (topology) of the island model according to
+ * the topology policy. It is called at migration points by a single island
+ * (thread) while all the other islands wait on a barrier, so the topology 
+ * never changes while immigrants are being moved. The available policies are:
+ * @li static   The topology read from the graph file is kept (default)
+ * @li random   Each island receives immigrants from rewiring_degree randomly
+ *              chosen islands
+ * @li fitness  Each island sends its immigrants to the rewiring_degree
+ *              weakest (lowest best fitness) of its neighbours in the graph
+ *              file
+ * @li epoch    The topology cycles through the graphs given in
+ *              epoch_graph_fnames
+ *
+ * The topology is updated every rewiring_interval migrations.
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void IM::rewire_topology(void)
+{
+    if (topology_method == "static") { return; }
+    if ((num_migrations++ % rewiring_interval) != 0) { return; }
+
+    if (topology_method == "random") {
+        std::vector<int> sources;
+        for (size_t dst = 0; dst < num_islands; ++dst) {
+            sources.resize(num_islands);
+            std::iota(sources.begin(), sources.end(), 0);
+            std::swap(sources[dst], sources.back());
+            sources.pop_back();
+            // Partial Fisher-Yates shuffle picks distinct sources
+            for (size_t i = 0; i < rewiring_degree; ++i) {
+                size_t j = i + topology_rng(sources.size() - i);
+                std::swap(sources[i], sources[j]);
+            }
+            adj_list[dst].assign(sources.begin(),
+                                 sources.begin() + rewiring_degree);
+        }
+    } else if (topology_method == "fitness") {
+        std::vector<int> neighbours;
+        for (size_t dst = 0; dst < num_islands; ++dst) {
+            adj_list[dst].clear();
+        }
+        for (size_t src = 0; src < num_islands; ++src) {
+            // Destinations of src in the original graph
+            neighbours.clear();
+            for (auto &edge : base_adj_list) {
+                if (std::find(edge.second.begin(), edge.second.end(), src) !=
+                        edge.second.end()) {
+                    neighbours.push_back(edge.first);
+                }
+            }
+            size_t n = std::min(rewiring_degree, neighbours.size());
+            std::partial_sort(neighbours.begin(),
+                              neighbours.begin() + n,
+                              neighbours.end(),
+                              [&](int x, int y) {
+                                  return island[x].stats.max <
+                                         island[y].stats.max;
+                              });
+            for (size_t i = 0; i < n; ++i) {
+                adj_list[neighbours[i]].push_back(src);
+            }
+        }
+    } else if (topology_method == "epoch") {
+        adj_list = epoch_adj_lists[current_epoch % epoch_adj_lists.size()];
+        current_epoch++;
     }
-    ifile.close();
-    return num_vertices;
 }
 
 
@@ -165,16 +345,21 @@ void IM::select_ind2migrate(size_t num_immigrants,
 {
     size_t id;
     size_t len = island[unique_id].population.size();
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> probs(a[0], b[0]);
-    std::vector <REAL_> new_genome(island[unique_id].genome_size);
-    std::vector<int> pop(island[unique_id].population.size());
+    pcg32 &gen = migration_rng[unique_id];
+    std::uniform_real_distribution<REAL_> unit(0, 1);
+    arena_vector<int> pop(island[unique_id].population.size(), 0,
+                          arena_allocator<int>(&island[unique_id].arena));
 
+    GAIM_PROFILE_START(t);
     std::iota(std::begin(pop), std::end(pop), 0);
     std::shuffle(std::begin(pop), std::end(pop), gen);
 
+    // The population is sorted only at migration points
+    island[unique_id].sort_population();
+
+    GAIM_PROFILE_START(t_lock);
     mtx.lock();
+    GAIM_PROFILE_STOP(island[unique_id].profile, t_lock, mutex_wait_ns);
     island[unique_id].immigrant.clear();
     if (method == "random") {
         for (size_t i = 0; i < num_immigrants; ++i) {
@@ -196,10 +381,42 @@ void IM::select_ind2migrate(size_t num_immigrants,
     }
     mtx.unlock();
 
+    // The emigrants are replaced by new random individuals (generated in
+    // place, no temporary genome)
     for (size_t i = 0; i < num_immigrants; ++i) {
-        std::generate(new_genome.begin(), new_genome.end(), [&]{return probs(gen);});
-        island[unique_id].population[island[unique_id].immigrant[i].id].genome = new_genome;
-        island[unique_id].population[island[unique_id].immigrant[i].id].fitness = island[unique_id].fitness(&new_genome[0], new_genome.size());
+        individual_s &ind = island[unique_id].population[island[unique_id].immigrant[i].id];
+        for (size_t j = 0; j < ind.genome.size(); ++j) {
+            ind.genome[j] = a[j] + (b[j] - a[j]) * unit(gen);
+        }
+        if (island[unique_id].get_num_objectives() > 1) {
+            // Evaluated and ranked at the next generation
+            ind.is_evaluated = false;
+            ind.fitness = -std::numeric_limits<REAL_>::max();
+        } else {
+            ind.fitness = island[unique_id].fitness(&ind.genome[0], ind.genome.size());
+        }
+    }
+    GAIM_PROFILE_COUNT(island[unique_id].profile, evaluations, num_immigrants);
+    GAIM_PROFILE_COUNT(island[unique_id].profile, migrants_sent, num_immigrants);
+    GAIM_PROFILE_STOP(island[unique_id].profile, t, migration_ns);
+}
+
+
+/**
+ * Copies an immigrant into an individual of an island, which evaluates its
+ * fitness. With several objectives the immigrant keeps its objectives (all
+ * the islands share the fitness function) and it is ranked at the next
+ * generation of the island.
+ */
+static void settle_immigrant(GA &ga, individual_s &ind, const individual_s &t)
+{
+    ind.genome = t.genome;
+    if (ga.get_num_objectives() > 1) {
+        ind.objectives = t.objectives;
+        ind.is_evaluated = t.is_evaluated;
+        ind.fitness = t.fitness;
+    } else {
+        ind.fitness = ga.fitness(&ind.genome[0], ind.genome.size());
     }
 }
 
@@ -227,32 +444,38 @@ void IM::move_immigrants(size_t num_immigrants,
                          size_t unique_id,
                          std::string method)
 {
+    // The number of immigrants is given by the buffers of the source islands
+    (void) num_immigrants;
     size_t id;
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    std::vector<individual_s> tmp(num_immigrants);
-    std::vector<int> pop(island[unique_id].population.size());
+    pcg32 &gen = migration_rng[unique_id];
+    arena_vector<int> pop(island[unique_id].population.size(), 0,
+                          arena_allocator<int>(&island[unique_id].arena));
 
+    GAIM_PROFILE_START(t);
     std::iota(std::begin(pop), std::end(pop), 0);
     std::shuffle(std::begin(pop), std::end(pop), gen);
 
+    GAIM_PROFILE_START(t_lock);
     mtx.lock();
+    GAIM_PROFILE_STOP(island[unique_id].profile, t_lock, mutex_wait_ns);
     for (auto &k : adj_list[unique_id]) {
+        GAIM_PROFILE_COUNT(island[unique_id].profile, migrants_received,
+                           island[k].immigrant.size());
+        GAIM_PROFILE_COUNT(island[unique_id].profile, evaluations,
+                           island[k].immigrant.size());
         if (method == "random") {
             size_t i = 0;
             for (auto &t : island[k].immigrant) {
                 id = pop[i];
-                island[unique_id].population[id].genome = t.genome;
-                island[unique_id].population[id].fitness = 
-                    island[unique_id].fitness(&t.genome[0], t.genome.size());
+                settle_immigrant(island[unique_id],
+                                 island[unique_id].population[id], t);
                 i++;
             }
         } else if (method == "poor") {
             size_t i = 0;
             for (auto &t : island[k].immigrant) {
-                island[unique_id].sorted_population[i].genome = t.genome;
-                island[unique_id].sorted_population[i].fitness = 
-                    island[unique_id].fitness(&t.genome[0], t.genome.size());
+                settle_immigrant(island[unique_id],
+                                 island[unique_id].sorted_population[i], t);
                 i++;
             }
             island[unique_id].population = island[unique_id].sorted_population;
@@ -260,9 +483,8 @@ void IM::move_immigrants(size_t num_immigrants,
             id = island[unique_id].population.size();
             size_t i = 0;
             for (auto &t : island[k].immigrant) {
-                island[unique_id].sorted_population[id-1-i].genome = t.genome;
-                island[unique_id].sorted_population[id-1-i].fitness = 
-                    island[unique_id].fitness(&t.genome[0], t.genome.size());
+                settle_immigrant(island[unique_id],
+                                 island[unique_id].sorted_population[id-1-i], t);
                 i++;
             }
             island[unique_id].population = island[unique_id].sorted_population;
@@ -273,46 +495,103 @@ void IM::move_immigrants(size_t num_immigrants,
         }
     }
     mtx.unlock();
+    GAIM_PROFILE_STOP(island[unique_id].profile, t, migration_ns);
 }
 
 
 /**
- * Evolves an island. This method runs the genetic algorithm per island and 
- * performs two major operations, selection of outgoing individuals (migrants)
- * and replacement of the target population. Furthermore,
- * it provides logging for the results of the evolution process per island.
+ * Runs a number of generations on an island. Migrations take place every
+ * migration_interval generations of the island (counted from the first
+ * generation, so consecutive calls continue the same schedule). Once the
+ * cancel_token is cancelled, all the islands stop after the same generation.
  *
  * @param unique_id Unique ID number of island (thread ID)
+ * @param generations Number of generations to run
  * @param im_pms Island model parameters structure
  * @param pr_pms Logging parameters structure
  * @return Nothing (void)
  */
-void IM::evolve_island(size_t unique_id,
-                       im_parameter_s *im_pms,
-                       pr_parameter_s *pr_pms)
+void IM::run_island_generations(size_t unique_id,
+                                size_t generations,
+                                im_parameter_s *im_pms,
+                                const pr_parameter_s *pr_pms)
 {
-    std::vector<individual_s> immigrant;
+    ga_profile_s &profile = island[unique_id].profile;
+    (void) profile;
+    (void) pr_pms;
 
-    island[unique_id].evaluation(island[unique_id].population);
-    island[unique_id].current_generation = 0;
-    for (size_t k = 0; k < migration_steps; ++k) {
+    // Waits at the islands barrier (the waiting time is profiled)
+    auto barrier_wait = [&]() {
+        GAIM_PROFILE_START(t);
+        pthread_barrier_wait(&barrier);
+        GAIM_PROFILE_STOP(profile, t, barrier_wait_ns);
+    };
+
+    for (size_t k = 0; k < generations; ++k) {
+        size_t generation = island[unique_id].current_generation;
         island[unique_id].run_one_generation();
         ++island[unique_id].current_generation;
-        pthread_barrier_wait(&barrier);
+#ifdef GAIM_PROFILE
+        if (pr_pms->profile_interval &&
+            !(island[unique_id].current_generation % pr_pms->profile_interval)) {
+            print_profile(profile, island[unique_id].current_generation,
+                          unique_id, pr_pms->where2write);
+        }
+#endif
+        // The islands that see the cancellation before the barrier agree on
+        // the earliest generation, so all of them stop after the same one
+        if (cancel_token && cancel_token->is_cancelled()) {
+            size_t expected = cancel_generation.load();
+            while (k < expected &&
+                   !cancel_generation.compare_exchange_weak(expected, k)) {}
+        }
+        barrier_wait();
+        if (cancel_generation.load() <= k) {
+            break;
+        }
 
-        if (!(k % migration_interval)) {
+        if (!(generation % migration_interval)) {
+            if (topology_method != "static") {
+                if (unique_id == 0) {
+                    rewire_topology();
+                }
+                barrier_wait();
+            }
             select_ind2migrate(im_pms->num_immigrants,
                                unique_id,
                                im_pms->pick_method);
-            pthread_barrier_wait(&barrier);
+            barrier_wait();
             move_immigrants(im_pms->num_islands,
                             unique_id,
                             im_pms->replace_method);
-            pthread_barrier_wait(&barrier);
+            barrier_wait();
         }
     }
+}
+
+
+/**
+ * Evolves an island. This method runs the genetic algorithm per island and 
+ * performs two major operations, selection of outgoing individuals (migrants)
+ * and replacement of the target population. Furthermore,
+ * it provides logging for the results of the evolution process per island.
+ *
+ * @param unique_id Unique ID number of island (thread ID)
+ * @param im_pms Island model parameters structure
+ * @param pr_pms Logging parameters structure
+ * @return Nothing (void)
+ */
+void IM::evolve_island(size_t unique_id,
+                       im_parameter_s *im_pms,
+                       const pr_parameter_s *pr_pms)
+{
+    island[unique_id].evaluation(island[unique_id].population);
+    island[unique_id].current_generation = 0;
+    run_island_generations(unique_id, migration_steps, im_pms, pr_pms);
     island[unique_id].sort_population();
+    GAIM_PROFILE_START(t);
     pthread_barrier_wait(&barrier);
+    GAIM_PROFILE_STOP(island[unique_id].profile, t, barrier_wait_ns);
     
     mtx.lock();
     if (pr_pms->print_fitness) {
@@ -329,7 +608,7 @@ void IM::evolve_island(size_t unique_id,
         print_bsf(island[unique_id].bsf, unique_id, pr_pms->where2write);
     } 
     if (pr_pms->print_best_genome) {
-        print_best_genome(island[unique_id].best_individual.genome,
+        print_best_genome(island[unique_id].bsf_genome,
                           unique_id,
                           pr_pms->where2write);
     }
@@ -344,11 +623,25 @@ void IM::evolve_island(size_t unique_id,
  * @param pr_pms Logging parameters structure
  * @return Nothing (void)
  */
-void IM::evolve_islands(im_parameter_s *im_pms, pr_parameter_s *pr_pms)
+void IM::evolve_islands(im_parameter_s *im_pms, const pr_parameter_s *pr_pms)
 {
     pthread_barrier_init(&barrier, NULL, im_pms->num_islands);
+    cancel_generation = SIZE_MAX;
     std::vector<std::thread> islands;
 
+    // Live metrics (one slot per island)
+    std::unique_ptr<MetricsExporter> exporter;
+    if (!pr_pms->metrics_target.empty()) {
+        exporter.reset(new MetricsExporter(pr_pms->metrics_target,
+                                           pr_pms->metrics_period_ms,
+                                           num_islands,
+                                           pr_pms->experiment_name));
+        for (size_t i = 0; i < num_islands; ++i) {
+            island[i].metrics = exporter->slot(i);
+        }
+        exporter->start();
+    }
+
     for (size_t i = 0; i < num_islands; ++i) {
         islands.push_back(std::thread(&IM::evolve_island,
                                       this,
@@ -359,6 +652,47 @@ void IM::evolve_islands(im_parameter_s *im_pms, pr_parameter_s *pr_pms)
     for (std::thread& th : islands) {
         if (th.joinable()) { th.join(); }
     }
+
+    if (exporter) {
+        exporter->stop();
+        for (size_t i = 0; i < num_islands; ++i) {
+            island[i].metrics = nullptr;
+        }
+    }
+    pthread_barrier_destroy(&barrier);
+}
+
+
+/**
+ * Runs a number of generations on all the islands (one thread per island),
+ * continuing from where the previous call stopped. Nothing is logged, the
+ * islands are inspected directly (see the C API in engine.cpp).
+ *
+ * @param generations Number of generations to run
+ * @param im_pms Island model parameters structure
+ * @param pr_pms Logging parameters structure
+ * @return Nothing (void)
+ */
+void IM::step_islands(size_t generations,
+                      im_parameter_s *im_pms,
+                      const pr_parameter_s *pr_pms)
+{
+    pthread_barrier_init(&barrier, NULL, num_islands);
+    cancel_generation = SIZE_MAX;
+    std::vector<std::thread> islands;
+
+    for (size_t i = 0; i < num_islands; ++i) {
+        islands.push_back(std::thread(&IM::run_island_generations,
+                                      this,
+                                      i,
+                                      generations,
+                                      im_pms,
+                                      pr_pms));
+    }
+    for (std::thread& th : islands) {
+        if (th.joinable()) { th.join(); }
+    }
+    pthread_barrier_destroy(&barrier);
 }
 
 
@@ -379,29 +713,25 @@ void IM::evolve_islands(im_parameter_s *im_pms, pr_parameter_s *pr_pms)
  * @return A data structure of type ga_results_s with the selected genome.
  */
 ga_results_s run_islands(REAL_ (*func)(REAL_ *, size_t),
-                         im_parameter_s im_pms,
-                         ga_parameter_s ga_pms,
-                         pr_parameter_s pr_pms,
+                         const im_parameter_s &im_pms,
+                         const ga_parameter_s &ga_pms,
+                         const pr_parameter_s &pr_pms,
                          std::string return_type) {
-    ga_results_s res;
-    IM island_model(&im_pms, &ga_pms);
-
-    /// Create the data directory if it doesn't exist
-    if (make_dir(pr_pms.where2write)) {
-        std::cout << "ERROR: Cannot create directory " << pr_pms.where2write << "\n";
-        exit(-1);
-    }
+    // The IM may adjust the number of islands to the topology file
+    im_parameter_s im_local(im_pms);
+    IM island_model(&im_local, &ga_pms);
 
     /// Set the fitness function for every island
-    for (size_t i = 0; i < im_pms.num_islands; ++i) {
+    for (size_t i = 0; i < im_local.num_islands; ++i) {
        island_model.island[i].fitness = func;
     }
 
     /// Evolve a GA on each island
-    island_model.evolve_islands(&im_pms, &pr_pms);
+    island_model.evolve_islands(&im_local, &pr_pms);
 
-    /// Choose from all the islands which genome to return
-    res = return_best_results(island_model.island, return_type);
-
-    return res;
+    /// Choose from all the islands which genome to return (the islands are
+    /// released while the results are moved out)
+    return return_best_results(std::move(island_model.island), return_type);
 }
+
+GAIM_END_NAMESPACE
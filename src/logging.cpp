@@ -24,6 +24,8 @@
 // $Log$
 #include "gaim.h"
 
+GAIM_BEGIN_NAMESPACE
+
 
 /**
  *  Converts a number to a string with specific format and tabs.
@@ -90,8 +92,8 @@ void print_fitness(std::vector<individual_s> &individual,
             std::cout << std::setw(5) << p.id  << " | " << prd(p.fitness, 7, 10) << std::endl;
         }
     } else {
-        if (!is_path_exist(write_to)) {
-            std::cerr << "The directory "+write_to+" does not exist!" << std::endl;
+        if (make_dir(write_to)) {
+            std::cerr << "Cannot create the directory "+write_to+"!" << std::endl;
             std::cerr << "Nothing will be saved!" << std::endl;
         } else {
             std::string fname = write_to+"fitness_";
@@ -133,8 +135,8 @@ void print_bsf(std::vector<REAL_> bsf,
             iter++;
         }
     }else{
-        if (!is_path_exist(write_to)) {
-            std::cerr << "The directory "+write_to+" does not exist!" << std::endl;
+        if (make_dir(write_to)) {
+            std::cerr << "Cannot create the directory "+write_to+"!" << std::endl;
             std::cerr << "Nothing will be saved!" << std::endl;
         } else {
             std::string fname = write_to+"bsf_";
@@ -175,8 +177,8 @@ void print_avg_fitness(std::vector<REAL_> fit_avg,
             iter++;
         }
     }else{
-        if (!is_path_exist(write_to)) {
-            std::cerr << "The directory "+write_to+" does not exist!" << std::endl;
+        if (make_dir(write_to)) {
+            std::cerr << "Cannot create the directory "+write_to+"!" << std::endl;
             std::cerr << "Nothing will be saved!" << std::endl;
         } else {
             std::string fname = write_to+"average_fitness_";
@@ -217,8 +219,8 @@ void print_best_genome(std::vector<REAL_> best_genome,
         }
         std::cout << std::endl;
     }else{
-        if (!is_path_exist(write_to)) {
-            std::cerr << "The directory "+write_to+" does not exist!" << std::endl;
+        if (make_dir(write_to)) {
+            std::cerr << "Cannot create the directory "+write_to+"!" << std::endl;
             std::cerr << "Nothing will be saved!" << std::endl;
         } else {
             std::string fname = write_to+"best_genome_";
@@ -232,3 +234,5 @@ void print_best_genome(std::vector<REAL_> best_genome,
         }
     }
 }
+
+GAIM_END_NAMESPACE
@@ -0,0 +1,306 @@
+/* Live metrics cpp file for GAIM software
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file metrics.cpp
+ * Implements the live metrics exporter. A side thread publishes the
+ * per-island generation, BSF, average fitness, diversity, and evaluation rate
+ * in Prometheus text format to a file or a Unix socket while the GAs evolve.
+ */
+// $Log$
+#include "gaim.h"
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+GAIM_BEGIN_NAMESPACE
+
+
+/**
+ * @brief Constructor of MetricsExporter class.
+ *
+ * Parses the target and, for a Unix socket target, creates the listening
+ * socket. Failures are reported and disable the exporter, they never stop the
+ * optimization.
+ *
+ * @param[in] target Either "file:/path/to/file" or "unix:/path/to/socket"
+ * @param[in] period Publishing period in milliseconds
+ * @param[in] num_slots Number of GAs (islands or runs)
+ * @param[in] experiment_name Experiment name (used as a label)
+ * @return Nothing
+ */
+MetricsExporter::MetricsExporter(std::string target,
+                                 size_t period,
+                                 size_t num_slots,
+                                 std::string experiment_name)
+    : slots(num_slots),
+      last_evaluations(num_slots, 0),
+      rates(num_slots, 0),
+      experiment(experiment_name),
+      period_ms(period ? period : 1),
+      listen_fd(-1),
+      running(false)
+{
+    size_t pos = target.find(':');
+    mode = target.substr(0, pos);
+    path = (pos == std::string::npos) ? "" : target.substr(pos + 1);
+
+    if ((mode != "file" && mode != "unix") || path.empty()) {
+        std::cerr << "WARNING: Invalid metrics target " << target
+            << " (use file:/path or unix:/path)!" << std::endl;
+        std::cerr << "Live metrics are disabled!" << std::endl;
+        mode = "";
+        return;
+    }
+
+    if (mode == "unix") {
+        struct sockaddr_un addr;
+        if (path.size() >= sizeof(addr.sun_path)) {
+            std::cerr << "WARNING: Metrics socket path is too long!" << std::endl;
+            mode = "";
+            return;
+        }
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        unlink(path.c_str());
+        listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0 ||
+            bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+            listen(listen_fd, 4) < 0) {
+            std::cerr << "WARNING: Cannot create metrics socket " << path
+                << "!" << std::endl;
+            if (listen_fd >= 0) { close(listen_fd); }
+            listen_fd = -1;
+            mode = "";
+        }
+    }
+}
+
+
+/**
+ * @brief Destructor of MetricsExporter class.
+ */
+MetricsExporter::~MetricsExporter()
+{
+    stop();
+    if (listen_fd >= 0) {
+        close(listen_fd);
+        unlink(path.c_str());
+    }
+}
+
+
+/**
+ * Starts the exporter thread (nothing happens if the exporter is disabled).
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void MetricsExporter::start(void)
+{
+    if (mode.empty() || running) {
+        return;
+    }
+    last_update = std::chrono::steady_clock::now();
+    running = true;
+    worker = std::thread(&MetricsExporter::run, this);
+}
+
+
+/**
+ * Stops the exporter thread. A final snapshot is published so the file
+ * reflects the end state of the optimization.
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void MetricsExporter::stop(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!running) {
+            return;
+        }
+        running = false;
+    }
+    cv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    publish();
+}
+
+
+/**
+ * Renders the current state of all the slots in Prometheus text format.
+ * It also updates the evaluation rates and asks the GAs for a fresh
+ * diversity value.
+ *
+ * @param[in] void
+ * @return A string with the metrics
+ */
+std::string MetricsExporter::render(void)
+{
+    std::stringstream ss;
+    auto now = std::chrono::steady_clock::now();
+    double dt = std::chrono::duration<double>(now - last_update).count();
+    std::vector<uint64_t> evaluations(slots.size());
+
+    for (size_t i = 0; i < slots.size(); ++i) {
+        evaluations[i] = slots[i].evaluations.load(std::memory_order_relaxed);
+        if (dt > 0) {
+            rates[i] = (evaluations[i] - last_evaluations[i]) / dt;
+        }
+        last_evaluations[i] = evaluations[i];
+    }
+    last_update = now;
+
+    auto family = [&](const char *name, const char *type, const char *help,
+                      std::function<void(size_t)> value) {
+        ss << "# HELP " << name << " " << help << "\n";
+        ss << "# TYPE " << name << " " << type << "\n";
+        for (size_t i = 0; i < slots.size(); ++i) {
+            ss << name << "{experiment=\"" << experiment << "\",island=\""
+                << i << "\"} ";
+            value(i);
+            ss << "\n";
+        }
+    };
+
+    ss << std::setprecision(9);
+    family("gaim_generation", "gauge", "Current generation of the island",
+           [&](size_t i) { ss << slots[i].generation.load(std::memory_order_relaxed); });
+    family("gaim_bsf", "gauge", "Best so far fitness of the island",
+           [&](size_t i) { ss << slots[i].bsf.load(std::memory_order_relaxed); });
+    family("gaim_average_fitness", "gauge", "Average fitness of the population",
+           [&](size_t i) { ss << slots[i].average_fitness.load(std::memory_order_relaxed); });
+    family("gaim_diversity", "gauge", "Mean standard deviation of the genes",
+           [&](size_t i) { ss << slots[i].diversity.load(std::memory_order_relaxed); });
+    family("gaim_evaluations_total", "counter", "Fitness evaluations",
+           [&](size_t i) { ss << evaluations[i]; });
+    family("gaim_evaluations_per_second", "gauge", "Fitness evaluation rate",
+           [&](size_t i) { ss << rates[i]; });
+    family("gaim_evaluation_timeouts_total", "counter", "Fitness evaluations that timed out",
+           [&](size_t i) { ss << slots[i].timeouts.load(std::memory_order_relaxed); });
+
+    for (auto &s : slots) {
+        s.diversity_requested.store(true, std::memory_order_relaxed);
+    }
+    return ss.str();
+}
+
+
+/**
+ * Renders a new snapshot and, for a file target, writes it atomically
+ * (temporary file and rename).
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void MetricsExporter::publish(void)
+{
+    if (mode.empty()) {
+        return;
+    }
+    text = render();
+    if (mode == "file") {
+        std::string tmp = path + ".tmp";
+        auto ofile = std::fstream(tmp, std::ios::out | std::ios::trunc);
+        if (!ofile) {
+            return;
+        }
+        ofile << text;
+        ofile.close();
+        std::rename(tmp.c_str(), path.c_str());
+    }
+}
+
+
+/**
+ * Sends the last snapshot to a client of the Unix socket.
+ *
+ * @param[in] fd Client socket descriptor
+ * @return Nothing (void)
+ */
+void MetricsExporter::serve(int fd)
+{
+    const char *buf = text.c_str();
+    size_t left = text.size();
+
+    while (left > 0) {
+        ssize_t n = send(fd, buf, left, MSG_NOSIGNAL);
+        if (n <= 0) {
+            break;
+        }
+        buf += n;
+        left -= n;
+    }
+    close(fd);
+}
+
+
+/**
+ * Exporter thread function. Publishes a snapshot every period_ms
+ * milliseconds and, for a Unix socket target, serves the clients in between.
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void MetricsExporter::run(void)
+{
+    auto next = std::chrono::steady_clock::now();
+
+    while (true) {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= next) {
+            publish();
+            next = now + std::chrono::milliseconds(period_ms);
+        }
+        long wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                next - std::chrono::steady_clock::now()).count();
+        wait = std::max(0L, wait);
+
+        if (listen_fd >= 0) {
+            // Wake up at least every 100 ms to notice a stop request
+            struct pollfd pfd = {listen_fd, POLLIN, 0};
+            if (poll(&pfd, 1, static_cast<int>(std::min(wait, 100L))) > 0) {
+                int fd = accept(listen_fd, NULL, NULL);
+                if (fd >= 0) {
+                    serve(fd);
+                }
+            }
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!running) {
+                break;
+            }
+        } else {
+            std::unique_lock<std::mutex> lock(mtx);
+            if (cv.wait_for(lock, std::chrono::milliseconds(wait),
+                            [this]{ return !running; })) {
+                break;
+            }
+        }
+    }
+}
+
+GAIM_END_NAMESPACE
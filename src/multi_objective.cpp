@@ -0,0 +1,568 @@
+/* Multi-objective optimization cpp file for GAIM software
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file multi_objective.cpp
+ * Implements the multi-objective mode of the GA (NSGA-II style): the
+ * non-dominated sorting, the crowding distance, the survival of the best
+ * individuals of the population and the offspring, and the Pareto front.
+ * The individuals are ranked into a scalar fitness (the crowded comparison
+ * of NSGA-II), so the selection operators and the Island Model work
+ * unchanged.
+ */
+// $Log$
+#include "gaim.h"
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <limits>
+
+GAIM_BEGIN_NAMESPACE
+
+
+/**
+ * Returns true if a dominates b (all the objectives are maximized): a is
+ * nowhere worse than b and somewhere better.
+ */
+static bool dominates(const REAL_ *a, const REAL_ *b, size_t m)
+{
+    bool better = false;
+    for (size_t j = 0; j < m; ++j) {
+        if (a[j] < b[j]) {
+            return false;
+        }
+        if (a[j] > b[j]) {
+            better = true;
+        }
+    }
+    return better;
+}
+
+
+/**
+ * @brief State of the divide-and-conquer non-dominated sort (generalized
+ * Jensen algorithm, in the version of Buzdalov and Shalyto).
+ *
+ * The distinct points are stored in lexicographic order with negated
+ * objectives (so a point dominates another if it is nowhere larger and
+ * differs), hence a point can only be dominated by points of lower index,
+ * and the index lists of the recursion stay sorted. rank holds the lower
+ * bounds of the fronts, which become exact as the recursion proceeds.
+ */
+struct nds_state {
+    std::vector<REAL_> x;       // Negated objectives of the distinct points
+    size_t m;                   // Number of objectives
+    std::vector<size_t> rank;   // Front of every distinct point
+
+    REAL_ at(size_t i, size_t k) const { return x[i * m + k]; }
+
+    /// Returns true if a is nowhere larger than b in objectives 0..k
+    bool weakly_dominates(size_t a, size_t b, size_t k) const {
+        for (size_t j = 0; j <= k; ++j) {
+            if (at(a, j) > at(b, j)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Returns the median of objective k over a list of points
+    REAL_ median(const std::vector<size_t> &s, size_t k) const {
+        std::vector<REAL_> v(s.size());
+        for (size_t i = 0; i < s.size(); ++i) {
+            v[i] = at(s[i], k);
+        }
+        std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+        return v[v.size() / 2];
+    }
+
+    /// Splits a list by objective k around a value (lists stay sorted)
+    void split(const std::vector<size_t> &s, size_t k, REAL_ value,
+               std::vector<size_t> &lo, std::vector<size_t> &eq,
+               std::vector<size_t> &hi) const {
+        for (auto i : s) {
+            REAL_ v = at(i, k);
+            (v < value ? lo : (v > value ? hi : eq)).push_back(i);
+        }
+    }
+
+    void sweep_a(const std::vector<size_t> &s);
+    void sweep_b(const std::vector<size_t> &l, const std::vector<size_t> &h);
+    void helper_a(const std::vector<size_t> &s, size_t k);
+    void helper_b(const std::vector<size_t> &l, const std::vector<size_t> &h,
+                  size_t k);
+};
+
+
+/**
+ * @brief Prefix maximum (Fenwick) tree over the compressed values of the
+ * second objective, used by the two-objective sweeps.
+ */
+class nds_tree {
+    public:
+        nds_tree(std::vector<REAL_> &&values) : keys(std::move(values)) {
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            tree.assign(keys.size() + 1, 0);
+        }
+        /// Records a point of front r at value v
+        void insert(REAL_ v, size_t r) {
+            size_t i = std::lower_bound(keys.begin(), keys.end(), v) - keys.begin() + 1;
+            for (; i < tree.size(); i += i & (~i + 1)) {
+                tree[i] = std::max(tree[i], r + 1);
+            }
+        }
+        /// Returns 1 + the largest front recorded at values <= v (0 if none)
+        size_t query(REAL_ v) const {
+            size_t r = 0;
+            size_t i = std::upper_bound(keys.begin(), keys.end(), v) - keys.begin();
+            for (; i > 0; i -= i & (~i + 1)) {
+                r = std::max(r, tree[i]);
+            }
+            return r;
+        }
+
+    private:
+        std::vector<REAL_> keys;
+        std::vector<size_t> tree;
+};
+
+
+/**
+ * Ranks the points of s on the first two objectives (the others are equal).
+ * In lexicographic order, a point is dominated by the earlier points that are
+ * not larger in the second objective.
+ */
+void nds_state::sweep_a(const std::vector<size_t> &s)
+{
+    std::vector<REAL_> values;
+    for (auto i : s) {
+        values.push_back(at(i, 1));
+    }
+    nds_tree tree(std::move(values));
+    for (auto i : s) {
+        rank[i] = std::max(rank[i], tree.query(at(i, 1)));
+        tree.insert(at(i, 1), rank[i]);
+    }
+}
+
+
+/**
+ * Updates the fronts of the points of h with the (final) fronts of the points
+ * of l, comparing the first two objectives (l is not larger in the others).
+ */
+void nds_state::sweep_b(const std::vector<size_t> &l, const std::vector<size_t> &h)
+{
+    std::vector<REAL_> values;
+    for (auto i : l) {
+        values.push_back(at(i, 1));
+    }
+    nds_tree tree(std::move(values));
+    size_t next = 0;
+    for (auto i : h) {
+        for (; next < l.size() && l[next] < i; ++next) {
+            tree.insert(at(l[next], 1), rank[l[next]]);
+        }
+        rank[i] = std::max(rank[i], tree.query(at(i, 1)));
+    }
+}
+
+
+/**
+ * Ranks the points of s, which are equal in the objectives above k.
+ */
+void nds_state::helper_a(const std::vector<size_t> &s, size_t k)
+{
+    if (s.size() < 2) {
+        return;
+    }
+    if (s.size() == 2) {
+        if (weakly_dominates(s[0], s[1], k)) {
+            rank[s[1]] = std::max(rank[s[1]], rank[s[0]] + 1);
+        }
+        return;
+    }
+    if (k == 1) {
+        sweep_a(s);
+        return;
+    }
+    auto range = std::minmax_element(s.begin(), s.end(), [&](size_t a, size_t b) {
+        return at(a, k) < at(b, k);
+    });
+    if (at(*range.first, k) == at(*range.second, k)) {
+        helper_a(s, k - 1);
+        return;
+    }
+    std::vector<size_t> lo, eq, hi, lo_eq;
+    split(s, k, median(s, k), lo, eq, hi);
+    helper_a(lo, k);
+    helper_b(lo, eq, k - 1);
+    helper_a(eq, k - 1);
+    std::merge(lo.begin(), lo.end(), eq.begin(), eq.end(), std::back_inserter(lo_eq));
+    helper_b(lo_eq, hi, k - 1);
+    helper_a(hi, k);
+}
+
+
+/**
+ * Updates the fronts of the points of h with the (final) fronts of the points
+ * of l, comparing objectives 0..k (l is not larger in the others).
+ */
+void nds_state::helper_b(const std::vector<size_t> &l, const std::vector<size_t> &h,
+                         size_t k)
+{
+    if (l.empty() || h.empty()) {
+        return;
+    }
+    if (l.size() == 1 || h.size() == 1) {
+        for (auto j : h) {
+            for (auto i : l) {
+                if (weakly_dominates(i, j, k)) {
+                    rank[j] = std::max(rank[j], rank[i] + 1);
+                }
+            }
+        }
+        return;
+    }
+    if (k == 1) {
+        sweep_b(l, h);
+        return;
+    }
+    auto cmp = [&](size_t a, size_t b) { return at(a, k) < at(b, k); };
+    auto l_range = std::minmax_element(l.begin(), l.end(), cmp);
+    auto h_range = std::minmax_element(h.begin(), h.end(), cmp);
+    if (at(*l_range.second, k) <= at(*h_range.first, k)) {
+        helper_b(l, h, k - 1);
+        return;
+    }
+    if (at(*l_range.first, k) > at(*h_range.second, k)) {
+        return;
+    }
+    std::vector<size_t> all, l_lo, l_eq, l_hi, h_lo, h_eq, h_hi, l_le, h_ge;
+    std::merge(l.begin(), l.end(), h.begin(), h.end(), std::back_inserter(all));
+    REAL_ med = median(all, k);
+    split(l, k, med, l_lo, l_eq, l_hi);
+    split(h, k, med, h_lo, h_eq, h_hi);
+    helper_b(l_lo, h_lo, k);
+    helper_b(l_hi, h_hi, k);
+    std::merge(l_lo.begin(), l_lo.end(), l_eq.begin(), l_eq.end(), std::back_inserter(l_le));
+    std::merge(h_eq.begin(), h_eq.end(), h_hi.begin(), h_hi.end(), std::back_inserter(h_ge));
+    helper_b(l_le, h_ge, k - 1);
+}
+
+
+/**
+ * Sorts points into non-dominated fronts. The points are visited in
+ * decreasing lexicographic order, so a point can only be dominated by the
+ * points visited before it.
+ * @li With up to two objectives a point joins the first front whose last
+ * member does not dominate it, found by binary search (O(N log N)).
+ * @li With more objectives the fronts are computed by the divide-and-conquer
+ * sort of Jensen (as corrected by Fortin, Buzdalov and Shalyto), which
+ * splits the points at the median of the last objective and reduces the
+ * comparisons across the halves to one objective less, down to two-objective
+ * sweeps (O(N log^{M-1} N)).
+ *
+ * @param[in] obj Objective values stored row-wise (n x m)
+ * @param[in] n Number of points
+ * @param[in] m Number of objectives
+ * @return The front of every point (0 for the non-dominated ones)
+ */
+std::vector<size_t> non_dominated_sort(const REAL_ *obj, size_t n, size_t m)
+{
+    std::vector<size_t> order(n), rank(n);
+
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return std::lexicographical_compare(obj + b * m, obj + (b + 1) * m,
+                                            obj + a * m, obj + (a + 1) * m);
+    });
+
+    if (m > 2) {
+        // Distinct points (duplicates share their front), negated
+        nds_state state;
+        std::vector<size_t> point(n), all;
+        state.m = m;
+        for (size_t i = 0; i < n; ++i) {
+            const REAL_ *p = obj + order[i] * m;
+            if (!i || !std::equal(p, p + m, obj + order[i - 1] * m)) {
+                all.push_back(all.size());
+                for (size_t j = 0; j < m; ++j) {
+                    state.x.push_back(-p[j]);
+                }
+            }
+            point[order[i]] = all.size() - 1;
+        }
+        state.rank.assign(all.size(), 0);
+        state.helper_a(all, m - 1);
+        for (size_t i = 0; i < n; ++i) {
+            rank[i] = state.rank[point[i]];
+        }
+        return rank;
+    }
+
+    std::vector<size_t> last;   // Last member of every front
+    for (auto s : order) {
+        size_t lo = 0, hi = last.size();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (dominates(obj + last[mid] * m, obj + s * m, m)) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (lo == last.size()) {
+            last.emplace_back();
+        }
+        last[lo] = s;
+        rank[s] = lo;
+    }
+    return rank;
+}
+
+
+/**
+ * Computes the crowding distance of points within their fronts: the sum
+ * over the objectives of the distance between the two neighbours of a
+ * point, normalized by the range of the front. The extreme points of a
+ * front (and the points of fronts of at most two points) are infinitely
+ * far, which is marked by the largest REAL_ (not an infinity, so the
+ * ranking stays valid when built with -ffast-math).
+ *
+ * @param[in] obj Objective values stored row-wise (n x m)
+ * @param[in] n Number of points
+ * @param[in] m Number of objectives
+ * @param[in] rank Front of every point (see non_dominated_sort)
+ * @return The crowding distance of every point
+ */
+std::vector<REAL_> crowding_distance(const REAL_ *obj, size_t n, size_t m,
+                                     const std::vector<size_t> &rank)
+{
+    const REAL_ far = std::numeric_limits<REAL_>::max();
+    std::vector<REAL_> dist(n, 0);
+    std::vector<std::vector<size_t>> fronts;
+
+    for (size_t i = 0; i < n; ++i) {
+        if (rank[i] >= fronts.size()) {
+            fronts.resize(rank[i] + 1);
+        }
+        fronts[rank[i]].push_back(i);
+    }
+    for (auto &front : fronts) {
+        size_t len = front.size();
+        if (len <= 2) {
+            for (auto i : front) {
+                dist[i] = far;
+            }
+            continue;
+        }
+        for (size_t j = 0; j < m; ++j) {
+            std::sort(front.begin(), front.end(), [&](size_t a, size_t b) {
+                return obj[a * m + j] < obj[b * m + j];
+            });
+            REAL_ range = obj[front[len - 1] * m + j] - obj[front[0] * m + j];
+            dist[front[0]] = dist[front[len - 1]] = far;
+            if (range <= 0) {
+                continue;
+            }
+            for (size_t k = 1; k < len - 1; ++k) {
+                if (dist[front[k]] < far) {
+                    dist[front[k]] += (obj[front[k + 1] * m + j] -
+                                       obj[front[k - 1] * m + j]) / range;
+                }
+            }
+        }
+    }
+    return dist;
+}
+
+
+/**
+ * Ranks points into scalar fitness values that order them like the crowded
+ * comparison of NSGA-II: -front + 0.5 * d / (1 + d) for a crowding distance
+ * d, so a better front always wins and, within a front, the less crowded
+ * point.
+ */
+static std::vector<REAL_> crowded_fitness(const REAL_ *obj, size_t n, size_t m)
+{
+    std::vector<size_t> rank = non_dominated_sort(obj, n, m);
+    std::vector<REAL_> dist = crowding_distance(obj, n, m, rank);
+    std::vector<REAL_> fit(n);
+    const REAL_ far = std::numeric_limits<REAL_>::max();
+
+    for (size_t i = 0; i < n; ++i) {
+        REAL_ crowd = (dist[i] == far) ? REAL_(0.5)
+                                       : REAL_(0.5) * dist[i] / (1 + dist[i]);
+        fit[i] = crowd - static_cast<REAL_>(rank[i]);
+    }
+    return fit;
+}
+
+
+/**
+ * Ranks the population: the fitness of every individual becomes its crowded
+ * comparison rank (see crowded_fitness), which the selection operators and
+ * the migrations use as a scalar fitness.
+ *
+ * @return Nothing (void)
+ */
+void GA::rank_population(void)
+{
+    GAIM_PROFILE_START(t);
+    size_t n = population.size(), m = num_objectives;
+
+    objective_matrix.resize(n * m);
+    for (size_t i = 0; i < n; ++i) {
+        std::copy(population[i].objectives.begin(),
+                  population[i].objectives.end(),
+                  objective_matrix.begin() + i * m);
+    }
+    std::vector<REAL_> fit = crowded_fitness(&objective_matrix[0], n, m);
+    for (size_t i = 0; i < n; ++i) {
+        population[i].fitness = fit[i];
+    }
+    GAIM_PROFILE_STOP(profile, t, sorting_ns);
+}
+
+
+/**
+ * NSGA-II survival: the population and the offspring are ranked together
+ * and the best mu of them (by front, then by crowding distance) form the
+ * next population. The surviving offspring take the places of the
+ * discarded individuals, so the population keeps its ids and memory.
+ *
+ * @return Nothing (void)
+ */
+void GA::survival_selection(void)
+{
+    GAIM_PROFILE_START(t);
+    size_t n = mu + offsprings.size(), m = num_objectives;
+
+    objective_matrix.resize(n * m);
+    for (size_t i = 0; i < n; ++i) {
+        const individual_s &ind = (i < mu) ? population[i] : offsprings[i - mu];
+        std::copy(ind.objectives.begin(), ind.objectives.end(),
+                  objective_matrix.begin() + i * m);
+    }
+    std::vector<REAL_> fit = crowded_fitness(&objective_matrix[0], n, m);
+
+    std::vector<size_t> order(n);
+    std::vector<bool> survives(n, false);
+    std::iota(order.begin(), order.end(), 0);
+    std::nth_element(order.begin(), order.begin() + (mu - 1), order.end(),
+                     [&](size_t a, size_t b) { return fit[a] > fit[b]; });
+    for (size_t i = 0; i < mu; ++i) {
+        survives[order[i]] = true;
+    }
+
+    for (size_t i = 0, j = mu; i < mu; ++i) {
+        if (survives[i]) {
+            population[i].fitness = fit[i];
+            continue;
+        }
+        while (!survives[j]) {
+            ++j;
+        }
+        const individual_s &child = offsprings[j - mu];
+        population[i].genome = child.genome;
+        population[i].objectives = child.objectives;
+        population[i].is_evaluated = child.is_evaluated;
+        population[i].fitness = fit[j];
+        ++j;
+    }
+    GAIM_PROFILE_STOP(profile, t, replacement_ns);
+}
+
+
+/**
+ * Returns the non-dominated individuals of a set (the evaluated ones with
+ * objectives), without duplicated genomes.
+ *
+ * @param[in] x Individuals (e.g., the populations of the islands)
+ * @return The Pareto front of x
+ */
+std::vector<individual_s> pareto_front(const std::vector<individual_s> &x)
+{
+    std::vector<const individual_s *> ranked;
+    std::vector<individual_s> front;
+    std::vector<REAL_> obj;
+
+    for (auto &ind : x) {
+        if (ind.is_evaluated && !ind.objectives.empty()) {
+            ranked.push_back(&ind);
+            obj.insert(obj.end(), ind.objectives.begin(), ind.objectives.end());
+        }
+    }
+    if (ranked.empty()) {
+        return front;
+    }
+    size_t m = ranked[0]->objectives.size();
+    std::vector<size_t> rank = non_dominated_sort(&obj[0], ranked.size(), m);
+    for (size_t i = 0; i < ranked.size(); ++i) {
+        if (rank[i] == 0) {
+            front.push_back(*ranked[i]);
+        }
+    }
+
+    auto by_genome = [](const individual_s &a, const individual_s &b) {
+        return a.genome < b.genome;
+    };
+    auto same_genome = [](const individual_s &a, const individual_s &b) {
+        return a.genome == b.genome;
+    };
+    std::sort(front.begin(), front.end(), by_genome);
+    front.erase(std::unique(front.begin(), front.end(), same_genome),
+                front.end());
+    return front;
+}
+
+
+/**
+ * Returns the non-dominated individuals of the population.
+ *
+ * @return The Pareto front of the population
+ */
+std::vector<individual_s> GA::get_pareto_front(void) const
+{
+    return pareto_front(population);
+}
+
+
+/**
+ * Stores a Pareto front in results, the genomes and the objectives row-wise.
+ *
+ * @param[in] front Pareto front (see pareto_front)
+ * @param[out] res Results
+ * @return Nothing (void)
+ */
+void pack_pareto_front(const std::vector<individual_s> &front, ga_results_s &res)
+{
+    res.pareto_genomes.clear();
+    res.pareto_objectives.clear();
+    for (auto &ind : front) {
+        res.pareto_genomes.insert(res.pareto_genomes.end(),
+                                  ind.genome.begin(), ind.genome.end());
+        res.pareto_objectives.insert(res.pareto_objectives.end(),
+                                     ind.objectives.begin(),
+                                     ind.objectives.end());
+    }
+}
+
+GAIM_END_NAMESPACE
@@ -26,6 +26,8 @@
 // $Log$
 #include "gaim.h"
 
+GAIM_BEGIN_NAMESPACE
+
 
 /**
  * @brief Assigns the appropriate mutation operator to the pointer function
@@ -53,7 +55,7 @@ void GA::select_mutation_method(void) {
         mutation = &GA::swap_mutation;
     } else {
         std::cout << "Error: GA Mutation method not found!" << std::endl;
-        exit(-1);
+        fatal_error();
     }
 }
 
@@ -64,25 +66,18 @@ void GA::select_mutation_method(void) {
  * distribution and it is added to the gene value according to a probability.
  * Specifically, the mutation delta is drawn from the Normal/Gaussian distribution
  * with mean 0 and standard deviation defined by the argument variance.
+ * The random numbers are drawn GAIM_VLANES at a time by the vectorized RNG.
  *
  * @param[in] genome The genome (genes) of an individual
  * @return A vector of floats (mutated genome)
+ *
+ * @see simd_delta_mutation()
  */
 std::vector<REAL_> GA::delta_mutation(std::vector<REAL_> genome)
 {
-    std::vector<REAL_> tmp;
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> probs(0, 1);
-    static std::normal_distribution<> delta(0, variance);
-
-    tmp = genome;
-    for (size_t i = 0; i < genome.size(); ++i) {
-        if (probs(gen) <= mutation_rate) {
-            tmp[i] += delta(gen);
-        }
-    }
-    return tmp;
+    simd_delta_mutation(&genome[0], genome.size(), mutation_rate, variance,
+                        &vrng);
+    return genome;
 }
 
 
@@ -98,48 +93,17 @@ std::vector<REAL_> GA::delta_mutation(std::vector<REAL_> genome)
  */
 std::vector<REAL_> GA::random_mutation(std::vector<REAL_> genome)
 {
-    std::vector<REAL_> mutated_genome;
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> U(0, genome.size());
+    size_t idx = vrng_bounded(&vrng, genome.size());
 
-    mutated_genome = genome;
     if (is_real) {
-        static std::uniform_real_distribution<> R(low_bound, up_bound);
-        mutated_genome[U(gen)] = R(gen);
+        genome[idx] = low_bound + (up_bound - low_bound) * vrng_real(&vrng);
     } else {
         int a, b;
         a = (int) low_bound;
         b = (int) up_bound;
-        static std::uniform_int_distribution<> R(a, b);
-        mutated_genome[U(gen)] = R(gen);
+        genome[idx] = a + (int) vrng_bounded(&vrng, b - a + 1);
     }
-    return mutated_genome;
-}
-
-
-/**
- * @brief Auxiliary function for decaying mutation, used in time-dependent 
- * non-uniform mutation.
- *
- * Performs the following operation
- * \f[ x (1 - \lambda^{{1 - \frac{t}{t_{tot}}}^r})  \f]  [1]
- *
- * @param[in] x Gene's numerical value
- * @param[in] time Current time step (generation)
- * @param[in] tot_time Total number of time steps (generations)
- * @param[in] r Magnitude of order that the LHS of [1] affects the mutation
- *
- * @return A mutated gene value.
- */
-REAL_ delta(REAL_ x, size_t time, size_t tot_time, size_t r=1)
-{
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_real_distribution<> U(0, 1);
-
-    REAL_ L = U(gen);
-    return x * (1 - pow(L, pow(1 - time / tot_time, r)));
+    return genome;
 }
 
 
@@ -149,31 +113,31 @@ REAL_ delta(REAL_ x, size_t time, size_t tot_time, size_t r=1)
  * Performs a non-uniform mutation which is time-dependent, decaying over 
  * time (generations). The mutation is computed as
  * \f$ \Delta(b - x) \f$ or \f$\Delta(x - a) \f$
- * based on a random choice between -1 or 1, respectively. 
+ * based on a random choice between -1 or 1, respectively, where 
+ * \f[ \Delta(y) = y (1 - \lambda^{{1 - \frac{t}{t_{tot}}}^r}) \f]
+ * with \f$ \lambda \f$ uniform in (0, 1], t the current generation, 
+ * \f$ t_{tot} \f$ the total number of generations and r the order.
  * 
  * @param[in] genome Individual's genome
  * @return A mutated genome.
  *
+ * @see simd_nonuniform_mutation()
  */
 std::vector<REAL_> GA::nonuniform_mutation(std::vector<REAL_> genome)
 {
-    std::vector<REAL_> mutated_genome;
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::uniform_int_distribution<> U(-1, 1);
+    REAL_ t = generations ? static_cast<REAL_>(current_generation) / generations : 1;
+    REAL_ exponent = pow(1 - std::min(t, REAL_(1)), order);
 
-    mutated_genome = genome;
-    size_t sign = U(gen);
+    // Draws -1, 0, or 1
+    int sign = static_cast<int>(vrng_bounded(&vrng, 3)) - 1;
     if (sign == 1) {
-        for (auto &g : mutated_genome) {
-            g += delta(up_bound - g, current_generation, generations, order);
-        }
+        simd_nonuniform_mutation(&genome[0], genome.size(), up_bound,
+                                 exponent, &vrng);
     } else {
-        for (auto &g : mutated_genome) {
-            g -= delta(g - low_bound, current_generation, generations, order);
-        }
+        simd_nonuniform_mutation(&genome[0], genome.size(), low_bound,
+                                 exponent, &vrng);
     }
-    return mutated_genome;
+    return genome;
 }
 
 
@@ -195,7 +159,8 @@ std::vector<REAL_> GA::fusion_mutation(std::vector<REAL_> genome)
     static std::mt19937 gen(rd());
 
     mutated_genome = genome;
-    std::set<REAL_> unique_genome;
+    std::set<REAL_, std::less<REAL_>, arena_allocator<REAL_>>
+        unique_genome{std::less<REAL_>(), arena_allocator<REAL_>(&arena)};
     if (is_real) {
         static std::uniform_real_distribution<> R(low_bound, up_bound);
         for (size_t i = 0; i < mutated_genome.size(); ++i) {
@@ -249,3 +214,5 @@ std::vector<REAL_> GA::swap_mutation(std::vector<REAL_> genome)
     std::swap(mutated_genome[idx_a], mutated_genome[idx_b]);
     return mutated_genome;   
 }
+
+GAIM_END_NAMESPACE
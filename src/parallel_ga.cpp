@@ -25,6 +25,9 @@
 // $Log$
 #include "gaim.h"
 #include <thread>
+#include <memory>
+
+GAIM_BEGIN_NAMESPACE
 
 
 /**
@@ -47,19 +50,34 @@ ga_results independent_runs(REAL_ (*func)(REAL_ *, size_t),
                             pr_parameter_s *pr_pms,
                             std::string return_type)
 {
-    std::vector<GA> ind_population(ga_pms->runs, GA(ga_pms));
+    std::vector<GA> ind_population;
     std::vector<std::thread> run;
-    ga_results_s best_results;
 
-    /// Create the data directory if it doesn't exist
-    if (make_dir(pr_pms->where2write)) {
-        std::cout << "ERROR: Cannot create directory " << pr_pms->where2write << "\n";
-        exit(-1);
+    /// Every run is constructed in place with its own initial population
+    ind_population.reserve(ga_pms->runs);
+    for (int i = 0; i < ga_pms->runs; ++i) {
+        ind_population.emplace_back(ga_pms);
     }
 
-    /// Set the fitness function for every run
+    /// Set the fitness function and an independent RNG stream for every run
+    std::random_device rd;
     for (int i = 0; i < ga_pms->runs; ++i) {
         ind_population[i].fitness = func;
+        vrng_seed(&ind_population[i].vrng,
+                  (static_cast<uint64_t>(rd()) << 32) | rd());
+    }
+
+    /// Live metrics (one slot per run)
+    std::unique_ptr<MetricsExporter> exporter;
+    if (!pr_pms->metrics_target.empty()) {
+        exporter.reset(new MetricsExporter(pr_pms->metrics_target,
+                                           pr_pms->metrics_period_ms,
+                                           ga_pms->runs,
+                                           pr_pms->experiment_name));
+        for (int i = 0; i < ga_pms->runs; ++i) {
+            ind_population[i].metrics = exporter->slot(i);
+        }
+        exporter->start();
     }
 
     /// Instantiate threads and GAs
@@ -75,8 +93,15 @@ ga_results independent_runs(REAL_ (*func)(REAL_ *, size_t),
     for(std::thread& th : run) {
         if (th.joinable()) { th.join(); }
 	}
+    if (exporter) {
+        exporter->stop();
+        for (int i = 0; i < ga_pms->runs; ++i) {
+            ind_population[i].metrics = nullptr;
+        }
+    }
 
     /// Choose from all the runs which genome to return
-    best_results = return_best_results(ind_population, return_type);
-    return best_results;
+    return return_best_results(std::move(ind_population), return_type);
 }
+
+GAIM_END_NAMESPACE
@@ -27,6 +27,8 @@
 
 using namespace libconfig;
 
+GAIM_BEGIN_NAMESPACE
+
 
 /**
  * @brief Reads GAIM config files containing Genetic Algorithm, Island Model 
@@ -70,13 +72,13 @@ std::tuple<ga_parameter_s,
     catch(const FileIOException &fioex)
         {
             std::cerr << "I/O error while reading file." << std::endl;
-            exit(-1);
+            fatal_error();
         }
     catch(const ParseException &pex)
         {
             std::cerr << "Parse error at " << pex.getFile() << ":" << pex.getLine()
                       << " - " << pex.getError() << std::endl;
-            exit(-1);
+            fatal_error();
         }
 
     // Get the simulation name.
@@ -127,7 +129,7 @@ std::tuple<ga_parameter_s,
                         (num_offsprings <= 0) || (genome_size <= 0) || 
                         (num_replacement < 0)){
                     std::cerr << "Negative parameters detected!" << std::endl;
-                    exit(-1);
+                    fatal_error();
                 } 
 
                 tmp.runs = runs;
@@ -136,12 +138,12 @@ std::tuple<ga_parameter_s,
                 tmp.num_offsprings = num_offsprings;
                 if (num_offsprings >= population_size) {
                     std::cerr << "Number of offsprings cannot exceed population size!" << std::endl;
-                    exit(-1);
+                    fatal_error();
                 }
                 tmp.genome_size = genome_size;
                 if (genome_size < 1) { 
                     std::cerr << "Genome size cannot be smaller than 1!" << std::endl;
-                    exit(-1);
+                    fatal_error();
                 }
                 tmp.num_replacement = num_replacement;
                 tmp.clipping = clipping;
@@ -149,6 +151,90 @@ std::tuple<ga_parameter_s,
             }
             tmp.a = tmp_a;
             tmp.b = tmp_b;
+
+            // Statistics recording policy (optional)
+            std::string record_policy;
+            int record_interval, record_capacity;
+            if (ga.lookupValue("record_policy", record_policy)) {
+                tmp.record_policy = record_policy;
+            }
+            if (ga.lookupValue("record_interval", record_interval)) {
+                tmp.record_interval = record_interval;
+            }
+            if (ga.lookupValue("record_capacity", record_capacity)) {
+                tmp.record_capacity = record_capacity;
+            }
+
+            // Initialization method (optional)
+            std::string init_method;
+            if (ga.lookupValue("init_method", init_method)) {
+                tmp.init_method = init_method;
+            }
+
+            // Seed genomes file of a warm start (optional)
+            std::string seed_fname;
+            if (ga.lookupValue("seed_fname", seed_fname)) {
+                tmp.seed_fname = seed_fname;
+            }
+
+            // Surrogate-assisted evaluation (optional)
+            std::string surrogate;
+            if (ga.lookupValue("surrogate", surrogate)) {
+                tmp.surrogate = surrogate;
+            }
+            double surrogate_fraction;
+            if (ga.lookupValue("surrogate_fraction", surrogate_fraction)) {
+                tmp.surrogate_fraction = surrogate_fraction;
+            }
+            int surrogate_k, surrogate_archive;
+            if (ga.lookupValue("surrogate_k", surrogate_k)) {
+                if (surrogate_k < 1) {
+                    std::cerr << "The surrogate k must be positive!" << std::endl;
+                    fatal_error();
+                }
+                tmp.surrogate_k = surrogate_k;
+            }
+            if (ga.lookupValue("surrogate_archive", surrogate_archive)) {
+                if (surrogate_archive < 1) {
+                    std::cerr << "The surrogate archive must be positive!" << std::endl;
+                    fatal_error();
+                }
+                tmp.surrogate_archive = surrogate_archive;
+            }
+
+            // Time budget of a fitness evaluation (optional)
+            int eval_timeout_ms;
+            if (ga.lookupValue("eval_timeout_ms", eval_timeout_ms)) {
+                if (eval_timeout_ms < 0) {
+                    std::cerr << "Negative parameters detected!" << std::endl;
+                    fatal_error();
+                }
+                tmp.eval_timeout_ms = eval_timeout_ms;
+            }
+            double timeout_penalty;
+            if (ga.lookupValue("timeout_penalty", timeout_penalty)) {
+                tmp.timeout_penalty = timeout_penalty;
+            }
+
+            // Number of objectives (optional, multi-objective mode)
+            int num_objectives;
+            if (ga.lookupValue("num_objectives", num_objectives)) {
+                if (num_objectives < 1) {
+                    std::cerr << "The number of objectives must be positive!" << std::endl;
+                    fatal_error();
+                }
+                tmp.num_objectives = num_objectives;
+            }
+
+            // Elitism (optional)
+            int elitism;
+            if (ga.lookupValue("elitism", elitism)) {
+                if (elitism < 0) {
+                    std::cerr << "Negative parameters detected!" << std::endl;
+                    fatal_error();
+                }
+                tmp.elitism = elitism;
+            }
             
             // Selection parameters
             if (sel.lookupValue("selection_method", method) &&
@@ -205,6 +291,22 @@ std::tuple<ga_parameter_s,
 
             }
 
+            // Profile dump interval (optional, GAIM_PROFILE builds)
+            int profile_interval;
+            if (pr.lookupValue("profile_interval", profile_interval)) {
+                print_tmp.profile_interval = profile_interval;
+            }
+
+            // Live metrics export (optional)
+            std::string metrics_target;
+            int metrics_period_ms;
+            if (pr.lookupValue("metrics_target", metrics_target)) {
+                print_tmp.metrics_target = metrics_target;
+            }
+            if (pr.lookupValue("metrics_period_ms", metrics_period_ms)) {
+                print_tmp.metrics_period_ms = metrics_period_ms;
+            }
+
             // IM parameters 
             if (im.lookupValue("im_enabled", im_enabled) &&
                 im.lookupValue("number_of_immigrants", num_immigrants) &&
@@ -223,9 +325,28 @@ std::tuple<ga_parameter_s,
                 island_tmp.adj_list_fname = adj_list_fname;
             }
 
+            // IM topology policy (optional)
+            int rewiring_interval, rewiring_degree;
+            std::string topology_method;
+            if (im.lookupValue("topology_method", topology_method)) {
+                island_tmp.topology_method = topology_method;
+            }
+            if (im.lookupValue("rewiring_interval", rewiring_interval)) {
+                island_tmp.rewiring_interval = rewiring_interval;
+            }
+            if (im.lookupValue("rewiring_degree", rewiring_degree)) {
+                island_tmp.rewiring_degree = rewiring_degree;
+            }
+            if (im.exists("topology_epoch_files")) {
+                const Setting &epoch_cfg = im.lookup("topology_epoch_files");
+                for (int n = 0; n < epoch_cfg.getLength(); ++n) {
+                    island_tmp.epoch_graph_fnames.push_back(epoch_cfg[n].c_str());
+                }
+            }
+
             if (island_tmp.is_im_enabled && tmp.runs > 1) {
                 std::cerr << "Is not allowed to use more than 1 runs when IM is enabled!" << std::endl;
-                exit(-1);
+                fatal_error();
             } 
 
             if (island_tmp.is_im_enabled) {
@@ -233,11 +354,6 @@ std::tuple<ga_parameter_s,
                     print_tmp.where2write = "./results";
                 }
             }
-
-            if (make_dir(print_tmp.where2write)) {
-                std::cout << "ERROR: Cannot create directory " << print_tmp.where2write << "\n";
-                exit(-1);
-            }
         }
         catch(const SettingNotFoundException &nfex)
         {
@@ -269,6 +385,8 @@ void print_parameters(ga_parameter_s ga_pms,
         std::cout << pr_pms.experiment_name << std::endl;
         std::cout << std::string(20, '*') << std::endl;
         std::cout << "Indepenent Runs: " << ga_pms.runs << std::endl;
+        std::cout << "Precision: " << GAIM_PRECISION << " ("
+            << sizeof(REAL_) << " bytes)" << std::endl;
         std::cout << "#Generations: " << ga_pms.generations << std::endl;
         std::cout << "#Individuals: " << ga_pms.population_size << std::endl;
         std::cout << "Genome Size: " << ga_pms.genome_size << std::endl;
@@ -277,6 +395,19 @@ void print_parameters(ga_parameter_s ga_pms,
         std::cout << "Clipping: " << ga_pms.clipping << std::endl;
         std::cout << "Clipping Values File: " << ga_pms.clipping_fname
             << std::endl;
+        std::cout << "Elitism: " << ga_pms.elitism << std::endl;
+        std::cout << "Initialization: " << ga_pms.init_method << std::endl;
+        std::cout << "Seed Genomes: " << ga_pms.seed_genomes.size() / ga_pms.genome_size
+            << " (file: " << ga_pms.seed_fname << ")" << std::endl;
+        std::cout << "Surrogate: " << ga_pms.surrogate << " (fraction "
+            << ga_pms.surrogate_fraction << ", k " << ga_pms.surrogate_k
+            << ", archive " << ga_pms.surrogate_archive << ")" << std::endl;
+        std::cout << "Evaluation timeout (ms): " << ga_pms.eval_timeout_ms
+            << " (penalty " << ga_pms.timeout_penalty << ")" << std::endl;
+        std::cout << "Objectives: " << ga_pms.num_objectives << std::endl;
+        std::cout << "Record policy: " << ga_pms.record_policy << " (interval "
+            << ga_pms.record_interval << ", capacity " << ga_pms.record_capacity
+            << ")" << std::endl;
         std::cout << "Selection method: " << ga_pms.sel_pms.selection_method
             << std::endl;
         std::cout << "Selection bias: " << ga_pms.sel_pms.bias << std::endl;
@@ -310,6 +441,10 @@ void print_parameters(ga_parameter_s ga_pms,
         std::cout << "Print BSF: " << pr_pms.print_bsf << std::endl;
         std::cout << "Print best genome: " << pr_pms.print_best_genome
             << std::endl;
+        std::cout << "Profile interval: " << pr_pms.profile_interval
+            << std::endl;
+        std::cout << "Metrics target: " << pr_pms.metrics_target
+            << " (every " << pr_pms.metrics_period_ms << " ms)" << std::endl;
         std::cout << "Island Model is " << im_pms.is_im_enabled << std::endl;
         std::cout << "#Islands: " << im_pms.num_islands << std::endl;
         std::cout << "#Immigrants: " << im_pms.num_immigrants << std::endl;
@@ -319,9 +454,17 @@ void print_parameters(ga_parameter_s ga_pms,
             << std::endl;
         std::cout << "Replace individuals method: " << im_pms.replace_method
             << std::endl;
+        std::cout << "Topology method: " << im_pms.topology_method << std::endl;
+        std::cout << "Rewiring interval: " << im_pms.rewiring_interval << std::endl;
+        std::cout << "Rewiring degree: " << im_pms.rewiring_degree << std::endl;
         std::cout << std::string(20, '*') << std::endl;
         std::cout << "" << std::endl;
     }else{
+        if (make_dir(pr_pms.where2write)) {
+            std::cerr << "Cannot create the directory "+pr_pms.where2write+"!"
+                << std::endl;
+            return;
+        }
         auto ofile = std::fstream(pr_pms.where2write+pr_pms.experiment_name+".dat",
                                   std::ios::out);
         ofile << "" << std::endl;
@@ -329,6 +472,8 @@ void print_parameters(ga_parameter_s ga_pms,
         ofile << pr_pms.experiment_name << std::endl;
         ofile << std::string(20, '*') << std::endl;
         ofile << "Indepenent Runs: " << ga_pms.runs << std::endl;
+        ofile << "Precision: " << GAIM_PRECISION << " ("
+            << sizeof(REAL_) << " bytes)" << std::endl;
         ofile << "#Generations: " << ga_pms.generations << std::endl;
         ofile << "#Individuals: " << ga_pms.population_size << std::endl;
         ofile << "Genome Size: " << ga_pms.genome_size << std::endl;
@@ -336,6 +481,19 @@ void print_parameters(ga_parameter_s ga_pms,
         ofile << "#Replacements: " << ga_pms.num_replacement << std::endl;
         ofile << "Clipping: " << ga_pms.clipping << std::endl;
         ofile << "Clipping Values File: " << ga_pms.clipping_fname << std::endl;
+        ofile << "Elitism: " << ga_pms.elitism << std::endl;
+        ofile << "Initialization: " << ga_pms.init_method << std::endl;
+        ofile << "Seed Genomes: " << ga_pms.seed_genomes.size() / ga_pms.genome_size
+            << " (file: " << ga_pms.seed_fname << ")" << std::endl;
+        ofile << "Surrogate: " << ga_pms.surrogate << " (fraction "
+            << ga_pms.surrogate_fraction << ", k " << ga_pms.surrogate_k
+            << ", archive " << ga_pms.surrogate_archive << ")" << std::endl;
+        ofile << "Evaluation timeout (ms): " << ga_pms.eval_timeout_ms
+            << " (penalty " << ga_pms.timeout_penalty << ")" << std::endl;
+        ofile << "Objectives: " << ga_pms.num_objectives << std::endl;
+        ofile << "Record policy: " << ga_pms.record_policy << " (interval "
+            << ga_pms.record_interval << ", capacity " << ga_pms.record_capacity
+            << ")" << std::endl;
         ofile << "Selection method: " << ga_pms.sel_pms.selection_method
             << std::endl;
         ofile << "Selection bias: " << ga_pms.sel_pms.bias << std::endl;
@@ -367,6 +525,10 @@ void print_parameters(ga_parameter_s ga_pms,
         ofile << "Print BSF: " << pr_pms.print_bsf << std::endl;
         ofile << "Print best genome: " << pr_pms.print_best_genome
             << std::endl;
+        ofile << "Profile interval: " << pr_pms.profile_interval
+            << std::endl;
+        ofile << "Metrics target: " << pr_pms.metrics_target
+            << " (every " << pr_pms.metrics_period_ms << " ms)" << std::endl;
         ofile << "Island Model is " << im_pms.is_im_enabled << std::endl;
         ofile << "#Islands: " << im_pms.num_islands << std::endl;
         ofile << "#Immigrants: " << im_pms.num_immigrants << std::endl;
@@ -376,8 +538,13 @@ void print_parameters(ga_parameter_s ga_pms,
             << std::endl;
         ofile << "Replace individuals method: " << im_pms.replace_method
             << std::endl;
+        ofile << "Topology method: " << im_pms.topology_method << std::endl;
+        ofile << "Rewiring interval: " << im_pms.rewiring_interval << std::endl;
+        ofile << "Rewiring degree: " << im_pms.rewiring_degree << std::endl;
         ofile << std::string(20, '*') << std::endl;
         ofile << "" << std::endl;
         ofile.close();
     }
 }
+
+GAIM_END_NAMESPACE
@@ -0,0 +1,757 @@
+/* Out-of-process fitness evaluation cpp file for GAIM software
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file process_evaluator.cpp
+ * Implements a pool of worker processes that evaluate the fitness function
+ * out of process. The genomes and the costs are exchanged through a shared
+ * memory block per worker, and a socket carries the number of genomes of a
+ * request (and its completion). A worker that dies (crash, abort, killed
+ * after a time budget) is restarted, so the fitness function cannot bring
+ * down the optimization. Forked workers are started by a spawner process,
+ * forked while the process is still single-threaded, so a restart never
+ * forks a multithreaded process.
+ */
+// $Log$
+#include "gaim.h"
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <csignal>
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+GAIM_BEGIN_NAMESPACE
+
+/// File descriptor of the socket of a command worker
+static const int worker_fd = 3;
+/// File descriptor of the shared memory of a command worker
+static const int worker_shm_fd = 4;
+
+
+/**
+ * @brief Request to the spawner of the forked workers. A spawn request
+ * carries the socket of the worker (SCM_RIGHTS); the spawner replies with
+ * the pid of the worker (or 0 once a worker is killed).
+ */
+typedef struct spawn_request {
+    uint64_t kill;      /**< Kill worker pid instead of starting worker index */
+    uint64_t index;     /**< Worker to start (its shared memory) */
+    int64_t pid;        /**< Worker to kill */
+} spawn_request_s;
+
+
+/**
+ * Writes a whole buffer to a socket (without raising SIGPIPE).
+ */
+static bool send_all(int fd, const void *buf, size_t len)
+{
+    const char *p = static_cast<const char *>(buf);
+    while (len) {
+        ssize_t k = send(fd, p, len, MSG_NOSIGNAL);
+        if (k < 0 && errno == EINTR) {
+            continue;
+        }
+        if (k <= 0) {
+            return false;
+        }
+        p += k;
+        len -= k;
+    }
+    return true;
+}
+
+
+/**
+ * Reads a whole buffer from a file descriptor. Returns false on an error or
+ * if the other end is closed.
+ */
+static bool read_all(int fd, void *buf, size_t len)
+{
+    char *p = static_cast<char *>(buf);
+    while (len) {
+        ssize_t k = read(fd, p, len);
+        if (k < 0 && errno == EINTR) {
+            continue;
+        }
+        if (k <= 0) {
+            return false;
+        }
+        p += k;
+        len -= k;
+    }
+    return true;
+}
+
+
+/**
+ * Sends a spawn request, and a file descriptor along with it (if fd >= 0).
+ */
+static bool send_request(int ctl, const spawn_request_s &req, int fd)
+{
+    struct msghdr msg;
+    struct iovec iov;
+    char control[CMSG_SPACE(sizeof(int))];
+
+    std::memset(&msg, 0, sizeof(msg));
+    std::memset(control, 0, sizeof(control));
+    iov.iov_base = const_cast<spawn_request_s *>(&req);
+    iov.iov_len = sizeof(req);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (fd >= 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    }
+    ssize_t k;
+    do {
+        k = sendmsg(ctl, &msg, MSG_NOSIGNAL);
+    } while (k < 0 && errno == EINTR);
+    return k == static_cast<ssize_t>(sizeof(req));
+}
+
+
+/**
+ * Receives a spawn request and the file descriptor sent along with it (-1
+ * if none). Returns false once the other end is closed.
+ */
+static bool recv_request(int ctl, spawn_request_s &req, int &fd)
+{
+    struct msghdr msg;
+    struct iovec iov;
+    char control[CMSG_SPACE(sizeof(int))];
+
+    std::memset(&msg, 0, sizeof(msg));
+    iov.iov_base = &req;
+    iov.iov_len = sizeof(req);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    fd = -1;
+    ssize_t k;
+    do {
+        k = recvmsg(ctl, &msg, 0);
+    } while (k < 0 && errno == EINTR);
+    struct cmsghdr *cmsg = (k > 0) ? CMSG_FIRSTHDR(&msg) : NULL;
+    if (cmsg && cmsg->cmsg_level == SOL_SOCKET &&
+        cmsg->cmsg_type == SCM_RIGHTS) {
+        std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    }
+    return k == static_cast<ssize_t>(sizeof(req));
+}
+
+
+/**
+ * Waits for child processes to exit, and kills the ones still running after
+ * timeout_ms.
+ */
+static void reap(std::vector<pid_t> &pids, int timeout_ms)
+{
+    for (int k = 0; k < timeout_ms / 10; ++k) {
+        bool running = false;
+        for (auto &pid : pids) {
+            if (pid > 0 && waitpid(pid, NULL, WNOHANG) == 0) {
+                running = true;
+            } else {
+                pid = -1;
+            }
+        }
+        if (!running) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    for (auto &pid : pids) {
+        if (pid > 0) {
+            kill(pid, SIGKILL);
+            waitpid(pid, NULL, 0);
+            pid = -1;
+        }
+    }
+}
+
+
+/**
+ * Returns the number of threads of the process (0 if unknown).
+ */
+static size_t count_threads(void)
+{
+    DIR *dir = opendir("/proc/self/task");
+    size_t n = 0;
+
+    if (!dir) {
+        return 0;
+    }
+    while (struct dirent *entry = readdir(dir)) {
+        if (entry->d_name[0] != '.') {
+            ++n;
+        }
+    }
+    closedir(dir);
+    return n;
+}
+
+
+/**
+ * Serves the evaluation requests of the parent until it closes the socket.
+ *
+ * @param[in] fd Socket of the worker
+ * @param[in] genomes Shared genomes (capacity x genome_size)
+ * @param[out] costs Shared costs (capacity)
+ * @param[in] genome_size Number of genes
+ * @param[in] capacity Maximum number of genomes of a request
+ * @param[in] func Fitness function
+ * @return 0 once the parent is done, -1 on a protocol error
+ */
+static int serve_requests(int fd, REAL_ *genomes, REAL_ *costs,
+                          size_t genome_size, size_t capacity,
+                          REAL_ (*func)(REAL_ *, size_t))
+{
+    uint64_t n;
+
+    while (read_all(fd, &n, sizeof(n))) {
+        if (n > capacity) {
+            return -1;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            costs[i] = func(&genomes[i * genome_size], genome_size);
+        }
+        if (!send_all(fd, &n, sizeof(n))) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Main loop of a worker started by a command (see ProcessEvaluator). It maps
+ * the shared memory inherited as file descriptor 4 and evaluates the
+ * requests received on file descriptor 3 with func, until the optimization
+ * is done.
+ *
+ * @param[in] func Fitness function
+ * @return 0 once the optimization is done, -1 on error
+ */
+int GAIM_C_NAME(gaim_worker_serve)(REAL_ (*func)(REAL_ *, size_t))
+{
+    struct stat st;
+
+    if (fstat(worker_shm_fd, &st) < 0 ||
+        static_cast<size_t>(st.st_size) < sizeof(worker_header_s)) {
+        std::cerr << "ERROR: No shared memory of the worker (it must be "
+                     "started by a ProcessEvaluator)!" << std::endl;
+        return -1;
+    }
+    size_t size = st.st_size;
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      worker_shm_fd, 0);
+    close(worker_shm_fd);
+    if (base == MAP_FAILED) {
+        std::cerr << "ERROR: Cannot map the shared memory of the worker!"
+                  << std::endl;
+        return -1;
+    }
+
+    const worker_header_s *header = static_cast<worker_header_s *>(base);
+    size_t genome_size = header->genome_size;
+    size_t capacity = header->capacity;
+    if (std::memcmp(header->magic, "GAIMWORK", 8) || header->version != 1 ||
+        header->value_size != sizeof(REAL_) ||
+        size < sizeof(worker_header_s) +
+               capacity * (genome_size + 1) * sizeof(REAL_)) {
+        munmap(base, size);
+        std::cerr << "ERROR: Incompatible shared memory of the worker (check "
+                     "the precision)!" << std::endl;
+        return -1;
+    }
+    REAL_ *genomes = reinterpret_cast<REAL_ *>(static_cast<char *>(base) +
+                                               sizeof(worker_header_s));
+    int res = serve_requests(worker_fd, genomes,
+                             genomes + capacity * genome_size, genome_size,
+                             capacity, func);
+    munmap(base, size);
+    return res;
+}
+
+
+/**
+ * Constructor of a pool of forked workers running a fitness function.
+ *
+ * @param[in] num_workers Number of workers (0 for one per hardware thread)
+ * @param[in] genome_size Number of genes
+ * @param[in] func Fitness function
+ * @param[in] capacity Maximum number of genomes of a request
+ */
+ProcessEvaluator::ProcessEvaluator(size_t num_workers,
+                                   size_t genome_size,
+                                   REAL_ (*func)(REAL_ *, size_t),
+                                   size_t capacity) :
+    crash_penalty(-std::numeric_limits<REAL_>::max()),
+    genome_size(genome_size),
+    func(func),
+    restarts(0)
+{
+    if (!func) {
+        std::cerr << "ERROR: The workers need a fitness function!" << std::endl;
+        exit(-1);
+    }
+    create(num_workers, capacity);
+}
+
+
+/**
+ * Constructor of a pool of workers running a command through /bin/sh. The
+ * command serves the requests with gaim_worker_serve (C/C++) or
+ * pygaim.worker.serve (Python).
+ *
+ * @param[in] num_workers Number of workers (0 for one per hardware thread)
+ * @param[in] genome_size Number of genes
+ * @param[in] command Worker command
+ * @param[in] capacity Maximum number of genomes of a request
+ */
+ProcessEvaluator::ProcessEvaluator(size_t num_workers,
+                                   size_t genome_size,
+                                   const std::string &command,
+                                   size_t capacity) :
+    crash_penalty(-std::numeric_limits<REAL_>::max()),
+    genome_size(genome_size),
+    func(nullptr),
+    command(command),
+    restarts(0)
+{
+    if (command.empty()) {
+        std::cerr << "ERROR: The workers need a command!" << std::endl;
+        exit(-1);
+    }
+    create(num_workers, capacity);
+}
+
+
+/**
+ * Destructor. Closing the sockets ends the workers; the ones still running
+ * after a second are killed (by the spawner for forked workers).
+ */
+ProcessEvaluator::~ProcessEvaluator()
+{
+    std::vector<pid_t> pids;
+
+    for (auto &w : workers) {
+        if (w.fd >= 0) {
+            close(w.fd);
+        }
+        close(w.shm_fd);
+        if (spawner_pid < 0) {
+            pids.push_back(w.pid);
+        }
+    }
+    if (spawner_pid > 0) {
+        close(spawner_fd);
+        pids.push_back(spawner_pid);
+    }
+    reap(pids, 2000);
+    for (auto &w : workers) {
+        munmap(reinterpret_cast<char *>(w.genomes) - sizeof(worker_header_s),
+               shm_size);
+    }
+}
+
+
+/**
+ * Creates the shared memory of the workers and starts them. The memory files
+ * are removed at once, the workers inherit their file descriptors.
+ *
+ * @param[in] num_workers Number of workers (0 for one per hardware thread)
+ * @param[in] capacity Maximum number of genomes of a request
+ * @return Nothing (void)
+ */
+void ProcessEvaluator::create(size_t num_workers, size_t capacity)
+{
+    if (genome_size < 1 || capacity < 1) {
+        std::cerr << "ERROR: The workers need genome_size and capacity >= 1!"
+                  << std::endl;
+        exit(-1);
+    }
+    if (func && count_threads() > 1) {
+        std::cerr << "ERROR: Forked workers must be created before the "
+                     "process starts any thread (use a worker command "
+                     "otherwise)!" << std::endl;
+        exit(-1);
+    }
+    if (num_workers == 0) {
+        num_workers = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    this->capacity = capacity;
+    shm_size = sizeof(worker_header_s) +
+               capacity * (genome_size + 1) * sizeof(REAL_);
+
+    workers.resize(num_workers);
+    for (auto &w : workers) {
+        char fname[] = "/dev/shm/gaim_worker_XXXXXX";
+        char tmp_fname[] = "/tmp/gaim_worker_XXXXXX";
+        int fd = mkstemp(fname);
+        if (fd >= 0) {
+            unlink(fname);
+        } else if ((fd = mkstemp(tmp_fname)) >= 0) {
+            unlink(tmp_fname);
+        }
+        if (fd < 0 || ftruncate(fd, shm_size) < 0) {
+            std::cerr << "ERROR: Cannot create the shared memory of a worker!"
+                      << std::endl;
+            exit(-1);
+        }
+        void *base = mmap(NULL, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                          fd, 0);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        w.shm_fd = fd;
+        if (base == MAP_FAILED) {
+            std::cerr << "ERROR: Cannot map the shared memory of a worker!"
+                      << std::endl;
+            exit(-1);
+        }
+
+        worker_header_s *header = static_cast<worker_header_s *>(base);
+        std::memcpy(header->magic, "GAIMWORK", 8);
+        header->version = 1;
+        header->value_size = sizeof(REAL_);
+        header->genome_size = genome_size;
+        header->capacity = capacity;
+        w.genomes = reinterpret_cast<REAL_ *>(static_cast<char *>(base) +
+                                              sizeof(worker_header_s));
+        w.costs = w.genomes + capacity * genome_size;
+    }
+
+    // The spawner inherits the shared memory of all the workers
+    if (func) {
+        int sv[2];
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, sv) < 0) {
+            std::cerr << "ERROR: Cannot create the socket of the spawner!"
+                      << std::endl;
+            exit(-1);
+        }
+        fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+        spawner_pid = fork();
+        if (spawner_pid < 0) {
+            std::cerr << "ERROR: Cannot start the spawner!" << std::endl;
+            exit(-1);
+        }
+        if (spawner_pid == 0) {
+            close(sv[0]);
+            serve_spawns(sv[1]);
+        }
+        close(sv[1]);
+        spawner_fd = sv[0];
+    }
+    for (auto &w : workers) {
+        spawn(w);
+    }
+}
+
+
+/**
+ * Main loop of the spawner of the forked workers: it starts a worker for
+ * every spawn request (it runs a single thread, so forking is safe) and
+ * kills the workers on request. Once the parent closes the socket, the
+ * workers are reaped and the spawner exits.
+ *
+ * @param[in] ctl Socket of the spawner
+ * @return Never returns
+ */
+void ProcessEvaluator::serve_spawns(int ctl)
+{
+    std::vector<pid_t> children;
+    spawn_request_s req;
+    int fd;
+
+    while (recv_request(ctl, req, fd)) {
+        int64_t reply = -1;
+        if (!req.kill && fd >= 0 && req.index < workers.size()) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                close(ctl);
+                worker &w = workers[req.index];
+                _exit(serve_requests(fd, w.genomes, w.costs, genome_size,
+                                     capacity, func) ? 1 : 0);
+            }
+            if (pid > 0) {
+                children.push_back(pid);
+            }
+            reply = pid;
+        } else if (req.kill) {
+            auto it = std::find(children.begin(), children.end(), req.pid);
+            if (it != children.end()) {
+                children.erase(it);
+                kill(req.pid, SIGKILL);
+                waitpid(req.pid, NULL, 0);
+                reply = 0;
+            }
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+        if (!send_all(ctl, &reply, sizeof(reply))) {
+            break;
+        }
+    }
+    close(ctl);
+    reap(children, 1000);
+    _exit(0);
+}
+
+
+/**
+ * Starts the process of a worker. A forked worker is started by the spawner
+ * and serves the requests at once; a command gets the socket as file
+ * descriptor 3 and the shared memory as file descriptor 4 (between fork and
+ * exec the child only calls async-signal-safe functions).
+ *
+ * @param[in,out] w Worker
+ * @return Nothing (void)
+ */
+void ProcessEvaluator::spawn(worker &w)
+{
+    int sv[2];
+    pid_t pid;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+        std::cerr << "ERROR: Cannot create the socket of a worker!" << std::endl;
+        exit(-1);
+    }
+    fcntl(sv[0], F_SETFD, FD_CLOEXEC);
+
+    if (func) {
+        spawn_request_s req = {0, static_cast<uint64_t>(&w - &workers[0]), 0};
+        int64_t reply = -1;
+        if (!send_request(spawner_fd, req, sv[1]) ||
+            !read_all(spawner_fd, &reply, sizeof(reply))) {
+            reply = -1;
+        }
+        pid = static_cast<pid_t>(reply);
+    } else {
+        pid = fork();
+        if (pid == 0) {
+            // Moved above 4 first, so neither overwrites the other
+            close(sv[0]);
+            int sock = fcntl(sv[1], F_DUPFD, 10);
+            int shm = fcntl(w.shm_fd, F_DUPFD, 10);
+            close(sv[1]);
+            dup2(sock, worker_fd);
+            dup2(shm, worker_shm_fd);
+            close(sock);
+            close(shm);
+            execl("/bin/sh", "sh", "-c", command.c_str(), (char *) NULL);
+            _exit(127);
+        }
+    }
+    if (pid < 0) {
+        std::cerr << "ERROR: Cannot start a worker!" << std::endl;
+        exit(-1);
+    }
+    close(sv[1]);
+    w.pid = pid;
+    w.fd = sv[0];
+    w.count = 0;
+}
+
+
+/**
+ * Kills a worker (if it is still running) and starts a new one.
+ *
+ * @param[in,out] w Worker
+ * @return Nothing (void)
+ */
+void ProcessEvaluator::restart(worker &w)
+{
+    close(w.fd);
+    w.fd = -1;
+    if (func) {
+        spawn_request_s req = {1, 0, w.pid};
+        int64_t reply;
+        send_request(spawner_fd, req, -1);
+        read_all(spawner_fd, &reply, sizeof(reply));
+    } else {
+        kill(w.pid, SIGKILL);
+        waitpid(w.pid, NULL, 0);
+    }
+    ++restarts;
+    spawn(w);
+}
+
+
+/**
+ * Evaluates a number of genomes with the workers. The genomes are split into
+ * one request per worker (at most capacity genomes each). The request of a
+ * worker that dies is retried genome by genome, and a genome that kills a
+ * worker on its own gets crash_penalty. Within a time budget (see
+ * eval_timeout_ms), every genome is a request of its own with the budget of
+ * a genome (gaim_evaluation_budget_ms); a worker that overruns it is killed
+ * and restarted, and the cost of its genome is left untouched (the GA has
+ * set it to timeout_penalty).
+ *
+ * @param[in] x Genomes stored row-wise (n x genome_size)
+ * @param[in] n Number of genomes
+ * @param[out] costs Costs of the genomes (n)
+ * @return Nothing (void)
+ */
+void ProcessEvaluator::evaluate(const REAL_ *x, size_t n, REAL_ *costs)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    std::deque<std::pair<size_t, size_t>> requests;
+    double budget = GAIM_C_NAME(gaim_evaluation_budget_ms)();
+    bool timed = (budget >= 0);
+    size_t chunk = timed ? 1 :
+        std::min(capacity, (n + workers.size() - 1) / workers.size());
+
+    for (size_t i = 0; i < n; i += chunk) {
+        requests.emplace_back(i, std::min(chunk, n - i));
+    }
+
+    // A worker that died: its request is retried genome by genome
+    auto fail = [&](worker &w) {
+        if (w.count > 1) {
+            for (size_t i = w.count; i-- > 0; ) {
+                requests.emplace_front(w.first + i, 1);
+            }
+        } else {
+            costs[w.first] = crash_penalty;
+        }
+        w.count = 0;
+        restart(w);
+    };
+
+    std::vector<struct pollfd> fds;
+    std::vector<worker *> busy;
+    while (true) {
+        for (auto &w : workers) {
+            if (w.count || requests.empty()) {
+                continue;
+            }
+            uint64_t m = requests.front().second;
+            w.first = requests.front().first;
+            w.count = m;
+            requests.pop_front();
+            std::copy(x + w.first * genome_size,
+                      x + (w.first + m) * genome_size, w.genomes);
+            if (timed) {
+                w.deadline = std::chrono::steady_clock::now() +
+                    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        std::chrono::duration<double, std::milli>(budget));
+            }
+            if (!send_all(w.fd, &m, sizeof(m))) {
+                fail(w);
+            }
+        }
+
+        fds.clear();
+        busy.clear();
+        int timeout = -1;
+        auto now = std::chrono::steady_clock::now();
+        for (auto &w : workers) {
+            if (w.count) {
+                fds.push_back({w.fd, POLLIN, 0});
+                busy.push_back(&w);
+                if (timed) {
+                    std::chrono::duration<double, std::milli> left = w.deadline - now;
+                    int ms = static_cast<int>(std::ceil(std::max(left.count(), 0.0)));
+                    timeout = (timeout < 0) ? ms : std::min(timeout, ms);
+                }
+            }
+        }
+        if (busy.empty()) {
+            if (requests.empty()) {
+                break;
+            }
+            continue;
+        }
+
+        int ready = poll(&fds[0], fds.size(), timeout);
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready < 0) {
+            // Poll failed: give up the evaluation
+            for (auto w : busy) {
+                std::fill(costs + w->first, costs + w->first + w->count,
+                          crash_penalty);
+                w->count = 0;
+                restart(*w);
+            }
+            for (auto &r : requests) {
+                std::fill(costs + r.first, costs + r.first + r.second,
+                          crash_penalty);
+            }
+            break;
+        }
+        now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < fds.size(); ++i) {
+            worker &w = *busy[i];
+            if (!fds[i].revents) {
+                // Time budget of its genome expired: the cost stays as is
+                if (timed && now >= w.deadline) {
+                    w.count = 0;
+                    restart(w);
+                }
+                continue;
+            }
+            uint64_t m;
+            if (read_all(w.fd, &m, sizeof(m)) && m == w.count) {
+                std::copy(w.costs, w.costs + m, costs + w.first);
+                w.count = 0;
+            } else {
+                fail(w);
+            }
+        }
+    }
+}
+
+
+/**
+ * Batch fitness function (see GA::batch_fitness) evaluating the genomes with
+ * the ProcessEvaluator passed as user data (GA::batch_data).
+ *
+ * @param[in] x Genomes stored row-wise (n x genome_size)
+ * @param[in] n Number of genomes
+ * @param[in] genome_size Number of genes
+ * @param[out] costs Costs of the genomes (n)
+ * @param[in] data ProcessEvaluator
+ * @return Nothing (void)
+ */
+void process_batch_fitness(REAL_ *x, size_t n, size_t genome_size,
+                           REAL_ *costs, void *data)
+{
+    (void) genome_size;
+    static_cast<ProcessEvaluator *>(data)->evaluate(x, n, costs);
+}
+
+GAIM_END_NAMESPACE
@@ -0,0 +1,132 @@
+/* Profiling cpp file for GAIM software
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file profiling.cpp
+ * Implements the helpers of the per-phase instrumentation (GAIM_PROFILE
+ * builds): aggregation and dumping of the ga_profile_s counters.
+ */
+// $Log$
+#include "gaim.h"
+
+GAIM_BEGIN_NAMESPACE
+
+
+/**
+ * Accumulates the timers and counters of one profile into another (e.g., to
+ * aggregate islands or runs).
+ *
+ * @param[in,out] lhs Profile to accumulate into
+ * @param[in] rhs Profile to be added
+ * @return The accumulated profile lhs
+ */
+ga_profile_s &operator+=(ga_profile_s &lhs, const ga_profile_s &rhs)
+{
+    lhs.evaluation_ns += rhs.evaluation_ns;
+    lhs.sorting_ns += rhs.sorting_ns;
+    lhs.selection_ns += rhs.selection_ns;
+    lhs.crossover_ns += rhs.crossover_ns;
+    lhs.mutation_ns += rhs.mutation_ns;
+    lhs.replacement_ns += rhs.replacement_ns;
+    lhs.clipping_ns += rhs.clipping_ns;
+    lhs.migration_ns += rhs.migration_ns;
+    lhs.barrier_wait_ns += rhs.barrier_wait_ns;
+    lhs.mutex_wait_ns += rhs.mutex_wait_ns;
+    lhs.generations += rhs.generations;
+    lhs.evaluations += rhs.evaluations;
+    lhs.allocations += rhs.allocations;
+    lhs.migrants_sent += rhs.migrants_sent;
+    lhs.migrants_received += rhs.migrants_received;
+    lhs.timeouts += rhs.timeouts;
+    return lhs;
+}
+
+
+/**
+ * Prints the profile of a GA (or an island) either to standard output
+ * (stdout) or to a file. In the latter case a line is appended to the CSV
+ * file profile_<unique_id>.csv on every call, so periodic dumps build up a
+ * time series. The reports of concurrent islands (or runs) are serialized,
+ * so they never interleave.
+ *
+ * @param[in] profile Profile to print
+ * @param[in] generation Current generation
+ * @param[in] unique_id This is the thread id in case the Island Model is used;
+ *                      otherwise it can be any number of type size_t
+ * @param[in] write_to  A string that defines where the profile will be
+ *                      displayed ("stdout" or "/path/to/directory/")
+ * @return Nothing (void)
+ */
+void print_profile(const ga_profile_s &profile,
+                   size_t generation,
+                   size_t unique_id,
+                   std::string write_to)
+{
+    const char *names[] = {"evaluation_ns", "sorting_ns", "selection_ns",
+                           "crossover_ns", "mutation_ns", "replacement_ns",
+                           "clipping_ns", "migration_ns", "barrier_wait_ns",
+                           "mutex_wait_ns", "generations", "evaluations",
+                           "allocations", "migrants_sent", "migrants_received",
+                           "timeouts"};
+    const uint64_t values[] = {profile.evaluation_ns, profile.sorting_ns,
+                               profile.selection_ns, profile.crossover_ns,
+                               profile.mutation_ns, profile.replacement_ns,
+                               profile.clipping_ns, profile.migration_ns,
+                               profile.barrier_wait_ns, profile.mutex_wait_ns,
+                               profile.generations, profile.evaluations,
+                               profile.allocations, profile.migrants_sent,
+                               profile.migrants_received, profile.timeouts};
+    const size_t n = sizeof(values) / sizeof(values[0]);
+    static std::mutex print_mtx;
+    std::lock_guard<std::mutex> lock(print_mtx);
+
+    if (write_to == "stdout") {
+        std::cout << "Profile of " << unique_id << " at generation "
+            << generation << std::endl;
+        std::cout << std::string(30, '-') << std::endl;
+        for (size_t i = 0; i < n; ++i) {
+            std::cout << std::setw(18) << names[i] << " | " << values[i]
+                << std::endl;
+        }
+    } else {
+        if (make_dir(write_to)) {
+            std::cerr << "Cannot create the directory "+write_to+"!" << std::endl;
+            std::cerr << "Nothing will be saved!" << std::endl;
+            return;
+        }
+        std::string fname = write_to+"profile_"+std::to_string(unique_id)+".csv";
+        bool header = !is_path_exist(fname);
+        auto ofile = std::fstream(fname, std::ios::out | std::ios::app);
+        if (header) {
+            ofile << "generation";
+            for (size_t i = 0; i < n; ++i) {
+                ofile << "," << names[i];
+            }
+            ofile << std::endl;
+        }
+        ofile << generation;
+        for (size_t i = 0; i < n; ++i) {
+            ofile << "," << values[i];
+        }
+        ofile << std::endl;
+        ofile.close();
+    }
+}
+
+GAIM_END_NAMESPACE
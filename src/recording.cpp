@@ -0,0 +1,159 @@
+/* Statistics recording cpp file for GAIM software
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file recording.cpp
+ * Implements the recording policy that bounds the memory of the statistics
+ * (BSF, average fitness) a GA keeps over generations.
+ */
+// $Log$
+#include "gaim.h"
+
+GAIM_BEGIN_NAMESPACE
+
+
+/**
+ * @brief Constructor of RecordPolicy class.
+ *
+ * @param[in] policy_name Recording policy (all, interval, log, improvement)
+ * @param[in] record_interval Recording interval of the interval policy
+ * @param[in] max_records Maximum number of records (0 means unbounded)
+ * @return Nothing
+ */
+RecordPolicy::RecordPolicy(std::string policy_name,
+                           size_t record_interval,
+                           size_t max_records)
+{
+    if (policy_name != "all" && policy_name != "interval" &&
+        policy_name != "log" && policy_name != "improvement") {
+        std::cout << "Recording policy " << policy_name << " does not exist!"
+            << std::endl;
+        std::cout << "Choose one of: all, interval, log, improvement" << std::endl;
+        fatal_error();
+    }
+    policy = policy_name;
+    interval = (policy == "interval") ? std::max<size_t>(record_interval, 1) : 1;
+    stride = interval;
+    // At least two records are needed to decimate
+    capacity = max_records ? std::max<size_t>(max_records, 2) : 0;
+    last_best = 0;
+}
+
+
+/**
+ * Decides whether the statistics of a generation have to be recorded.
+ *
+ * @param[in] generation Current generation (starting from 0)
+ * @param[in] best Best fitness of the current generation
+ * @return True if the generation has to be recorded
+ */
+bool RecordPolicy::due(size_t generation, REAL_ best)
+{
+    if (policy == "log") {
+        size_t g = generation + 1;
+        return !(g & (g - 1));
+    } else if (policy == "improvement") {
+        return generations.empty() || best > last_best;
+    }
+    return !(generation % stride);
+}
+
+
+/**
+ * Drops every other recorded generation. The all and interval policies
+ * double their recording interval, so the remaining records stay uniformly
+ * spaced (the generation that triggered the decimation is recorded only if
+ * it is due with the doubled interval).
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void RecordPolicy::decimate(void)
+{
+    decimate(generations);
+    if (policy == "all" || policy == "interval") {
+        stride *= 2;
+    }
+}
+
+
+/**
+ * Registers a recorded generation.
+ *
+ * @param[in] generation Recorded generation
+ * @param[in] best Recorded best fitness
+ * @return Nothing (void)
+ */
+void RecordPolicy::push(size_t generation, REAL_ best)
+{
+    generations.push_back(generation);
+    last_best = best;
+}
+
+
+/**
+ * Forgets the recorded generations and restores the initial recording
+ * interval, e.g. before a new optimization.
+ *
+ * @param[in] void
+ * @return Nothing (void)
+ */
+void RecordPolicy::clear(void)
+{
+    stride = interval;
+    last_best = 0;
+    generations.clear();
+}
+
+
+/**
+ * Appends the statistics of a generation to their records if the policy says
+ * so. When the records are full, every other record is dropped first; the
+ * doubled interval may then skip the generation (odd capacity), so it is
+ * checked again before anything is appended.
+ *
+ * @param[in] generation Current generation (starting from 0)
+ * @param[in] best Best so far fitness (improvement policy)
+ * @param[in,out] records Records and the values of the generation to append
+ * @return True if the generation has been recorded
+ */
+bool RecordPolicy::record(size_t generation,
+                          REAL_ best,
+                          std::initializer_list<std::pair<std::vector<REAL_> *, REAL_>> records)
+{
+    if (!due(generation, best)) {
+        return false;
+    }
+    if (full()) {
+        for (auto &r : records) {
+            decimate(*r.first);
+        }
+        decimate();
+        if (!due(generation, best)) {
+            return false;
+        }
+    }
+    for (auto &r : records) {
+        r.first->push_back(r.second);
+    }
+    push(generation, best);
+    return true;
+}
+
+GAIM_END_NAMESPACE
@@ -25,6 +25,8 @@
 // $Log$
 #include "gaim.h"
 
+GAIM_BEGIN_NAMESPACE
+
 
 /**
  * @brief Assigns the appropriate selection operator to the pointer function
@@ -57,7 +59,7 @@ void GA::select_selection_method(void) {
         selection = &GA::whitley_selection;
     } else {
         std::cout << "Error: GA Selection method not found!" << std::endl;
-        exit(-1);
+        fatal_error();
     }
 }
 
@@ -72,7 +74,7 @@ std::vector<individual_s> GA::ktournament_selection(std::vector<individual_s> &p
     int best_index = 0;
     std::vector<individual_s> selected_individuals;
     individual_s ind, best; 
-    std::vector<size_t> indices(population.size());
+    arena_vector<size_t> indices(population.size(), 0, arena_allocator<size_t>(&arena));
     
     // Check if the number of parents is greater than the population size
     if (population.size() < num_parents) {
@@ -135,7 +137,7 @@ std::vector<individual_s> GA::ktournament_selection(std::vector<individual_s> &p
  */
 std::vector<individual_s> GA::truncation_selection(std::vector<individual_s> &population) {
     size_t r = 0, mu = population.size()-1;
-    std::vector<size_t> indices(num_parents);
+    arena_vector<size_t> indices(num_parents, 0, arena_allocator<size_t>(&arena));
     std::vector<individual_s> selected_individuals;
 
     // Check if the number of parents is greater than the population size
@@ -158,8 +160,11 @@ std::vector<individual_s> GA::truncation_selection(std::vector<individual_s> &po
         exit(-1);
     }
 
-    // Sort the individuals based on their fitness - Create the rank
-    std::sort(population.begin(), population.end(), compare_fitness);
+    // Sort the individuals based on their fitness - Create the rank (the
+    // population remains sorted until the next generation is formed)
+    if (!std::is_sorted(population.begin(), population.end(), compare_fitness)) {
+        std::sort(population.begin(), population.end(), compare_fitness);
+    }
 
     // Select the individuals from the population without replacement
     if (replace == false) {
@@ -213,8 +218,11 @@ std::vector<individual_s> GA::linear_rank_selection(std::vector<individual_s> &p
         return selected_individuals;
     }
 
-    // Sort the individuals based on their fitness - Create the rank
-    std::sort(population.begin(), population.end(), compare_fitness);
+    // Sort the individuals based on their fitness - Create the rank (the
+    // population remains sorted until the next generation is formed)
+    if (!std::is_sorted(population.begin(), population.end(), compare_fitness)) {
+        std::sort(population.begin(), population.end(), compare_fitness);
+    }
 
     // Select the individuals from the population without replacement
     if (replace == false) {
@@ -259,7 +267,7 @@ std::vector<individual_s> GA::linear_rank_selection(std::vector<individual_s> &p
  */
 std::vector<individual_s> GA::random_selection(std::vector<individual_s> &population) {
     size_t idx;
-    std::vector<size_t> indices(population.size());
+    arena_vector<size_t> indices(population.size(), 0, arena_allocator<size_t>(&arena));
     std::vector<individual_s> selected_individuals;
 
     // Check if the number of parents is greater than the population size
@@ -325,11 +333,8 @@ std::vector<individual_s> GA::roulette_wheel_selection(std::vector<individual_s>
         return selected_individuals;
     }
 
-    // Compute the cumulative fitness of the entire population
-    static REAL_ cumulative = std::accumulate(population.begin(),
-                                              population.end(),
-                                              0,
-                                              average_fitness);
+    // Cumulative fitness of the entire population (single pass)
+    REAL_ cumulative = population_statistics(population).sum;
 
     // Select the individuals from the population without replacement
     if (replace == false) {
@@ -344,8 +349,10 @@ std::vector<individual_s> GA::roulette_wheel_selection(std::vector<individual_s>
                 }
             }
             selected_individuals.push_back(population[index]);
-            population[index].is_selected = true;
-            cumulative = cumulative_fitness(population);
+            if (!population[index].is_selected) {
+                population[index].is_selected = true;
+                cumulative -= population[index].fitness;
+            }
         }
     // Select the individuals from the population with replacement
     } else {
@@ -397,10 +404,12 @@ std::vector<individual_s> GA::stochastic_roulette_wheel_selection(std::vector<in
         return selected_individuals;
     }
             
+    // Maximum fitness of the entire population (single pass)
+    max_fitness = population_statistics(population).max;
+
     // Select the individuals from the population without replacement
     if (replace == false) {
-        max_fitness = maximum_fitness(population);
-        std::vector<size_t> indices(population.size());
+        arena_vector<size_t> indices(population.size(), 0, arena_allocator<size_t>(&arena));
         std::iota(indices.begin(), indices.end(), 0);
         for(size_t i = 0; i < num_parents; ++i) {
             r = float_random(0, 1);
@@ -410,8 +419,11 @@ std::vector<individual_s> GA::stochastic_roulette_wheel_selection(std::vector<in
                 selected_individuals.push_back(population[index]);
                 population[index].is_selected = true;
                 remove_at(indices, index);
+                // The maximum changes only if the best individual was taken
+                if (population[index].fitness >= max_fitness) {
+                    max_fitness = nonselected_maximum_fitness(population);
+                }
             }
-            max_fitness = nonselected_maximum_fitness(population);
         }
     // Select the individuals from the population with replacement
     } else {
@@ -504,3 +516,5 @@ std::vector<individual_s> GA::whitley_selection(std::vector<individual_s> &popul
     }
     return selected_individuals;
 }
+
+GAIM_END_NAMESPACE
@@ -0,0 +1,317 @@
+/* SIMD kernels cpp file for GAIM software
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file simd_kernels.cpp
+ * Implements a vectorized random number generator (GAIM_VLANES lane-parallel
+ * xoshiro128+ generators) and the SIMD kernels of the mutation operators and
+ * the genome clipping. The kernels are compiled for AVX-512, AVX2 and the
+ * default ISA (see GAIM_TARGET_CLONES) and the best version the CPU supports
+ * is chosen at runtime.
+ */
+// $Log$
+#include "gaim.h"
+#include "fast_math.h"
+#include <cmath>
+
+GAIM_BEGIN_NAMESPACE
+
+#define VRNG_SCALE (1.0 / 16777216.0)   // 2^-24
+
+
+/**
+ * Advances all the lanes of the generator by one step and writes one 32-bit
+ * random number per lane to out.
+ *
+ * @param[in] rng Vectorized RNG state
+ * @param[out] out Array of GAIM_VLANES random numbers
+ * @return Nothing (void)
+ */
+static inline void vrng_step(vrng_s *rng, uint32_t *out)
+{
+    uint32_t *s0 = rng->s[0], *s1 = rng->s[1], *s2 = rng->s[2], *s3 = rng->s[3];
+    for (int j = 0; j < GAIM_VLANES; ++j) {
+        uint32_t t = s1[j] << 9;
+        out[j] = s0[j] + s3[j];
+        s2[j] ^= s0[j];
+        s3[j] ^= s1[j];
+        s1[j] ^= s2[j];
+        s0[j] ^= s3[j];
+        s2[j] ^= t;
+        s3[j] = (s3[j] << 11) | (s3[j] >> 21);
+    }
+}
+
+
+/**
+ * Draws GAIM_VLANES uniform random numbers in [0, 1).
+ */
+static inline void vrng_fill_uniform(vrng_s *rng, REAL_ *u)
+{
+    uint32_t r[GAIM_VLANES];
+    vrng_step(rng, r);
+    for (int j = 0; j < GAIM_VLANES; ++j) {
+        u[j] = static_cast<REAL_>(r[j] >> 8) * static_cast<REAL_>(VRNG_SCALE);
+    }
+}
+
+
+/**
+ * Draws GAIM_VLANES standard normal random numbers using the Box-Muller
+ * transform on pairs of lanes.
+ */
+static inline void vrng_fill_normal(vrng_s *rng, REAL_ *z)
+{
+    const int h = GAIM_VLANES / 2;
+    uint32_t r[GAIM_VLANES];
+    vrng_step(rng, r);
+    for (int j = 0; j < h; ++j) {
+        // u1 in (0, 1] so the logarithm is finite
+        REAL_ u1 = static_cast<REAL_>((r[j] >> 8) + 1) * static_cast<REAL_>(VRNG_SCALE);
+        REAL_ u2 = static_cast<REAL_>(r[j+h] >> 8) * static_cast<REAL_>(VRNG_SCALE);
+        REAL_ rad = std::sqrt(REAL_(-2) * fast_log(u1));
+        REAL_ theta = static_cast<REAL_>(2.0 * FAST_PI) * u2;
+        z[j] = rad * fast_cos(theta);
+        z[j+h] = rad * fast_sin(theta);
+    }
+}
+
+
+/**
+ * Seeds all the lanes of the vectorized generator. The state words are drawn
+ * from a splitmix64 sequence started at seed, so each lane runs an
+ * independent stream.
+ *
+ * @param[in] rng Vectorized RNG state
+ * @param[in] seed Seed of the generator
+ * @return Nothing (void)
+ */
+void vrng_seed(vrng_s *rng, uint64_t seed)
+{
+    for (int j = 0; j < GAIM_VLANES; ++j) {
+        for (int w = 0; w < 4; w += 2) {
+            uint64_t z = (seed += 0x9e3779b97f4a7c15ULL);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            z = z ^ (z >> 31);
+            rng->s[w][j] = static_cast<uint32_t>(z);
+            rng->s[w+1][j] = static_cast<uint32_t>(z >> 32);
+        }
+    }
+    rng->pos = GAIM_VLANES;
+}
+
+
+/**
+ * Draws GAIM_VLANES uniform random numbers in [0, 1).
+ *
+ * @param[in] rng Vectorized RNG state
+ * @param[out] u Array of GAIM_VLANES uniform random numbers
+ * @return Nothing (void)
+ */
+void vrng_uniform(vrng_s *rng, REAL_ *u)
+{
+    vrng_fill_uniform(rng, u);
+}
+
+
+/**
+ * Draws GAIM_VLANES random numbers from the standard normal distribution.
+ *
+ * @param[in] rng Vectorized RNG state
+ * @param[out] z Array of GAIM_VLANES normal random numbers
+ * @return Nothing (void)
+ */
+void vrng_normal(vrng_s *rng, REAL_ *z)
+{
+    vrng_fill_normal(rng, z);
+}
+
+
+/**
+ * Draws a single integer random number uniformly in [0, n). Scalar draws are
+ * served from the buffer of a full step of the generator.
+ *
+ * @param[in] rng Vectorized RNG state
+ * @param[in] n Upper (open) limit of the interval
+ * @return An integer random number in [0, n)
+ */
+uint32_t vrng_bounded(vrng_s *rng, uint32_t n)
+{
+    if (rng->pos >= GAIM_VLANES) {
+        vrng_step(rng, rng->buffer);
+        rng->pos = 0;
+    }
+    return static_cast<uint32_t>((static_cast<uint64_t>(rng->buffer[rng->pos++]) * n) >> 32);
+}
+
+
+/**
+ * Draws a single uniform random number in [0, 1).
+ *
+ * @param[in] rng Vectorized RNG state
+ * @return A random number in [0, 1)
+ */
+REAL_ vrng_real(vrng_s *rng)
+{
+    if (rng->pos >= GAIM_VLANES) {
+        vrng_step(rng, rng->buffer);
+        rng->pos = 0;
+    }
+    return static_cast<REAL_>(rng->buffer[rng->pos++] >> 8) *
+           static_cast<REAL_>(VRNG_SCALE);
+}
+
+
+/**
+ * Delta mutation kernel. Every gene is perturbed with probability rate by a
+ * normal random number with zero mean and standard deviation sigma.
+ *
+ * @param[in,out] genome Genome to be mutated (in place)
+ * @param[in] n Genome size
+ * @param[in] rate Mutation probability per gene
+ * @param[in] sigma Standard deviation of the mutation step
+ * @param[in] rng Vectorized RNG state
+ * @return Nothing (void)
+ */
+GAIM_TARGET_CLONES
+void simd_delta_mutation(REAL_ *genome,
+                         size_t n,
+                         REAL_ rate,
+                         REAL_ sigma,
+                         vrng_s *rng)
+{
+    REAL_ u[GAIM_VLANES], z[GAIM_VLANES];
+    size_t i = 0;
+
+    for (; i + GAIM_VLANES <= n; i += GAIM_VLANES) {
+        vrng_fill_uniform(rng, u);
+        vrng_fill_normal(rng, z);
+        for (int j = 0; j < GAIM_VLANES; ++j) {
+            genome[i+j] += (u[j] <= rate) ? sigma * z[j] : REAL_(0);
+        }
+    }
+    if (i < n) {
+        vrng_fill_uniform(rng, u);
+        vrng_fill_normal(rng, z);
+        for (size_t j = 0; j < n - i; ++j) {
+            genome[i+j] += (u[j] <= rate) ? sigma * z[j] : REAL_(0);
+        }
+    }
+}
+
+
+/**
+ * Non-uniform mutation kernel. Every gene x moves towards bound by
+ * \f$ (bound - x) (1 - L^{e}) \f$, where L is uniform in (0, 1] and e is the
+ * time-dependent exponent of the operator.
+ *
+ * @param[in,out] genome Genome to be mutated (in place)
+ * @param[in] n Genome size
+ * @param[in] bound Interval limit the genes move towards
+ * @param[in] exponent Exponent e of the decaying factor
+ * @param[in] rng Vectorized RNG state
+ * @return Nothing (void)
+ */
+GAIM_TARGET_CLONES
+void simd_nonuniform_mutation(REAL_ *genome,
+                              size_t n,
+                              REAL_ bound,
+                              REAL_ exponent,
+                              vrng_s *rng)
+{
+    REAL_ u[GAIM_VLANES];
+
+    for (size_t i = 0; i < n; i += GAIM_VLANES) {
+        size_t m = std::min(static_cast<size_t>(GAIM_VLANES), n - i);
+        vrng_fill_uniform(rng, u);
+        for (int j = 0; j < GAIM_VLANES; ++j) {
+            REAL_ L = REAL_(1) - u[j];  // (0, 1]
+            u[j] = REAL_(1) - fast_exp(exponent * fast_log(L));
+        }
+        for (size_t j = 0; j < m; ++j) {
+            genome[i+j] += (bound - genome[i+j]) * u[j];
+        }
+    }
+}
+
+
+/**
+ * Clipping kernel. Clamps every gene within its lower and upper limit
+ * without branches.
+ *
+ * @param[in,out] genome Genome to be clipped (in place)
+ * @param[in] lower Lower limit of each gene
+ * @param[in] upper Upper limit of each gene
+ * @param[in] n Genome size
+ * @return Nothing (void)
+ */
+GAIM_TARGET_CLONES
+void simd_clip(REAL_ *genome,
+               const REAL_ *lower,
+               const REAL_ *upper,
+               size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        REAL_ g = genome[i] > upper[i] ? upper[i] : genome[i];
+        genome[i] = g < lower[i] ? lower[i] : g;
+    }
+}
+
+
+/**
+ * Clipping kernel for limits shared by all the genes. Clamps every gene
+ * within [lower, upper] without branches (a single stream of memory).
+ *
+ * @param[in,out] genome Genome to be clipped (in place)
+ * @param[in] lower Lower limit of the genes
+ * @param[in] upper Upper limit of the genes
+ * @param[in] n Genome size
+ * @return Nothing (void)
+ */
+GAIM_TARGET_CLONES
+void simd_clip_uniform(REAL_ *genome,
+                       REAL_ lower,
+                       REAL_ upper,
+                       size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        REAL_ g = genome[i] > upper ? upper : genome[i];
+        genome[i] = g < lower ? lower : g;
+    }
+}
+
+
+/**
+ * Reports which instruction set the SIMD kernels run on.
+ *
+ * @param[in] void
+ * @return A string, one of "avx512f", "avx2", or "default"
+ */
+const char *simd_isa(void)
+{
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(GAIM_NO_SIMD_DISPATCH)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) { return "avx512f"; }
+    if (__builtin_cpu_supports("avx2")) { return "avx2"; }
+#endif
+    return "default";
+}
+
+GAIM_END_NAMESPACE
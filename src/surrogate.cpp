@@ -0,0 +1,232 @@
+/* Surrogate-assisted evaluation cpp file for GAIM software
+ * Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+ *                     Andrew Burton (ajburton@uci.edu)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// $Id$
+/**
+ * @file surrogate.cpp
+ * Implements the surrogate model of the fitness function and the
+ * surrogate-assisted evaluation of the GA: the offspring are ranked by their
+ * predicted fitness and only the most promising ones are evaluated by the
+ * (expensive) fitness function. The individuals of the population keep their
+ * fitness until their genome changes.
+ */
+// $Log$
+#include "gaim.h"
+#include <cmath>
+#include <limits>
+
+GAIM_BEGIN_NAMESPACE
+
+
+/**
+ * Constructor of the surrogate model.
+ *
+ * @param[in] method Surrogate model ("none" or "knn")
+ * @param[in] k Number of neighbours of a prediction
+ * @param[in] capacity Maximum number of genomes in the archive
+ * @param[in] a Lower bounds of the genes
+ * @param[in] b Upper bounds of the genes
+ */
+SurrogateModel::SurrogateModel(std::string method,
+                               size_t k,
+                               size_t capacity,
+                               const std::vector<REAL_> &a,
+                               const std::vector<REAL_> &b)
+    : k(k), capacity(capacity), next(0)
+{
+    if (method != "none" && method != "knn") {
+        std::cerr << "ERROR: No such surrogate model exists!" << std::endl;
+        fatal_error();
+    }
+    is_enabled = (method == "knn");
+    if (is_enabled && (k < 1 || capacity < k)) {
+        std::cerr << "ERROR: The surrogate archive must hold at least k genomes!" << std::endl;
+        fatal_error();
+    }
+    for (size_t j = 0; j < a.size() && j < b.size(); ++j) {
+        REAL_ width = (b[j] > a[j]) ? b[j] - a[j] : 1;
+        scale.push_back(1 / (width * width));
+    }
+}
+
+
+/**
+ * Adds an evaluated genome to the archive. When the archive is full, the
+ * oldest genome is replaced.
+ *
+ * @param[in] genome Genome (scale.size() genes)
+ * @param[in] fitness Its fitness value
+ * @return Nothing (void)
+ */
+void SurrogateModel::add(const REAL_ *genome, REAL_ fitness)
+{
+    size_t genome_size = scale.size();
+
+    if (values.size() < capacity) {
+        genomes.insert(genomes.end(), genome, genome + genome_size);
+        values.push_back(fitness);
+        return;
+    }
+    std::copy(genome, genome + genome_size, genomes.begin() + next * genome_size);
+    values[next] = fitness;
+    next = (next + 1) % capacity;
+}
+
+
+/**
+ * Predicts the fitness of a genome as the average of the fitness of its k
+ * nearest archived genomes, weighted by their inverse squared distance. An
+ * archived genome returns its own fitness.
+ *
+ * @param[in] genome Genome (scale.size() genes)
+ * @return The predicted fitness
+ */
+REAL_ SurrogateModel::predict(const REAL_ *genome) const
+{
+    size_t genome_size = scale.size();
+    size_t n = std::min(k, values.size());
+    std::vector<std::pair<REAL_, size_t>> dist(values.size());
+
+    if (!n) {
+        return 0;
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        const REAL_ *x = &genomes[i * genome_size];
+        REAL_ d = 0;
+        for (size_t j = 0; j < genome_size; ++j) {
+            d += (x[j] - genome[j]) * (x[j] - genome[j]) * scale[j];
+        }
+        dist[i] = std::make_pair(d, i);
+    }
+    std::partial_sort(dist.begin(), dist.begin() + n, dist.end());
+
+    double num = 0, den = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (dist[i].first <= 0) {
+            return values[dist[i].second];
+        }
+        num += values[dist[i].second] / dist[i].first;
+        den += 1 / static_cast<double>(dist[i].first);
+    }
+    return static_cast<REAL_>(num / den);
+}
+
+
+/**
+ * Empties the archive.
+ *
+ * @return Nothing (void)
+ */
+void SurrogateModel::clear(void)
+{
+    genomes.clear();
+    values.clear();
+    next = 0;
+}
+
+
+/**
+ * Evaluates a subset of individuals (given by their indices) with a single
+ * call of GA::evaluation, so a batch fitness function still sees them at once.
+ */
+static void evaluate_subset(GA *ga,
+                            std::vector<individual_s> &x,
+                            const std::vector<size_t> &indices)
+{
+    if (indices.size() == x.size()) {
+        ga->evaluation(x);
+        return;
+    }
+    std::vector<individual_s> subset;
+    for (auto i : indices) {
+        subset.push_back(x[i]);
+    }
+    ga->evaluation(subset);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        x[indices[i]].fitness = subset[i].fitness;
+        x[indices[i]].objectives.swap(subset[i].objectives);
+        x[indices[i]].is_evaluated = true;
+    }
+}
+
+
+/**
+ * Evaluates only the individuals whose fitness is not known (new or changed
+ * genomes). Used instead of GA::evaluation when a surrogate is enabled, so
+ * the individuals that survive a generation are not evaluated again.
+ *
+ * @param[in] x Vector of individuals
+ * @return Nothing (void)
+ */
+void GA::evaluate_stale(std::vector<individual_s> &x)
+{
+    std::vector<size_t> stale;
+    for (size_t i = 0; i < x.size(); ++i) {
+        if (!x[i].is_evaluated) {
+            stale.push_back(i);
+        }
+    }
+    if (!stale.empty()) {
+        evaluate_subset(this, x, stale);
+    }
+}
+
+
+/**
+ * Pre-screens the offspring with the surrogate model. The offspring are
+ * ranked by their predicted fitness and only the most promising ones
+ * (surrogate_fraction of them, and at least num_replacement) are evaluated by
+ * the fitness function; the others get the lowest representable fitness, so
+ * they never replace an individual of the population. Until the archive
+ * holds a generation of offspring, all the offspring are evaluated.
+ *
+ * @return Nothing (void)
+ */
+void GA::screen_offsprings(void)
+{
+    size_t n = static_cast<size_t>(std::ceil(surrogate_fraction * lambda));
+    n = std::min(std::max(n, replace_perc), lambda);
+    if (surrogate.size() < lambda || n == lambda) {
+        evaluate_stale(offsprings);
+        return;
+    }
+
+    std::vector<std::pair<REAL_, size_t>> predicted;
+    for (size_t i = 0; i < lambda; ++i) {
+        if (!offsprings[i].is_evaluated) {
+            predicted.push_back(std::make_pair(surrogate.predict(&offsprings[i].genome[0]), i));
+        }
+    }
+    n = std::min(n, predicted.size());
+    std::partial_sort(predicted.begin(), predicted.begin() + n, predicted.end(),
+                      [](const std::pair<REAL_, size_t> &x,
+                         const std::pair<REAL_, size_t> &y) {
+                          return x.first > y.first; });
+
+    std::vector<size_t> promising;
+    for (size_t i = 0; i < predicted.size(); ++i) {
+        if (i < n) {
+            promising.push_back(predicted[i].second);
+        } else {
+            offsprings[predicted[i].second].fitness = -std::numeric_limits<REAL_>::max();
+        }
+    }
+    evaluate_subset(this, offsprings, promising);
+}
+
+GAIM_END_NAMESPACE
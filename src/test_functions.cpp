@@ -24,8 +24,91 @@
  */
 // $Log$
 #include "gaim.h"
+#include "fast_math.h"
 #include <cmath>
 
+GAIM_BEGIN_NAMESPACE
+
+/*
+ * The objective functions below accumulate their sums in GAIM_VLANES
+ * independent partial sums so the loops vectorize without reassociating
+ * floating point additions, and use the approximations of fast_math.h
+ * instead of libm. The batch variants evaluate GAIM_VLANES genomes per
+ * iteration (one genome per lane), which suits the short genomes most
+ * benchmark runs use.
+ */
+
+
+/// Sphere term x^2
+static inline REAL_ sphere_term(REAL_ x)
+{
+    return x * x;
+}
+
+
+/// Rastrigin term x^2 - 10 cos(2 pi x)
+static inline REAL_ rastrigin_term(REAL_ x)
+{
+    return x * x - REAL_(10) * fast_cos(static_cast<REAL_>(2.0 * FAST_PI) * x);
+}
+
+
+/// Schwefel term x sin(sqrt(|x|))
+static inline REAL_ schwefel_term(REAL_ x)
+{
+    return x * fast_sin(std::sqrt(std::fabs(x)));
+}
+
+
+/**
+ * Sums term(x_i) over a genome using GAIM_VLANES partial sums.
+ */
+template <REAL_ (*term)(REAL_)>
+static inline REAL_ sum_terms(const REAL_ *x, size_t len)
+{
+    REAL_ acc[GAIM_VLANES] = {0};
+    size_t i = 0;
+    for (; i + GAIM_VLANES <= len; i += GAIM_VLANES) {
+        for (int j = 0; j < GAIM_VLANES; ++j) {
+            acc[j] += term(x[i+j]);
+        }
+    }
+    for (; i < len; ++i) {
+        acc[0] += term(x[i]);
+    }
+    REAL_ mysum = 0;
+    for (int j = 0; j < GAIM_VLANES; ++j) {
+        mysum += acc[j];
+    }
+    return mysum;
+}
+
+
+/**
+ * Sums term(x_i) for n genomes stored row-wise in x (n x len) and writes the
+ * sums to out. Each lane handles one genome.
+ */
+template <REAL_ (*term)(REAL_)>
+static inline void batch_sum_terms(const REAL_ *x, size_t n, size_t len,
+                                   REAL_ *out)
+{
+    size_t g = 0;
+    for (; g + GAIM_VLANES <= n; g += GAIM_VLANES) {
+        REAL_ acc[GAIM_VLANES] = {0};
+        for (size_t i = 0; i < len; ++i) {
+            for (int j = 0; j < GAIM_VLANES; ++j) {
+                acc[j] += term(x[(g+j)*len + i]);
+            }
+        }
+        for (int j = 0; j < GAIM_VLANES; ++j) {
+            out[g+j] = acc[j];
+        }
+    }
+    for (; g < n; ++g) {
+        out[g] = sum_terms<term>(&x[g*len], len);
+    }
+}
+
 
 /**
  *  @brief Sphere cost function
@@ -36,13 +119,10 @@
  *  @param[in] x Vector
  *  @return A number indicating the cost
  */
+GAIM_TARGET_CLONES
 REAL_ sphere(REAL_ *x, size_t len)
 {
-    REAL_ mysum = 0;
-    for (size_t i = 0; i < len; ++i) {
-        mysum += x[i] * x[i];
-    }
-    return -mysum;
+    return -sum_terms<sphere_term>(x, len);
 }
 
 
@@ -55,13 +135,10 @@ REAL_ sphere(REAL_ *x, size_t len)
  *  @param[in] x Vector
  *  @return A number indicating the cost
  */
+GAIM_TARGET_CLONES
 REAL_ rastrigin(REAL_ *x, size_t len)
 {
-    REAL_ mysum = 0.0;
-    for (size_t i = 0; i < len; ++i) {
-        mysum += x[i]*x[i] - 10.0 * cos(2. * M_PI * x[i]);
-    }
-    return -(10.0 * len + mysum);
+    return -(REAL_(10) * len + sum_terms<rastrigin_term>(x, len));
 }
 
 
@@ -74,13 +151,10 @@ REAL_ rastrigin(REAL_ *x, size_t len)
  *  @param[in] x Vector
  *  @return A number indicating the cost
  */
+GAIM_TARGET_CLONES
 REAL_ schwefel(REAL_ *x, size_t len)
 {
-    REAL_ mysum = 0.0;
-    for (size_t i = 0; i < len; ++i) {
-        mysum += x[i] * sin(sqrt(abs(x[i])));
-    }
-    return -(418.9829 * len - mysum);
+    return -(REAL_(418.9829) * len - sum_terms<schwefel_term>(x, len));
 }
 
 
@@ -94,16 +168,136 @@ REAL_ schwefel(REAL_ *x, size_t len)
  *  @param[in] x Vector
  *  @return A number indicating the cost
  */
+GAIM_TARGET_CLONES
 REAL_ griewank(REAL_ *x, size_t len)
 {
+    REAL_ sum[GAIM_VLANES] = {0};
+    REAL_ prod[GAIM_VLANES];
+    size_t i = 0;
+
+    std::fill(prod, prod + GAIM_VLANES, REAL_(1));
+    for (; i + GAIM_VLANES <= len; i += GAIM_VLANES) {
+        REAL_ scale[GAIM_VLANES];
+        for (int j = 0; j < GAIM_VLANES; ++j) {
+            scale[j] = REAL_(1) / std::sqrt(static_cast<REAL_>(i + j + 1));
+        }
+        for (int j = 0; j < GAIM_VLANES; ++j) {
+            REAL_ xi = x[i+j];
+            prod[j] *= fast_cos(xi * scale[j]);
+            sum[j] += xi * xi;
+        }
+    }
+    for (; i < len; ++i) {
+        prod[0] *= fast_cos(x[i] / std::sqrt(static_cast<REAL_>(i + 1)));
+        sum[0] += x[i] * x[i];
+    }
+
     REAL_ myprod = 1.0, mysum = 0.0;
-    size_t ii = 0;
-    for (size_t i = 0; i < len; ++i) {
-        myprod *= cos(x[i] / sqrt(ii + 1));
-        mysum += x[i] * x[i];
-        ii++;
+    for (int j = 0; j < GAIM_VLANES; ++j) {
+        myprod *= prod[j];
+        mysum += sum[j];
+    }
+    return -(1 + mysum / REAL_(4000) - myprod);
+}
+
+
+/**
+ *  @brief Sphere cost function (batch)
+ *
+ *  Evaluates the sphere function for n genomes at once.
+ *
+ *  @param[in] x Genomes stored row-wise (n x len)
+ *  @param[in] n Number of genomes
+ *  @param[in] len Genome size
+ *  @param[out] out The cost of each genome (n values)
+ *  @return Nothing (void)
+ */
+GAIM_TARGET_CLONES
+void sphere_batch(REAL_ *x, size_t n, size_t len, REAL_ *out)
+{
+    batch_sum_terms<sphere_term>(x, n, len, out);
+    for (size_t g = 0; g < n; ++g) {
+        out[g] = -out[g];
+    }
+}
+
+
+/**
+ *  @brief Rastrigin cost function (batch)
+ *
+ *  Evaluates the Rastrigin function for n genomes at once.
+ *
+ *  @param[in] x Genomes stored row-wise (n x len)
+ *  @param[in] n Number of genomes
+ *  @param[in] len Genome size
+ *  @param[out] out The cost of each genome (n values)
+ *  @return Nothing (void)
+ */
+GAIM_TARGET_CLONES
+void rastrigin_batch(REAL_ *x, size_t n, size_t len, REAL_ *out)
+{
+    batch_sum_terms<rastrigin_term>(x, n, len, out);
+    for (size_t g = 0; g < n; ++g) {
+        out[g] = -(REAL_(10) * len + out[g]);
+    }
+}
+
+
+/**
+ *  @brief Schwefel cost function (batch)
+ *
+ *  Evaluates the Schwefel function for n genomes at once.
+ *
+ *  @param[in] x Genomes stored row-wise (n x len)
+ *  @param[in] n Number of genomes
+ *  @param[in] len Genome size
+ *  @param[out] out The cost of each genome (n values)
+ *  @return Nothing (void)
+ */
+GAIM_TARGET_CLONES
+void schwefel_batch(REAL_ *x, size_t n, size_t len, REAL_ *out)
+{
+    batch_sum_terms<schwefel_term>(x, n, len, out);
+    for (size_t g = 0; g < n; ++g) {
+        out[g] = -(REAL_(418.9829) * len - out[g]);
+    }
+}
+
+
+/**
+ *  @brief Griewangk cost function (batch)
+ *
+ *  Evaluates the Griewangk function for n genomes at once.
+ *
+ *  @param[in] x Genomes stored row-wise (n x len)
+ *  @param[in] n Number of genomes
+ *  @param[in] len Genome size
+ *  @param[out] out The cost of each genome (n values)
+ *  @return Nothing (void)
+ */
+GAIM_TARGET_CLONES
+void griewank_batch(REAL_ *x, size_t n, size_t len, REAL_ *out)
+{
+    size_t g = 0;
+    for (; g + GAIM_VLANES <= n; g += GAIM_VLANES) {
+        REAL_ sum[GAIM_VLANES] = {0};
+        REAL_ prod[GAIM_VLANES];
+        std::fill(prod, prod + GAIM_VLANES, REAL_(1));
+        for (size_t i = 0; i < len; ++i) {
+            REAL_ scale = REAL_(1) / std::sqrt(static_cast<REAL_>(i + 1));
+            for (int j = 0; j < GAIM_VLANES; ++j) {
+                REAL_ xi = x[(g+j)*len + i];
+                prod[j] *= fast_cos(xi * scale);
+                sum[j] += xi * xi;
+            }
+        }
+        for (int j = 0; j < GAIM_VLANES; ++j) {
+            out[g+j] = -(1 + sum[j] / REAL_(4000) - prod[j]);
+        }
+    }
+    for (; g < n; ++g) {
+        out[g] = griewank(&x[g*len], len);
     }
-    return -(1 + mysum / 4000.0 - myprod);  
 }
 
 
@@ -148,3 +342,31 @@ REAL_ tsm(REAL_ *x, size_t len)
     }
     return -mysum;
 }
+
+
+/**
+ *  @brief Shifted spheres (multi-objective demo function)
+ *
+ *  Objective j is the sphere function centred at t_j = -1 + 2j / (m - 1) on
+ *  every gene, so the objectives compete along the diagonal: the Pareto set
+ *  is the segment joining the centres.
+ *
+ *  @param[in] x Genome
+ *  @param[in] len Genome size
+ *  @param[out] out The m objective values (maximized)
+ *  @param[in] m Number of objectives
+ *  @return Nothing (void)
+ */
+void sphere_objectives(REAL_ *x, size_t len, REAL_ *out, size_t m)
+{
+    for (size_t j = 0; j < m; ++j) {
+        REAL_ t = (m > 1) ? -1 + REAL_(2 * j) / REAL_(m - 1) : 0;
+        REAL_ mysum = 0;
+        for (size_t i = 0; i < len; ++i) {
+            mysum += (x[i] - t) * (x[i] - t);
+        }
+        out[j] = -mysum;
+    }
+}
+
+GAIM_END_NAMESPACE
@@ -17,6 +17,11 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include "gaim.h"
+#include "gaim_template.h"
+#include "fast_math.h"
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
 
 
 REAL_ square(REAL_ x) {
@@ -230,7 +235,1089 @@ int test_run_one_generation(std::size_t generations,
 }
 
 
-int main() {
+int test_recording(std::string policy,
+                   std::size_t interval,
+                   std::size_t capacity,
+                   std::size_t generations)
+{
+    ga_parameter_s pms(init_ga_params());
+    pr_parameter_s pr_pms(init_print_params());
+
+    pms.num_offsprings = 5;
+    pms.num_replacement = 3;
+    pms.record_policy = policy;
+    pms.record_interval = interval;
+    pms.record_capacity = capacity;
+
+    GA gen_alg(&pms);
+    gen_alg.fitness = sphere;
+    gen_alg.evolve(generations, 0, &pr_pms);
+
+    const std::vector<std::size_t> &gens = gen_alg.get_record_generations();
+    const std::vector<REAL_> &bsf = gen_alg.get_bsf();
+    if (gens.empty() || bsf.size() != gens.size() ||
+        gen_alg.get_average_fitness().size() != gens.size()) {
+        return 1;
+    }
+    if (capacity && gens.size() > capacity) {
+        return 1;
+    }
+    for (std::size_t i = 1; i < gens.size(); ++i) {
+        // Uniform spacing (all, interval), powers of two (log), and strictly
+        // improving BSF (improvement)
+        if (policy == "log" && gens[i] + 1 != 2 * (gens[i-1] + 1)) {
+            return 1;
+        }
+        if ((policy == "all" || policy == "interval") &&
+            gens[i] - gens[i-1] != gens[1] - gens[0]) {
+            return 1;
+        }
+        if (policy == "improvement" && bsf[i] <= bsf[i-1]) {
+            return 1;
+        }
+    }
+    if (policy == "interval" && !capacity && gens.size() != generations / interval) {
+        return 1;
+    }
+    // The best genome is the best one ever found
+    if (sphere(&gen_alg.get_best_genome()[0], pms.genome_size) <
+            *std::max_element(bsf.begin(), bsf.end()) - 1e-6) {
+        return 1;
+    }
+    return 0;
+}
+
+
+int test_elitism(std::size_t elitism, std::size_t generations)
+{
+    ga_parameter_s pms(init_ga_params());
+
+    pms.population_size = 10;
+    pms.num_offsprings = 9;
+    pms.num_replacement = 9;
+    pms.elitism = elitism;
+
+    GA gen_alg(&pms);
+    gen_alg.fitness = sphere;
+    for (std::size_t i = 0; i < generations; ++i) {
+        gen_alg.run_one_generation();
+        // Destroy the current best individual (as a migration would do)
+        if (!(i % 50)) {
+            for (auto &ind : gen_alg.population) {
+                if (ind.fitness == gen_alg.bsf.back()) {
+                    ind.genome = pms.b;
+                }
+            }
+        }
+    }
+
+    // The BSF never decreases and, with elitism, the population never loses
+    // its best individual
+    for (std::size_t i = 1; i < gen_alg.bsf.size(); ++i) {
+        if (gen_alg.bsf[i] < gen_alg.bsf[i-1]) {
+            return 1;
+        }
+        if (elitism && gen_alg.hfi[i] != gen_alg.bsf[i]) {
+            return 1;
+        }
+    }
+    if (gen_alg.bsf.back() != *std::max_element(gen_alg.hfi.begin(),
+                                                gen_alg.hfi.end())) {
+        return 1;
+    }
+    return 0;
+}
+
+
+int test_population_statistics(std::size_t population_size)
+{
+    ga_parameter_s pms(init_ga_params());
+    pms.population_size = population_size;
+    GA test(&pms);
+    test.fitness = rastrigin;
+    test.evaluation(test.population);
+    test.update_statistics();
+
+    std::vector<REAL_> f;
+    for (auto &ind : test.population) {
+        f.push_back(ind.fitness);
+    }
+    double mean = std::accumulate(f.begin(), f.end(), 0.0) / f.size();
+    double var = 0;
+    for (auto &x : f) {
+        var += (x - mean) * (x - mean);
+    }
+    var /= f.size();
+
+    const population_stats_s &s = test.stats;
+    if (s.min != *std::min_element(f.begin(), f.end()) ||
+        s.max != *std::max_element(f.begin(), f.end()) ||
+        f[s.argmin] != s.min || f[s.argmax] != s.max) {
+        return 1;
+    }
+    if (fabs(s.mean - mean) > 1e-4 * std::max(1.0, fabs(mean)) ||
+        fabs(s.sum - mean * f.size()) > 1e-4 * std::max(1.0, fabs(mean * f.size())) ||
+        fabs(s.variance - var) > 1e-3 * std::max(1.0, var)) {
+        return 1;
+    }
+
+    // The roulette wheel spins over the individuals it is given, not over the
+    // statistics of the population
+    pms.sel_pms.replace = true;
+    GA wheel(&pms);
+    wheel.fitness = rastrigin;
+    wheel.evaluation(wheel.population);
+    wheel.update_statistics();
+    std::vector<individual_s> pool(wheel.population);
+    for (auto &ind : pool) {
+        ind.fitness = 0;
+    }
+    pool[3].fitness = 1;
+    for (auto &parent : wheel.roulette_wheel_selection(pool)) {
+        if (parent.fitness != 1) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+int test_arena(std::size_t generations)
+{
+    Arena arena(256);
+
+    // Aligned blocks, spilling over several chunks
+    for (std::size_t i = 1; i < 100; ++i) {
+        double *x = static_cast<double *>(arena.allocate(i * sizeof(double),
+                                                         alignof(double)));
+        if (reinterpret_cast<std::uintptr_t>(x) % alignof(double)) {
+            return 1;
+        }
+        x[i-1] = 1.0;
+    }
+    std::size_t capacity = arena.get_stats().capacity;
+    if (arena.get_stats().chunks < 2 || arena.get_stats().allocations != 99) {
+        return 1;
+    }
+    // After a reset one chunk holds the whole generation
+    arena.reset();
+    if (arena.get_stats().chunks != 1 || arena.get_stats().capacity < capacity ||
+        arena.get_stats().bytes != 0 || arena.get_stats().resets != 1) {
+        return 1;
+    }
+    arena_vector<int> v(1000, 1, arena_allocator<int>(&arena));
+    if (std::accumulate(v.begin(), v.end(), 0) != 1000) {
+        return 1;
+    }
+
+    // The GA temporaries come from its arena, which is reset every generation
+    ga_parameter_s pms(init_ga_params());
+    pr_parameter_s pr_pms(init_print_params());
+    pms.num_offsprings = 5;
+    pms.num_replacement = 3;
+    pms.mut_pms.mutation_method = "fusion";
+    GA gen_alg(&pms);
+    gen_alg.evolve(generations, 0, &pr_pms);
+    const arena_stats_s &stats = gen_alg.get_arena_stats();
+    if (stats.resets != generations || stats.allocations != 0 ||
+        stats.total_allocations == 0 || stats.chunks != 1) {
+        return 1;
+    }
+    return 0;
+}
+
+
+void counting_sphere_batch(REAL_ *x, size_t n, size_t genome_size, REAL_ *out,
+                           void *data)
+{
+    ++*static_cast<std::size_t *>(data);
+    sphere_batch(x, n, genome_size, out);
+}
+
+
+void counting_sphere_genomes(REAL_ *x, size_t n, size_t genome_size, REAL_ *out,
+                             void *data)
+{
+    *static_cast<std::size_t *>(data) += n;
+    sphere_batch(x, n, genome_size, out);
+}
+
+
+int test_surrogate(std::size_t generations)
+{
+    ga_parameter_s pms(init_ga_params());
+    std::size_t evaluations[2] = {0, 0};
+    REAL_ best[2];
+    pms.population_size = 40;
+    pms.num_offsprings = 40;
+    pms.num_replacement = 10;
+    pms.genome_size = 5;
+    pms.a.assign(5, -1.0);
+    pms.b.assign(5, 1.0);
+
+    const char *models[] = {"none", "knn"};
+    for (int m = 0; m < 2; ++m) {
+        pms.surrogate = models[m];
+        GA gen_alg(&pms);
+        gen_alg.batch_fitness = counting_sphere_genomes;
+        gen_alg.batch_data = &evaluations[m];
+        gen_alg.step(generations);
+        best[m] = gen_alg.bsf_fitness;
+
+        // The cached fitness values are the ones of the current genomes
+        for (auto &ind : gen_alg.population) {
+            if (m && ind.is_evaluated &&
+                fabs(ind.fitness - sphere(&ind.genome[0], ind.genome.size())) > 1e-5) {
+                return 1;
+            }
+        }
+    }
+    // Only the surviving individuals and a quarter of the offspring are
+    // evaluated, and the search still converges
+    if (evaluations[0] != generations * 80 || 4 * evaluations[1] > evaluations[0] ||
+        best[1] < REAL_(-0.05) || best[1] < 2 * best[0] - REAL_(0.01)) {
+        return 1;
+    }
+    return 0;
+}
+
+
+// The genomes with a positive first gene hang until their time budget expires
+REAL_ hanging_sphere(REAL_ *x, size_t len)
+{
+    if (x[0] > 0 && GAIM_C_NAME(gaim_evaluation_remaining_ms)() >= 0) {
+        while (!GAIM_C_NAME(gaim_evaluation_expired)()) {}
+    }
+    return sphere(x, len);
+}
+
+
+int test_timeout(std::size_t timeout_ms)
+{
+    ga_parameter_s pms(init_ga_params());
+    pms.eval_timeout_ms = timeout_ms;
+    pms.timeout_penalty = -100;
+    GA gen_alg(&pms);
+    gen_alg.fitness = hanging_sphere;
+
+    // The timed out evaluations get the penalty, the others their fitness
+    gen_alg.evaluation(gen_alg.population);
+    for (auto &ind : gen_alg.population) {
+        REAL_ expected = (ind.genome[0] > 0) ? -100 : sphere(&ind.genome[0], 2);
+        if (fabs(ind.fitness - expected) > 1e-6) {
+            return 1;
+        }
+    }
+    if (GAIM_C_NAME(gaim_evaluation_remaining_ms)() != -1 ||
+        GAIM_C_NAME(gaim_evaluation_expired)()) {
+        return 1;
+    }
+
+    // A cancelled run stops between two generations
+    CancelToken token;
+    gen_alg.fitness = sphere;
+    gen_alg.cancel_token = &token;
+    token.cancel();
+    gen_alg.step(10);
+    if (gen_alg.get_generation() != 0) {
+        return 1;
+    }
+    token.reset();
+    gen_alg.step(10);
+    if (gen_alg.get_generation() != 10) {
+        return 1;
+    }
+    return 0;
+}
+
+
+// The genomes with a first gene above 0.9 kill their worker
+REAL_ crashing_sphere(REAL_ *x, size_t len)
+{
+    if (x[0] > REAL_(0.9)) {
+        raise(SIGKILL);
+    }
+    return sphere(x, len);
+}
+
+
+// The genomes with a first gene above 0.5 never finish
+REAL_ stuck_sphere(REAL_ *x, size_t len)
+{
+    while (x[0] > REAL_(0.5)) {
+        sleep(1);
+    }
+    return sphere(x, len);
+}
+
+
+int test_process_evaluator(std::size_t num_workers, const std::string &command)
+{
+    const size_t n = 40, genome_size = 5;
+    std::vector<REAL_> x(n * genome_size), costs(n);
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = REAL_(0.5) * sin(REAL_(i));
+    }
+    x[7 * genome_size] = x[23 * genome_size] = REAL_(0.95);
+
+    // Forked workers: the two crashing genomes restart a worker twice each
+    // (request, then retry), the others get their fitness
+    {
+        ProcessEvaluator workers(num_workers, genome_size, crashing_sphere, 4);
+        workers.crash_penalty = -100;
+        workers.evaluate(&x[0], n, &costs[0]);
+        for (size_t i = 0; i < n; ++i) {
+            REAL_ expected = (i == 7 || i == 23) ? -100 :
+                sphere(&x[i * genome_size], genome_size);
+            if (costs[i] != expected) {
+                return 1;
+            }
+        }
+        if (workers.get_num_workers() != num_workers ||
+            workers.get_restarts() != 4) {
+            return 1;
+        }
+    }
+
+    // Within a time budget only the stuck genomes get the penalty, the
+    // finished ones of the same batch keep their fitness
+    {
+        ga_parameter_s pms(init_ga_params());
+        pms.eval_timeout_ms = 50;
+        pms.timeout_penalty = -100;
+        ProcessEvaluator workers(num_workers, pms.genome_size, stuck_sphere);
+        GA gen_alg(&pms);
+        gen_alg.batch_fitness = process_batch_fitness;
+        gen_alg.batch_data = &workers;
+        gen_alg.population[0].genome[0] = REAL_(0.75);
+        gen_alg.population[1].genome[0] = REAL_(0.25);
+        gen_alg.evaluation(gen_alg.population);
+        size_t stuck = 0;
+        for (auto &ind : gen_alg.population) {
+            REAL_ expected = (ind.genome[0] > REAL_(0.5)) ? -100 :
+                sphere(&ind.genome[0], 2);
+            stuck += (ind.genome[0] > REAL_(0.5));
+            if (fabs(ind.fitness - expected) > 1e-6) {
+                return 1;
+            }
+        }
+        if (workers.get_restarts() != stuck) {
+            return 1;
+        }
+    }
+
+    // Command workers (gaim_worker_serve) plugged in a GA
+    ga_parameter_s pms(init_ga_params());
+    ProcessEvaluator workers(num_workers, pms.genome_size, command);
+    GA gen_alg(&pms);
+    gen_alg.batch_fitness = process_batch_fitness;
+    gen_alg.batch_data = &workers;
+    gen_alg.step(20);
+    if (gen_alg.bsf_genome.empty() || workers.get_restarts() != 0 ||
+        fabs(gen_alg.bsf_fitness - sphere(&gen_alg.bsf_genome[0], 2)) > 1e-6) {
+        return 1;
+    }
+    gen_alg.evaluation(gen_alg.population);
+    for (auto &ind : gen_alg.population) {
+        if (fabs(ind.fitness - sphere(&ind.genome[0], 2)) > 1e-6) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+// Fronts by repeatedly peeling the non-dominated points (O(F N^2))
+std::vector<size_t> peel_fronts(const std::vector<REAL_> &obj, size_t n, size_t m)
+{
+    std::vector<size_t> rank(n, n);
+    for (size_t front = 0, left = n; left; ++front) {
+        std::vector<size_t> current;
+        for (size_t i = 0; i < n; ++i) {
+            if (rank[i] < front) {
+                continue;
+            }
+            bool dominated = false;
+            for (size_t k = 0; k < n && !dominated; ++k) {
+                if (rank[k] < front || k == i) {
+                    continue;
+                }
+                bool ge = true, gt = false;
+                for (size_t j = 0; j < m; ++j) {
+                    ge = ge && obj[k * m + j] >= obj[i * m + j];
+                    gt = gt || obj[k * m + j] > obj[i * m + j];
+                }
+                dominated = ge && gt;
+            }
+            if (!dominated) {
+                current.push_back(i);
+            }
+        }
+        for (auto i : current) {
+            rank[i] = front;
+        }
+        left -= current.size();
+    }
+    return rank;
+}
+
+
+int test_multi_objective(std::size_t n)
+{
+    // The fronts match a brute-force sort (coarse values, so many ties and
+    // duplicates), for two to five objectives
+    for (size_t m = 2; m <= 5; ++m) {
+        for (int coarse = 0; coarse < 2; ++coarse) {
+            std::vector<REAL_> obj(n * m);
+            for (auto &v : obj) {
+                v = coarse ? REAL_(int_random(0, 5)) : float_random(0, 1);
+            }
+            if (non_dominated_sort(&obj[0], n, m) != peel_fronts(obj, n, m)) {
+                return 1;
+            }
+        }
+    }
+
+    // 10k points on a single front (the worst case of a front-wise sort) are
+    // sorted in O(N log^{M-1} N), well within a second
+    for (size_t m = 3; m <= 4; ++m) {
+        const size_t big = 10000;
+        std::vector<REAL_> obj(big * m);
+        for (size_t i = 0; i < big; ++i) {
+            // Integer coordinates with a constant sum (exact in float)
+            size_t sum = 0;
+            for (size_t j = 0; j + 1 < m; ++j) {
+                size_t v = int_random(0, 1 << 20);
+                obj[i * m + j] = REAL_(v);
+                sum += v;
+            }
+            obj[i * m + m - 1] = REAL_((m << 20) - sum);
+        }
+        auto start = std::chrono::steady_clock::now();
+        std::vector<size_t> rank = non_dominated_sort(&obj[0], big, m);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        if (std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count() > 1000 ||
+            *std::max_element(rank.begin(), rank.end()) > 0) {
+            return 1;
+        }
+    }
+
+    // The extreme points of a front are infinitely far (the largest REAL_),
+    // the others at the normalized distance between their neighbours
+    std::vector<REAL_> line = {0, 4, 1, 3, 2, 2, 4, 0};
+    std::vector<size_t> rank = non_dominated_sort(&line[0], 4, 2);
+    std::vector<REAL_> dist = crowding_distance(&line[0], 4, 2, rank);
+    const REAL_ far = std::numeric_limits<REAL_>::max();
+    if (rank != std::vector<size_t>(4, 0) || dist[0] != far ||
+        dist[3] != far || fabs(dist[1] - 1) > 1e-6 ||
+        fabs(dist[2] - REAL_(1.5)) > 1e-6) {
+        return 1;
+    }
+
+    // The front of the shifted spheres is the diagonal of the square: the
+    // front approaches it (mean distance) and stays spread along it
+    ga_parameter_s pms(init_ga_params());
+    pms.population_size = 40;
+    pms.num_offsprings = 40;
+    pms.num_objectives = 2;
+    GA gen_alg(&pms);
+    gen_alg.step(200);
+    std::vector<individual_s> front = gen_alg.get_pareto_front();
+    if (front.size() < 10) {
+        return 1;
+    }
+    REAL_ lowest = 1, highest = -1, distance = 0, objectives[2];
+    for (auto &ind : front) {
+        sphere_objectives(&ind.genome[0], 2, objectives, 2);
+        if (objectives[0] != ind.objectives[0] ||
+            objectives[1] != ind.objectives[1]) {
+            return 1;
+        }
+        lowest = std::min(lowest, ind.genome[0]);
+        highest = std::max(highest, ind.genome[0]);
+        distance += fabs(ind.genome[0] - ind.genome[1]);
+    }
+    if (distance / front.size() > 0.25 || lowest > -0.5 || highest < 0.5) {
+        return 1;
+    }
+    return 0;
+}
+
+
+int test_clipping(std::size_t genome_size)
+{
+    ga_parameter_s pms(init_ga_params());
+    pms.genome_size = genome_size;
+    pms.a.assign(genome_size, -1.0);
+    pms.b.assign(genome_size, 1.0);
+    pms.a[genome_size - 1] = -0.5;
+    pms.b[genome_size - 1] = 0.5;
+
+    const char *modes[] = {"universal", "individual"};
+    for (auto mode : modes) {
+        pms.clipping = mode;
+        GA gen_alg(&pms);
+        REAL_ last = (pms.clipping == "universal") ? 1.0 : 0.5;
+        for (auto &ind : gen_alg.population) {
+            for (std::size_t j = 0; j < genome_size; ++j) {
+                ind.genome[j] = (j % 2) ? -3.0 : 3.0;
+            }
+            ind.genome[genome_size - 1] = 3.0;
+        }
+        gen_alg.clip_genome();
+        for (std::size_t i = 0; i < gen_alg.population.size(); ++i) {
+            const std::vector<REAL_> &g = gen_alg.population[i].genome;
+            for (std::size_t j = 0; j + 1 < genome_size; ++j) {
+                if (g[j] != ((j % 2) ? -1.0 : 1.0)) {
+                    return 1;
+                }
+            }
+            // The limits are shared by all the individuals
+            if (g[genome_size - 1] != last ||
+                gen_alg.get_upper_limit(i) != gen_alg.get_upper_limit(0)) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+int test_initialization(std::string method, std::size_t population_size,
+                        std::size_t genome_size)
+{
+    ga_parameter_s pms(init_ga_params());
+    pms.init_method = method;
+    pms.population_size = population_size;
+    pms.genome_size = genome_size;
+    pms.a.assign(genome_size, -1.0);
+    pms.b.assign(genome_size, 1.0);
+    pms.a[0] = 2.0;
+    pms.b[0] = 6.0;
+
+    GA gen_alg(&pms);
+    if (gen_alg.population.size() != population_size ||
+        gen_alg.population.back().id != population_size - 1) {
+        return 1;
+    }
+    for (std::size_t j = 0; j < genome_size; ++j) {
+        std::vector<REAL_> genes;
+        for (auto &ind : gen_alg.population) {
+            REAL_ g = ind.genome[j];
+            if (ind.genome.size() != genome_size || g < pms.a[j] || g > pms.b[j]) {
+                return 1;
+            }
+            genes.push_back(g);
+        }
+        // Latin hypercube and Sobol (2^m individuals) fill every stratum once,
+        // so the i-th smallest gene lies in the i-th stratum
+        std::sort(genes.begin(), genes.end());
+        REAL_ width = (pms.b[j] - pms.a[j]) / population_size;
+        for (std::size_t i = 0; i < population_size && method != "uniform"; ++i) {
+            if (fabs(genes[i] - (pms.a[j] + (i + 0.5) * width)) > 0.501 * width) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+int test_warm_start(std::size_t num_seeds)
+{
+    ga_parameter_s pms(init_ga_params());
+    std::size_t genome_size = pms.genome_size;
+
+    // Seed genomes (the optimum and points close to it) replace the first
+    // individuals, the rest are drawn as usual
+    for (std::size_t i = 0; i < num_seeds; ++i) {
+        for (std::size_t j = 0; j < genome_size; ++j) {
+            pms.seed_genomes.push_back(REAL_(0.001) * i);
+        }
+    }
+    GA gen_alg(&pms);
+    std::size_t n = std::min(num_seeds, pms.population_size);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (gen_alg.population[i].genome !=
+            std::vector<REAL_>(pms.seed_genomes.begin() + i * genome_size,
+                               pms.seed_genomes.begin() + (i + 1) * genome_size)) {
+            return 1;
+        }
+    }
+    if (n < pms.population_size && gen_alg.population[n].genome[0] == REAL_(0.001) * n) {
+        return 1;
+    }
+
+    // The warm started GA starts at the optimum
+    gen_alg.step(1);
+    if (gen_alg.bsf_genome.empty() || gen_alg.bsf_fitness != 0) {
+        return 1;
+    }
+    return 0;
+}
+
+
+int test_batch_fitness(std::size_t generations)
+{
+    ga_parameter_s pms(init_ga_params());
+    pr_parameter_s pr_pms(init_print_params());
+    std::size_t calls = 0;
+    GA gen_alg(&pms);
+
+    // The batch callback sees the packed genomes and matches the scalar path
+    std::vector<individual_s> x(gen_alg.population);
+    gen_alg.evaluation(x);
+    gen_alg.batch_fitness = counting_sphere_batch;
+    gen_alg.batch_data = &calls;
+    gen_alg.evaluation(gen_alg.population);
+    if (calls != 1 || gen_alg.genome_matrix.size() != x.size() * pms.genome_size) {
+        return 1;
+    }
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        if (fabs(x[i].fitness - gen_alg.population[i].fitness) > 1e-5 ||
+            gen_alg.genome_matrix[i * pms.genome_size] != x[i].genome[0]) {
+            return 1;
+        }
+    }
+
+    // Two batch evaluations per generation (population and offspring)
+    calls = 0;
+    gen_alg.evolve(generations, 0, &pr_pms);
+    if (calls != 2 * generations || gen_alg.get_bsf().size() != generations) {
+        return 1;
+    }
+    return 0;
+}
+
+
+int test_move_results(std::size_t runs)
+{
+    // Vector growth must move the GAs, never copy their populations
+    static_assert(std::is_nothrow_move_constructible<GA>::value,
+                  "GA must be nothrow move constructible");
+
+    ga_parameter_s pms(init_ga_params());
+    pr_parameter_s pr_pms(init_print_params());
+    std::vector<GA> runs_vec;
+    for (std::size_t i = 0; i < runs; ++i) {
+        runs_vec.emplace_back(&pms);
+        runs_vec.back().evolve(20, i, &pr_pms);
+    }
+
+    // Both overloads pick the same GA and return the same records
+    ga_results_s copied = return_best_results(runs_vec, "minimum");
+    ga_results_s moved = return_best_results(std::move(runs_vec), "minimum");
+    if (!runs_vec.empty() || moved.profile.size() != runs ||
+        moved.bsf != copied.bsf || moved.genome != copied.genome ||
+        moved.average_fitness != copied.average_fitness) {
+        return 1;
+    }
+    return 0;
+}
+
+
+int test_batch_solver(std::size_t num_problems)
+{
+    ga_parameter_s pms(init_ga_params());
+    pms.generations = 30;
+
+    // Reset redraws the population within the new limits and clears records
+    GA gen_alg(&pms);
+    gen_alg.step(10);
+    ga_parameter_s shifted(pms);
+    shifted.a.assign(2, 4.0);
+    shifted.b.assign(2, 5.0);
+    gen_alg.reset(&shifted);
+    if (gen_alg.get_generation() != 0 || !gen_alg.get_bsf().empty() ||
+        !gen_alg.get_best_genome().empty()) {
+        return 1;
+    }
+    for (auto &ind : gen_alg.population) {
+        if (ind.genome[0] < 4.0 || ind.genome[1] > 5.0) {
+            return 1;
+        }
+    }
+    if (gen_alg.get_lower_limit(0)[0] != 4.0 || gen_alg.get_upper_limit(0)[1] != 5.0) {
+        return 1;
+    }
+
+    // Problems of two shapes, each in its own box, solved on a shared pool
+    std::vector<batch_problem_s> problems(num_problems);
+    for (std::size_t i = 0; i < num_problems; ++i) {
+        std::size_t genome_size = (i % 2) ? 3 : 2;
+        problems[i].ga_pms = pms;
+        problems[i].ga_pms.genome_size = genome_size;
+        problems[i].ga_pms.a.assign(genome_size, REAL_(i));
+        problems[i].ga_pms.b.assign(genome_size, REAL_(i + 1));
+        problems[i].fitness = sphere;
+    }
+
+    // Collecting a ticket twice terminates the process instead of hanging
+    // (checked in a child, forked before any solver thread exists)
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        alarm(30);
+        BatchSolver single(1);
+        std::size_t t = single.submit(problems[0]);
+        single.get(t);
+        std::cerr.setstate(std::ios::failbit);
+        single.get(t);
+        _exit(0);
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 255) {
+        return 1;
+    }
+
+    BatchSolver solver(3);
+    std::vector<ga_results_s> res = solver.solve(problems);
+    if (solver.get_num_workers() != 3 || res.size() != num_problems) {
+        return 1;
+    }
+    for (std::size_t i = 0; i < num_problems; ++i) {
+        if (res[i].bsf.size() != pms.generations ||
+            res[i].genome.size() != problems[i].ga_pms.genome_size) {
+            return 1;
+        }
+        for (auto x : res[i].genome) {
+            if (x < REAL_(i) || x > REAL_(i + 1)) {
+                return 1;
+            }
+        }
+    }
+
+    // Tickets can be collected in any order
+    std::size_t t0 = solver.submit(problems[0]);
+    std::size_t t1 = solver.submit(problems[1]);
+    solver.wait();
+    if (solver.get(t1).genome.size() != 3 || solver.get(t0).genome.size() != 2) {
+        return 1;
+    }
+    return 0;
+}
+
+
+int test_objective_functions(std::size_t genome_size)
+{
+    const std::size_t n = 37;
+    std::mt19937 gen(13);
+    std::uniform_real_distribution<REAL_> dist(-500, 500);
+    std::vector<REAL_> x(n * genome_size), out(n);
+    REAL_ (*funs[4])(REAL_ *, size_t) = {sphere, rastrigin, schwefel, griewank};
+    void (*batch[4])(REAL_ *, size_t, size_t, REAL_ *) = {sphere_batch,
+                                                          rastrigin_batch,
+                                                          schwefel_batch,
+                                                          griewank_batch};
+
+    for (auto &v : x) {
+        v = dist(gen);
+    }
+
+    // Compare against libm for the first genome
+    double sph = 0, ras = 0, sch = 0, sum = 0, prod = 1;
+    for (std::size_t i = 0; i < genome_size; ++i) {
+        double v = x[i];
+        sph += v * v;
+        ras += v * v - 10 * cos(2 * M_PI * v);
+        sch += v * sin(sqrt(fabs(v)));
+        sum += v * v;
+        prod *= cos(v / sqrt(i + 1.0));
+    }
+    double ref[4] = {-sph, -(10.0 * genome_size + ras),
+                     -(418.9829 * genome_size - sch),
+                     -(1 + sum / 4000 - prod)};
+    for (int f = 0; f < 4; ++f) {
+        double val = funs[f](&x[0], genome_size);
+        if (fabs(val - ref[f]) > 1e-4 * std::max(1.0, fabs(ref[f]))) {
+            return 1;
+        }
+    }
+
+    // The batch variants must agree with the single-genome ones
+    for (int f = 0; f < 4; ++f) {
+        batch[f](&x[0], n, genome_size, &out[0]);
+        for (std::size_t k = 0; k < n; ++k) {
+            double val = funs[f](&x[k*genome_size], genome_size);
+            if (fabs(val - out[k]) > 1e-4 * std::max(1.0, fabs(val))) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+int test_vrng(std::size_t num_draws)
+{
+    vrng_s rng;
+    REAL_ u[GAIM_VLANES], z[GAIM_VLANES];
+    double sum_u = 0, sum_r = 0, sum_b = 0, sum_z = 0, sum_z2 = 0;
+    const uint32_t n = 7;
+
+    vrng_seed(&rng, 42);
+    for (std::size_t i = 0; i < num_draws; i += GAIM_VLANES) {
+        vrng_uniform(&rng, u);
+        vrng_normal(&rng, z);
+        for (int j = 0; j < GAIM_VLANES; ++j) {
+            if (u[j] < 0 || u[j] >= 1) {
+                return 1;
+            }
+            sum_u += u[j];
+            sum_z += z[j];
+            sum_z2 += z[j] * z[j];
+        }
+    }
+    for (std::size_t i = 0; i < num_draws; ++i) {
+        REAL_ r = vrng_real(&rng);
+        uint32_t b = vrng_bounded(&rng, n);
+        if (r < 0 || r >= 1 || b >= n) {
+            return 1;
+        }
+        sum_r += r;
+        sum_b += b;
+    }
+
+    // Means within a few standard errors (1 / sqrt(12 num_draws) for U(0, 1))
+    std::size_t m = (num_draws / GAIM_VLANES) * GAIM_VLANES;
+    if (fabs(sum_u / m - 0.5) > 0.01 || fabs(sum_r / num_draws - 0.5) > 0.01 ||
+        fabs(sum_b / num_draws - 0.5 * (n - 1)) > 0.05 ||
+        fabs(sum_z / m) > 0.02 || fabs(sum_z2 / m - 1) > 0.03) {
+        return 1;
+    }
+    return 0;
+}
+
+
+int test_simd_kernels(std::size_t genome_size)
+{
+    std::mt19937 gen(7);
+    std::uniform_real_distribution<REAL_> dist(-2, 2);
+    std::vector<REAL_> x(genome_size), y, lower(genome_size), upper(genome_size);
+    REAL_ u[GAIM_VLANES], z[GAIM_VLANES];
+    vrng_s rng, ref;
+
+    for (std::size_t i = 0; i < genome_size; ++i) {
+        x[i] = dist(gen);
+        lower[i] = -REAL_(1) + REAL_(i % 3) * REAL_(0.25);
+        upper[i] = lower[i] + REAL_(1);
+    }
+    vrng_seed(&rng, 3);
+
+    // Delta mutation: a uniform and a normal draw per block of lanes
+    y = x;
+    ref = rng;
+    simd_delta_mutation(&y[0], genome_size, REAL_(0.5), REAL_(0.1), &rng);
+    for (std::size_t i = 0; i < genome_size; ++i) {
+        if (!(i % GAIM_VLANES)) {
+            vrng_uniform(&ref, u);
+            vrng_normal(&ref, z);
+        }
+        int j = i % GAIM_VLANES;
+        REAL_ expected = x[i] + ((u[j] <= REAL_(0.5)) ? REAL_(0.1) * z[j] : REAL_(0));
+        if (fabs(y[i] - expected) > 1e-6 * std::max(1.0, fabs(double(expected)))) {
+            return 1;
+        }
+    }
+
+    // Non-uniform mutation against libm
+    const REAL_ bounds[] = {-1, 1}, exponents[] = {0, REAL_(0.3), 1, 4};
+    for (auto bound : bounds) {
+        for (auto e : exponents) {
+            y = x;
+            ref = rng;
+            simd_nonuniform_mutation(&y[0], genome_size, bound, e, &rng);
+            for (std::size_t i = 0; i < genome_size; ++i) {
+                if (!(i % GAIM_VLANES)) {
+                    vrng_uniform(&ref, u);
+                }
+                double L = 1.0 - u[i % GAIM_VLANES];
+                double expected = x[i] + (bound - x[i]) * (1.0 - std::pow(L, double(e)));
+                if (fabs(y[i] - expected) > 1e-5 * std::max(1.0, fabs(expected))) {
+                    return 1;
+                }
+            }
+        }
+    }
+
+    // Clipping, per gene and uniform limits
+    y = x;
+    simd_clip(&y[0], &lower[0], &upper[0], genome_size);
+    for (std::size_t i = 0; i < genome_size; ++i) {
+        if (y[i] != std::min(std::max(x[i], lower[i]), upper[i])) {
+            return 1;
+        }
+    }
+    y = x;
+    simd_clip_uniform(&y[0], REAL_(-0.5), REAL_(0.75), genome_size);
+    for (std::size_t i = 0; i < genome_size; ++i) {
+        if (y[i] != std::min(std::max(x[i], REAL_(-0.5)), REAL_(0.75))) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+int test_mutation_bounds(std::size_t genome_size)
+{
+    ga_parameter_s pms(init_ga_params());
+    pms.genome_size = genome_size;
+    pms.a.assign(genome_size, -1.0);
+    pms.b.assign(genome_size, 1.0);
+    pms.mut_pms.low_bound = 2;
+    pms.mut_pms.up_bound = 5;
+    std::vector<REAL_> x(genome_size, 0);
+
+    // Random mutation: one gene in [low_bound, up_bound] (real) or in
+    // {low_bound, ..., up_bound} (integer)
+    for (int is_real = 0; is_real < 2; ++is_real) {
+        pms.mut_pms.is_real = is_real;
+        GA gen_alg(&pms);
+        for (std::size_t k = 0; k < 1000; ++k) {
+            std::vector<REAL_> y = gen_alg.random_mutation(x);
+            std::size_t changed = 0;
+            for (auto v : y) {
+                if (v == 0) {
+                    continue;
+                }
+                ++changed;
+                if (v < 2 || v > 5 || (!is_real && v != std::floor(v))) {
+                    return 1;
+                }
+            }
+            if (changed != 1) {
+                return 1;
+            }
+        }
+    }
+
+    // Non-uniform mutation: genes move towards a bound (t = 0), and not at
+    // all once t reaches T (here T = 0, so t / T is taken as 1)
+    pms.mut_pms.is_real = true;
+    GA first(&pms);
+    for (std::size_t k = 0; k < 1000; ++k) {
+        std::vector<REAL_> y = first.nonuniform_mutation(x);
+        for (auto v : y) {
+            if (v < 0 || v > 5) {
+                return 1;
+            }
+        }
+    }
+    pms.generations = 0;
+    GA last(&pms);
+    if (last.nonuniform_mutation(x) != x) {
+        return 1;
+    }
+    return 0;
+}
+
+
+int test_fast_math(std::size_t num_points)
+{
+    std::mt19937 gen(11);
+    const bool single = sizeof(REAL_) == sizeof(float);
+    const double log_tol = single ? 1e-6 : 1e-14;
+    const double exp_tol = single ? 2e-5 : 1e-12;
+    const double cos_tol = single ? 1e-4 : 1e-11;
+    const double min_exp = single ? -87 : -708, max_exp = single ? 88 : 709;
+
+    // Logarithm over the positive normal numbers (relative error, or absolute
+    // close to 1)
+    std::uniform_real_distribution<double> exponent(
+            std::log(std::numeric_limits<REAL_>::min()),
+            std::log(std::numeric_limits<REAL_>::max()));
+    for (std::size_t i = 0; i < num_points; ++i) {
+        REAL_ x = static_cast<REAL_>(std::exp(exponent(gen)));
+        double ref = std::log(static_cast<double>(x));
+        if (fabs(fast_log(x) - ref) > log_tol * std::max(1.0, fabs(ref))) {
+            return 1;
+        }
+    }
+
+    // Exponential over the arguments with a normal result
+    std::uniform_real_distribution<double> arg(min_exp, max_exp);
+    for (std::size_t i = 0; i < num_points; ++i) {
+        REAL_ x = static_cast<REAL_>(arg(gen));
+        double ref = std::exp(static_cast<double>(x));
+        if (fabs(fast_exp(x) - ref) > exp_tol * ref) {
+            return 1;
+        }
+    }
+
+    // Cosine over the arguments of the objective functions ([-500, 500])
+    std::uniform_real_distribution<double> angle(-500, 500);
+    for (std::size_t i = 0; i < num_points; ++i) {
+        REAL_ x = static_cast<REAL_>(angle(gen));
+        if (fabs(fast_cos(x) - std::cos(static_cast<double>(x))) > cos_tol) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+template <class Genome>
+int test_template_ga(size_t generations)
+{
+    ga_parameter_s pms(init_ga_params());
+
+    pms.population_size = 30;
+    pms.num_offsprings = 10;
+    pms.num_replacement = 5;
+
+    gaim::GA<Genome,
+             gaim::ktournament_selection,
+             gaim::one_point_crossover,
+             gaim::delta_mutation> gen_alg(&pms);
+    gen_alg.fitness = sphere;
+    gen_alg.evolve(generations);
+
+    if (gen_alg.get_bsf().size() != generations) {
+        return 1;
+    }
+    // The best individual of the sphere function lies close to the origin
+    if (gen_alg.get_bsf().back() < -0.05) {
+        return 1;
+    }
+    for (auto &ind : gen_alg.population) {
+        for (size_t j = 0; j < pms.genome_size; ++j) {
+            if (ind.genome[j] < pms.a[0] || ind.genome[j] > pms.b[0]) {
+                return 1;
+            }
+        }
+    }
+
+    // Bounded records with an odd capacity stay uniformly spaced
+    pms.record_capacity = 7;
+    gaim::GA<Genome,
+             gaim::ktournament_selection,
+             gaim::one_point_crossover,
+             gaim::delta_mutation> bounded(&pms);
+    bounded.fitness = sphere;
+    bounded.evolve(generations);
+    const std::vector<std::size_t> &gens = bounded.get_record_generations();
+    if (gens.size() < 2 || gens.size() > pms.record_capacity ||
+        bounded.get_bsf().size() != gens.size() ||
+        bounded.get_average_fitness().size() != gens.size()) {
+        return 1;
+    }
+    for (std::size_t i = 1; i < gens.size(); ++i) {
+        if (gens[i] - gens[i-1] != gens[1] - gens[0]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+int main(int argc, char **argv) {
+    // Evaluation worker of test_process_evaluator
+    if (argc > 1 && std::string(argv[1]) == "--worker") {
+        return GAIM_C_NAME(gaim_worker_serve)(sphere);
+    }
+
     // Testing evaluation of fitness
     int id = 0;
     std::cout << "Testing evaluation of fitness (x3)." << std::endl;
@@ -250,6 +1337,78 @@ int main() {
     id = test_sort_population(5);
     cross_validate_(id, "Sorting");
 
+    // Testing the arena allocator
+    std::cout << "Testing arena allocator." << std::endl;
+    id = test_arena(100);
+    cross_validate_(id, "Arena");
+
+    // Testing the batch fitness path
+    std::cout << "Testing batch fitness evaluation." << std::endl;
+    id = test_batch_fitness(100);
+    cross_validate_(id, "Batch fitness");
+
+    // Testing the move-only results path
+    std::cout << "Testing results moved out of the GAs." << std::endl;
+    id = test_move_results(7);
+    cross_validate_(id, "Move results");
+
+    // Testing the initialization methods
+    std::cout << "Testing the population initialization (x4)." << std::endl;
+    id = test_initialization("uniform", 100, 7);
+    cross_validate_(id, "Initialization (uniform)");
+    id = test_initialization("lhs", 100, 7);
+    cross_validate_(id, "Initialization (lhs)");
+    id = test_initialization("sobol", 64, 40);
+    cross_validate_(id, "Initialization (sobol)");
+    id = test_initialization("lhs", 2048, 128);
+    cross_validate_(id, "Initialization (lhs, parallel)");
+
+    // Testing the warm start
+    std::cout << "Testing the warm start (x2)." << std::endl;
+    id = test_warm_start(3);
+    cross_validate_(id, "Warm start");
+    id = test_warm_start(1000);
+    cross_validate_(id, "Warm start");
+
+    // Testing the surrogate-assisted evaluation
+    std::cout << "Testing the surrogate-assisted evaluation." << std::endl;
+    id = test_surrogate(200);
+    cross_validate_(id, "Surrogate");
+
+    // Testing the evaluation time budget and the cancellation
+    std::cout << "Testing timeouts and cancellation." << std::endl;
+    id = test_timeout(20);
+    cross_validate_(id, "Timeout and cancellation");
+
+    // Testing the out-of-process evaluation
+    std::cout << "Testing the evaluation worker processes." << std::endl;
+    id = test_process_evaluator(2, std::string(argv[0]) + " --worker");
+    cross_validate_(id, "Worker processes");
+
+    // Testing the multi-objective mode
+    std::cout << "Testing the multi-objective optimization." << std::endl;
+    id = test_multi_objective(1000);
+    cross_validate_(id, "Multi-objective");
+
+    // Testing the clipping
+    std::cout << "Testing the genome clipping (x2)." << std::endl;
+    id = test_clipping(2);
+    cross_validate_(id, "Clipping");
+    id = test_clipping(37);
+    cross_validate_(id, "Clipping");
+
+    // Testing the batch solver (and GA reset)
+    std::cout << "Testing the batch solver." << std::endl;
+    id = test_batch_solver(40);
+    cross_validate_(id, "Batch solver");
+
+    // Testing population statistics
+    std::cout << "Testing population statistics (x2)." << std::endl;
+    id = test_population_statistics(10);
+    cross_validate_(id, "Statistics");
+    id = test_population_statistics(257);
+    cross_validate_(id, "Statistics");
+
     // Testing next generation 
     std::cout << "Testing next generation method (x3)." << std::endl;
     id = test_next_generation(10, 5, 2);
@@ -258,7 +1417,29 @@ int main() {
     cross_validate_(id, "Offsprings");
     id = test_next_generation(150, 70, 35);
     cross_validate_(id, "Offsprings");
+
+    // Testing objective functions
+    std::cout << "Testing objective functions (x3)." << std::endl;
+    id = test_objective_functions(2);
+    cross_validate_(id, "Objective functions");
+    id = test_objective_functions(17);
+    cross_validate_(id, "Objective functions");
+    id = test_objective_functions(100);
+    cross_validate_(id, "Objective functions");
         
+    // Testing the vectorized RNG, kernels and approximations
+    std::cout << "Testing the vectorized RNG and kernels (x5)." << std::endl;
+    id = test_vrng(100000);
+    cross_validate_(id, "Vectorized RNG");
+    id = test_simd_kernels(7);
+    cross_validate_(id, "SIMD kernels");
+    id = test_simd_kernels(37);
+    cross_validate_(id, "SIMD kernels");
+    id = test_mutation_bounds(5);
+    cross_validate_(id, "Mutation bounds");
+    id = test_fast_math(100000);
+    cross_validate_(id, "Fast math");
+
     // Testing iteration over generations
     std::cout << "Testing entire GA evolving process (x3)." << std::endl;
     id = test_run_one_generation(100, 10);
@@ -267,5 +1448,36 @@ int main() {
     cross_validate_(id, "Evolving process");
     id = test_run_one_generation(5000, 5);
     cross_validate_(id, "Evolving process");
+
+    // Testing the statistics recording policies
+    std::cout << "Testing statistics recording (x7)." << std::endl;
+    id = test_recording("all", 1, 0, 500);
+    cross_validate_(id, "Recording (all)");
+    id = test_recording("interval", 10, 0, 500);
+    cross_validate_(id, "Recording (interval)");
+    id = test_recording("all", 16, 16, 1000);
+    cross_validate_(id, "Recording (bounded)");
+    id = test_recording("all", 1, 5, 1000);
+    cross_validate_(id, "Recording (bounded, odd capacity)");
+    id = test_recording("interval", 8, 7, 1000);
+    cross_validate_(id, "Recording (bounded, odd capacity)");
+    id = test_recording("log", 1, 0, 1000);
+    cross_validate_(id, "Recording (log)");
+    id = test_recording("improvement", 1, 8, 1000);
+    cross_validate_(id, "Recording (improvement)");
+
+    // Testing best-so-far tracking and elitism
+    std::cout << "Testing best-so-far tracking and elitism (x2)." << std::endl;
+    id = test_elitism(0, 300);
+    cross_validate_(id, "Best-so-far tracking");
+    id = test_elitism(1, 300);
+    cross_validate_(id, "Elitism");
+
+    // Testing the template GA engine
+    std::cout << "Testing template GA (x2)." << std::endl;
+    id = test_template_ga<std::array<REAL_, 2>>(500);
+    cross_validate_(id, "Template GA (fixed genome)");
+    id = test_template_ga<std::vector<REAL_>>(500);
+    cross_validate_(id, "Template GA (dynamic genome)");
     return 0;
 }
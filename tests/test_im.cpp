@@ -17,6 +17,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 #include "gaim.h"
+#include <csignal>
 
 
 ga_parameter_s init_ga_params(void)
@@ -138,14 +139,444 @@ int test_im(std::size_t num_immigrants, std::size_t migration_interval,
 }
 
 
+int test_topology(std::string method)
+{
+    int id;
+    im_parameter_s pms(init_im_params());
+    ga_parameter_s ga_pms(init_ga_params());
+    pr_parameter_s pr_pms(init_print_params());
+    pms.num_islands = 3;
+    pms.migration_interval = 100;
+    pms.pick_method = "elite";
+    pms.replace_method = "poor";
+    pms.adj_list_fname = "./examples/all2all_graph.dat";
+    pms.topology_method = method;
+    pms.rewiring_interval = 2;
+    pms.rewiring_degree = 2;
+    if (method == "epoch") {
+        pms.epoch_graph_fnames.push_back("./tests/graph1.dat");
+        pms.epoch_graph_fnames.push_back("./tests/graph2.dat");
+    }
+    std::cout << "Topology rewiring with " << method << " policy";
+    id = test_evolve_islands(pms);
+
+    if (method == "random") {
+        // Every island receives from rewiring_degree distinct other islands,
+        // and the sources change only every rewiring_interval migrations
+        pms.num_islands = 5;
+        pms.adj_list_fname = "./examples/star_graph.dat";
+        IM im(&pms, &ga_pms);
+        std::map<int, std::vector<int>> previous;
+        bool changed = false;
+        for (size_t k = 0; k < 20; ++k) {
+            im.rewire_topology();
+            std::map<int, std::vector<int>> graph = im.get_topology();
+            for (auto &edge : graph) {
+                std::sort(edge.second.begin(), edge.second.end());
+                id |= edge.second.size() != pms.rewiring_degree ||
+                      std::adjacent_find(edge.second.begin(),
+                                         edge.second.end()) != edge.second.end() ||
+                      std::count(edge.second.begin(), edge.second.end(),
+                                 edge.first) != 0 ||
+                      edge.second.front() < 0 || edge.second.back() > 4;
+            }
+            id |= graph.size() != pms.num_islands;
+            if (k % 2) {
+                id |= graph != previous;
+            } else if (k) {
+                changed |= graph != previous;
+            }
+            previous = graph;
+        }
+        id |= !changed;
+    } else if (method == "fitness") {
+        // Every island sends its immigrants to its weakest neighbour
+        pms.rewiring_degree = 1;
+        IM im(&pms, &ga_pms);
+        const REAL_ weak_zero[] = {-5, -1, -3}, weak_one[] = {-1, -9, -3};
+        for (size_t i = 0; i < 3; ++i) {
+            im.island[i].stats.max = weak_zero[i];
+        }
+        im.rewire_topology();
+        std::map<int, std::vector<int>> expected = {{0, {1, 2}}, {1, {}}, {2, {0}}};
+        id |= im.get_topology() != expected;
+        for (size_t i = 0; i < 3; ++i) {
+            im.island[i].stats.max = weak_one[i];
+        }
+        im.rewire_topology();
+        id |= im.get_topology() != expected;
+        im.rewire_topology();
+        expected = {{0, {}}, {1, {0, 2}}, {2, {1}}};
+        id |= im.get_topology() != expected;
+    } else if (method == "epoch") {
+        // Migrations at generations 0, 10, 20, ... and a new epoch every
+        // second migration: graph1 from generation 0, graph2 from 20
+        pms.migration_interval = 10;
+        IM im(&pms, &ga_pms);
+        std::map<int, std::vector<int>> graph1, graph2;
+        im.read_connectivity_graph("./tests/graph1.dat", graph1);
+        im.read_connectivity_graph("./tests/graph2.dat", graph2);
+        for (auto &island : im.island) {
+            island.fitness = sphere;
+        }
+        im.step_islands(10, &pms, &pr_pms);
+        id |= im.get_topology() != graph1;
+        im.step_islands(10, &pms, &pr_pms);
+        id |= im.get_topology() != graph1;
+        im.step_islands(1, &pms, &pr_pms);
+        id |= im.get_topology() != graph2;
+        im.step_islands(20, &pms, &pr_pms);
+        id |= im.get_topology() != graph1;
+    }
+    cross_validate_(id, "");
+    return 0;
+}
+
+
+/// True if none of the timers and counters of a profile moved
+bool profile_is_zero(const ga_profile_s &p)
+{
+    const uint64_t values[] = {p.evaluation_ns, p.sorting_ns, p.selection_ns,
+                               p.crossover_ns, p.mutation_ns, p.replacement_ns,
+                               p.clipping_ns, p.migration_ns, p.barrier_wait_ns,
+                               p.mutex_wait_ns, p.generations, p.evaluations,
+                               p.allocations, p.migrants_sent,
+                               p.migrants_received, p.timeouts};
+    for (auto v : values) {
+        if (v) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+int test_profile(void)
+{
+    int id = 0;
+    im_parameter_s im_pms(init_im_params());
+    ga_parameter_s ga_pms(init_ga_params());
+    pr_parameter_s pr_pms(init_print_params());
+    ga_results_s res;
+#ifdef GAIM_PROFILE
+    uint64_t sent = 0, received = 0;
+#endif
+
+    im_pms.migration_interval = 100;
+    res = run_islands(sphere, im_pms, ga_pms, pr_pms, "minimum");
+    if (res.profile.size() != im_pms.num_islands) {
+        id = 1;
+    }
+    for (auto &p : res.profile) {
+#ifdef GAIM_PROFILE
+        sent += p.migrants_sent;
+        received += p.migrants_received;
+        if (p.generations != ga_pms.generations || p.evaluation_ns == 0 ||
+            p.evaluations == 0) {
+            id = 1;
+        }
+#else
+        // The instrumentation compiles to nothing
+        if (!profile_is_zero(p)) {
+            id = 1;
+        }
+#endif
+    }
+#ifdef GAIM_PROFILE
+    // Every island of graph1.dat receives from two islands
+    if (sent == 0 || received != 2 * sent) {
+        id = 1;
+    }
+#endif
+    std::cout << "Island profile counters";
+    cross_validate_(id, "");
+    return 0;
+}
+
+
+int test_metrics(void)
+{
+    int id = 0;
+    im_parameter_s im_pms(init_im_params());
+    ga_parameter_s ga_pms(init_ga_params());
+    pr_parameter_s pr_pms(init_print_params());
+    std::string fname = "/tmp/gaim_metrics_test.prom";
+    std::string line;
+    size_t islands = 0;
+    bool bsf_found = false;
+
+    std::remove(fname.c_str());
+    pr_pms.metrics_target = "file:" + fname;
+    pr_pms.metrics_period_ms = 10;
+    ga_results_s res = run_islands(sphere, im_pms, ga_pms, pr_pms, "minimum");
+    REAL_ best = sphere(&res.genome[0], res.genome.size());
+
+    // The final snapshot reports the last generation of every island and
+    // their best so far fitness (the returned genome is one of them)
+    std::ifstream ifile(fname);
+    while (std::getline(ifile, line)) {
+        if (line.compare(0, 16, "gaim_generation{") == 0) {
+            size_t value = std::stoul(line.substr(line.rfind(' ') + 1));
+            if (value != ga_pms.generations) {
+                id = 1;
+            }
+            ++islands;
+        } else if (line.compare(0, 9, "gaim_bsf{") == 0) {
+            double value = std::stod(line.substr(line.rfind(' ') + 1));
+            bsf_found |= fabs(value - best) <= 1e-6 * std::max(1.0, fabs(double(best)));
+        }
+    }
+    if (islands != im_pms.num_islands || !bsf_found) {
+        id = 1;
+    }
+    std::cout << "Live metrics export";
+    cross_validate_(id, "");
+    return 0;
+}
+
+
+int test_engine(void)
+{
+    int id = 0;
+    im_parameter_s im_pms(init_im_params());
+    ga_parameter_s ga_pms(init_ga_params());
+    pr_parameter_s pr_pms(init_print_params());
+    gaim_info_s info;
+
+    im_pms.migration_interval = 10;
+    gaim_engine_s *engine = gaim_create_from_parameters(ga_pms, pr_pms,
+                                                        im_pms, sphere);
+    GAIM_C_NAME(gaim_get_info)(engine, &info);
+    if (info.num_islands != im_pms.num_islands || info.generation != 0 ||
+        info.genome_size != ga_pms.genome_size) {
+        id = 1;
+    }
+
+    // Stepping continues the generations (and the migration schedule)
+    if (GAIM_C_NAME(gaim_step)(engine, 25) != 25 ||
+        GAIM_C_NAME(gaim_step)(engine, 25) != 50) {
+        id = 1;
+    }
+    std::vector<REAL_> genomes(info.population_size * info.genome_size);
+    std::vector<REAL_> fitness(info.population_size);
+    if (GAIM_C_NAME(gaim_get_population)(engine, 1, &genomes[0],
+                                         &fitness[0]) != info.population_size ||
+        GAIM_C_NAME(gaim_get_population)(engine, 9, NULL, NULL)) {
+        id = 1;
+    }
+
+    // A planted optimum is found at the next step
+    std::vector<REAL_> best(info.genome_size, 0);
+    if (GAIM_C_NAME(gaim_set_population)(engine, 2, &best[0], 1) ||
+        !GAIM_C_NAME(gaim_set_population)(engine, 2, &genomes[0],
+                                          info.population_size + 1)) {
+        id = 1;
+    }
+    GAIM_C_NAME(gaim_step)(engine, 1);
+    std::vector<REAL_> genome(info.genome_size, 1);
+    if (GAIM_C_NAME(gaim_get_best)(engine, &genome[0]) != 0 || genome != best) {
+        id = 1;
+    }
+    GAIM_C_NAME(gaim_destroy)(engine);
+
+    // A single GA engine
+    im_pms.is_im_enabled = false;
+    engine = gaim_create_from_parameters(ga_pms, pr_pms, im_pms, sphere);
+    GAIM_C_NAME(gaim_get_info)(engine, &info);
+    if (info.num_islands != 1 || GAIM_C_NAME(gaim_step)(engine, 10) != 10 ||
+        GAIM_C_NAME(gaim_get_best)(engine, NULL) > 0) {
+        id = 1;
+    }
+
+    // A new population starts a new optimization: the best so far
+    // individual of the previous one is forgotten
+    if (GAIM_C_NAME(gaim_set_population)(engine, 0, &genomes[0],
+                                         info.population_size) ||
+        GAIM_C_NAME(gaim_get_best)(engine, NULL) != -std::numeric_limits<REAL_>::max()) {
+        id = 1;
+    }
+    GAIM_C_NAME(gaim_destroy)(engine);
+
+    // Invalid configurations are reported without ending the process
+    ga_pms.sel_pms.selection_method = "none";
+    if (gaim_create_from_parameters(ga_pms, pr_pms, im_pms, sphere) ||
+        GAIM_C_NAME(gaim_create)("./no_such_file.cfg", sphere)) {
+        id = 1;
+    }
+    ga_pms = init_ga_params();
+    im_pms.is_im_enabled = true;
+    im_pms.topology_method = "none";
+    if (gaim_create_from_parameters(ga_pms, pr_pms, im_pms, sphere)) {
+        id = 1;
+    }
+
+    std::cout << "Handle-based API";
+    cross_validate_(id, "");
+    return 0;
+}
+
+
+/// Token and engine cancelled by cancelling_sphere after a number of
+/// evaluations
+static CancelToken token;
+static gaim_engine_s *cancelled_engine = nullptr;
+static std::atomic<int> evaluations_left(0);
+
+
+REAL_ cancelling_sphere(REAL_ *x, size_t len)
+{
+    if (--evaluations_left == 0) {
+        token.cancel();
+        if (cancelled_engine) {
+            GAIM_C_NAME(gaim_cancel)(cancelled_engine);
+        }
+    }
+    return sphere(x, len);
+}
+
+
+int test_cancellation(void)
+{
+    int id = 0;
+    im_parameter_s im_pms(init_im_params());
+    ga_parameter_s ga_pms(init_ga_params());
+    pr_parameter_s pr_pms(init_print_params());
+
+    // A cancelled run stops all the islands after the same generation
+    im_pms.migration_interval = 10;
+    IM im(&im_pms, &ga_pms);
+    im.cancel_token = &token;
+    for (auto &island : im.island) {
+        island.fitness = cancelling_sphere;
+    }
+    evaluations_left = 500;
+    im.step_islands(1000, &im_pms, &pr_pms);
+    size_t generation = im.island[0].get_generation();
+    for (auto &island : im.island) {
+        if (island.get_generation() != generation || generation >= 1000) {
+            id = 1;
+        }
+    }
+
+    // A cancelled engine step returns early, and the engine remains usable
+    cancelled_engine = gaim_create_from_parameters(ga_pms, pr_pms, im_pms,
+                                                   cancelling_sphere);
+    evaluations_left = 500;
+    generation = GAIM_C_NAME(gaim_step)(cancelled_engine, 1000);
+    if (generation == 0 || generation >= 1000 ||
+        GAIM_C_NAME(gaim_step)(cancelled_engine, 5) != generation + 5) {
+        id = 1;
+    }
+    GAIM_C_NAME(gaim_destroy)(cancelled_engine);
+    cancelled_engine = nullptr;
+
+    std::cout << "Cancellation";
+    cross_validate_(id, "");
+    return 0;
+}
+
+
+int test_multi_objective(void)
+{
+    int id = 0;
+    im_parameter_s im_pms(init_im_params());
+    ga_parameter_s ga_pms(init_ga_params());
+    pr_parameter_s pr_pms(init_print_params());
+    ga_results_s res;
+
+    // The merged front of the islands is non-dominated and every genome
+    // comes with its objectives
+    im_pms.migration_interval = 10;
+    ga_pms.generations = 100;
+    ga_pms.population_size = 20;
+    ga_pms.num_offsprings = 20;
+    ga_pms.num_objectives = 2;
+    res = run_islands(sphere, im_pms, ga_pms, pr_pms, "minimum");
+    size_t n = res.pareto_objectives.size() / 2;
+    if (n == 0 || res.pareto_genomes.size() != 2 * n ||
+        res.pareto_objectives.size() != 2 * n ||
+        non_dominated_sort(&res.pareto_objectives[0], n, 2) !=
+        std::vector<size_t>(n, 0)) {
+        id = 1;
+    }
+    REAL_ objectives[2];
+    for (size_t i = 0; i < n && !id; ++i) {
+        sphere_objectives(&res.pareto_genomes[2 * i], 2, objectives, 2);
+        if (objectives[0] != res.pareto_objectives[2 * i] ||
+            objectives[1] != res.pareto_objectives[2 * i + 1]) {
+            id = 1;
+        }
+    }
+
+    std::cout << "Multi-objective";
+    cross_validate_(id, "");
+    return 0;
+}
+
+
+REAL_ crashing_sphere(REAL_ *x, size_t len)
+{
+    static size_t calls = 0;    // Per worker process (restarts from zero)
+
+    if (++calls % 25 == 0) {
+        raise(SIGKILL);
+    }
+    return sphere(x, len);
+}
+
+
+int test_worker_restarts(void)
+{
+    int id = 0;
+    im_parameter_s im_pms(init_im_params());
+    ga_parameter_s ga_pms(init_ga_params());
+    pr_parameter_s pr_pms(init_print_params());
+
+    // The forked workers are created while a single thread runs, and the
+    // ones that crash are restarted while the islands run
+    ProcessEvaluator workers(2, ga_pms.genome_size, crashing_sphere, 4);
+    im_pms.migration_interval = 10;
+    ga_pms.generations = 50;
+    IM im(&im_pms, &ga_pms);
+    for (auto &island : im.island) {
+        island.batch_fitness = process_batch_fitness;
+        island.batch_data = &workers;
+    }
+    im.evolve_islands(&im_pms, &pr_pms);
+    if (workers.get_restarts() == 0) {
+        id = 1;
+    }
+    for (auto &island : im.island) {
+        if (island.get_generation() != ga_pms.generations ||
+            island.bsf_genome.empty() ||
+            fabs(island.bsf_fitness - sphere(&island.bsf_genome[0], 2)) > 1e-6) {
+            id = 1;
+        }
+    }
+
+    std::cout << "Worker restarts";
+    cross_validate_(id, "");
+    return 0;
+}
+
+
 int main()
 {
     std::cout << "Test Island Model" << std::endl;
+    test_worker_restarts();
     test_im(3, 500, "random");
     test_im(3, 500, "elite");
     test_im(3, 500, "poor");
     test_im(2, 100, "elite");
     test_im(4, 100, "elite");
     test_im(5, 100, "poor");
+    test_topology("random");
+    test_topology("fitness");
+    test_topology("epoch");
+    test_profile();
+    test_metrics();
+    test_engine();
+    test_cancellation();
+    test_multi_objective();
     return 0;
 }
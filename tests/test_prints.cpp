@@ -132,8 +132,151 @@ int test_prints(void) {
 }
 
 
+int test_lazy_startup(void) {
+    int id;
+    int count = 0;
+    std::string base("./test_lazy/"), clip_fname("./test_clip.dat");
+    ga_parameter_s ga_pms(init_ga_params());
+    pr_parameter_s pr_pms(init_print_params());
+
+    // Nothing is written, so the log directory is not created
+    pr_pms.where2write = base;
+    pr_pms.print_fitness = false;
+    pr_pms.print_average_fitness = false;
+    pr_pms.print_bsf = false;
+    pr_pms.print_best_genome = false;
+    GA quiet_alg(&ga_pms);
+    quiet_alg.evolve(10, 0, &pr_pms);
+    id = is_path_exist(base);
+    cross_validate_(id, "No directory without logging");
+    count += !id;
+
+    // The directory is created by the first write
+    pr_pms.print_bsf = true;
+    quiet_alg.evolve(10, 0, &pr_pms);
+    id = 1 - is_path_exist(base+"bsf_0.dat");
+    cross_validate_(id, "Directory created on write");
+    count += !id;
+    remove_file(base+"bsf_0.dat");
+    rmdir(base.c_str());
+
+    // A clipping values file is parsed once and shared by the GAs
+    std::ofstream ofile(clip_fname);
+    for (std::size_t i = 0; i < ga_pms.population_size; ++i) {
+        ofile << -0.5 << " " << -0.25 << " " << 0.5 << " " << 0.25 << std::endl;
+    }
+    ofile.close();
+    ga_pms.clipping = "file";
+    ga_pms.clipping_fname = clip_fname;
+    GA first(&ga_pms), second(&ga_pms);
+    id = (read_clipping_file(clip_fname, 10, 2) !=
+          read_clipping_file(clip_fname, 10, 2)) ||
+         first.get_lower_limit(9) != second.get_lower_limit(9) ||
+         second.get_lower_limit(9)[1] != REAL_(-0.25) ||
+         second.get_upper_limit(9)[0] != REAL_(0.5);
+    cross_validate_(id, "Shared clipping file");
+    count += !id;
+
+    // A binary clipping values file is memory-mapped with the same contents
+    std::string bin_fname("./test_clip.bin");
+    id = convert_clipping_file(clip_fname, bin_fname, 10, 2);
+    ga_pms.clipping_fname = bin_fname;
+    GA mapped(&ga_pms), shared(&ga_pms);
+    for (std::size_t i = 0; i < 10 && !id; ++i) {
+        for (std::size_t j = 0; j < 2; ++j) {
+            id |= (mapped.get_lower_limit(i)[j] != first.get_lower_limit(i)[j]) ||
+                  (mapped.get_upper_limit(i)[j] != first.get_upper_limit(i)[j]);
+        }
+    }
+    id |= mapped.get_lower_limit(0) != shared.get_lower_limit(0);
+    cross_validate_(id, "Binary clipping file");
+    count += !id;
+
+    // A file rewritten within the same second (same size) is read again
+    auto cached = read_clipping_file(clip_fname, 10, 2);
+    ofile.open(clip_fname);
+    for (std::size_t i = 0; i < ga_pms.population_size; ++i) {
+        ofile << -0.5 << " " << -0.75 << " " << 0.5 << " " << 0.25 << std::endl;
+    }
+    ofile.close();
+    auto rewritten = read_clipping_file(clip_fname, 10, 2);
+    id = (rewritten == cached) || rewritten.get()[1] != REAL_(-0.75) ||
+         cached.get()[1] != REAL_(-0.25);
+    cross_validate_(id, "Rewritten clipping file");
+    count += !id;
+
+    // Clearing the caches reads the files again
+    clear_file_caches();
+    id = read_clipping_file(clip_fname, 10, 2) == rewritten;
+    cross_validate_(id, "Cleared file caches");
+    count += !id;
+
+    // A short text file is refused and the binary file is left untouched
+    ofile.open(clip_fname);
+    ofile << -0.5 << " " << -0.25 << std::endl;
+    ofile.close();
+    id = (convert_clipping_file(clip_fname, bin_fname, 10, 2) != -1) ||
+         read_clipping_file(bin_fname, 10, 2).get()[39] != REAL_(0.25);
+    cross_validate_(id, "Short clipping file");
+    count += !id;
+    remove_file(clip_fname);
+    remove_file(bin_fname);
+
+    return (count == 7) ? 0 : 1;
+}
+
+
+int test_warm_start(void) {
+    int id;
+    int count = 0;
+    std::string base("./test_warm/"), seed_fname("./test_seeds.dat");
+    ga_parameter_s ga_pms(init_ga_params());
+    pr_parameter_s pr_pms(init_print_params());
+
+    // The fittest genomes of a run seed the population of the next one
+    GA previous(&ga_pms);
+    previous.evolve(20, 0, &pr_pms);
+
+    // The best genome file holds the best so far genome of the run
+    id = read_seed_genomes(pr_pms.where2write + "best_genome_0.dat",
+                           ga_pms.genome_size) != previous.bsf_genome;
+    cross_validate_(id, "Best so far genome file");
+    count += !id;
+
+    id = write_seed_genomes(seed_fname, previous.population, 3);
+    std::vector<individual_s> sorted(previous.population);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const individual_s &x, const individual_s &y) {
+                  return x.fitness > y.fitness; });
+    ga_pms.seed_fname = seed_fname;
+    GA warm(&ga_pms);
+    for (std::size_t i = 0; i < 3 && !id; ++i) {
+        id |= warm.population[i].genome != sorted[i].genome;
+    }
+    cross_validate_(id, "Seed genomes file");
+    count += !id;
+    remove_file(seed_fname);
+
+    // A results directory provides the best genome of every island
+    print_best_genome(std::vector<REAL_>(ga_pms.genome_size, 0.25), 0, base);
+    print_best_genome(std::vector<REAL_>(ga_pms.genome_size, -0.5), 1, base);
+    std::vector<REAL_> seeds = read_seed_genomes(base, ga_pms.genome_size);
+    id = seeds.size() != 2 * ga_pms.genome_size || seeds.front() != REAL_(0.25) ||
+         seeds.back() != REAL_(-0.5);
+    cross_validate_(id, "Results directory seeds");
+    count += !id;
+    remove_file(base+"best_genome_0.dat");
+    remove_file(base+"best_genome_1.dat");
+    rmdir(base.c_str());
+
+    return (count == 3) ? 0 : 1;
+}
+
+
 int main() 
 {
     test_prints();
+    test_lazy_startup();
+    test_warm_start();
     return 0;
 }
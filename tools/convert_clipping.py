@@ -0,0 +1,83 @@
+# GAIM clipping values converter (Python)
+# Copyright (C) 2019  Georgios Detorakis (gdetor@protonmail.com)
+#                     Andrew Burton (ajburton@uci.edu)
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+# $Id$
+#
+# @file convert_clipping
+# Converts a text clipping values file into the binary format GAIM
+# memory-maps (see convert_clipping_file in auxiliary_funs.cpp)
+#
+# $Log$
+
+import os
+import sys
+import tempfile
+from struct import pack
+
+
+def convert_clipping(text_fname,
+                     binary_fname,
+                     population_size,
+                     genome_size,
+                     nbytes=4):
+    """
+    Converts a text clipping values file (for every individual genome_size
+    lower limits followed by genome_size upper limits) into the binary
+    format: a 32-byte header (magic "GAIMCLIP", version, bytes per value,
+    population size, genome size) followed by the limits. The binary file is
+    written to a temporary file renamed over binary_fname, so GAs still
+    mapping a previous version keep reading it.
+
+    @param text_fname Name of the text clipping values file
+    @param binary_fname Name of the binary file to write
+    @param population_size Population size (rows)
+    @param genome_size Genome size
+    @param nbytes Bytes per value (4 for the float build, 8 for the double
+    build)
+    """
+    num_values = population_size * 2 * genome_size
+    with open(text_fname) as f:
+        values = [float(v) for v in f.read().split()[:num_values]]
+    if len(values) != num_values:
+        raise ValueError("%s holds %d values, expected %d" % (text_fname,
+                                                             len(values),
+                                                             num_values))
+    fmt = 'f' if nbytes == 4 else 'd'
+    fd, tmp_fname = tempfile.mkstemp(dir=os.path.dirname(binary_fname) or '.')
+    try:
+        with os.fdopen(fd, 'wb') as f:
+            f.write(pack('=8sIIQQ', b'GAIMCLIP', 1, nbytes, population_size,
+                         genome_size))
+            f.write(pack('=%d%s' % (num_values, fmt), *values))
+        os.chmod(tmp_fname, 0o644)
+        os.replace(tmp_fname, binary_fname)
+    except BaseException:
+        os.unlink(tmp_fname)
+        raise
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 5:
+        print("Usage: %s text_file binary_file population_size genome_size "
+              "[nbytes]" % sys.argv[0])
+        sys.exit(-1)
+    nbytes = int(sys.argv[5]) if len(sys.argv) > 5 else 4
+    convert_clipping(sys.argv[1],
+                     sys.argv[2],
+                     int(sys.argv[3]),
+                     int(sys.argv[4]),
+                     nbytes)